@@ -0,0 +1,256 @@
+#include "BenchHarness.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+namespace
+{
+    std::atomic<uint64_t> allocation_count(0);
+    std::atomic<uint64_t> allocated_bytes(0);
+
+    void* countedAllocate(std::size_t size)
+    {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        void* memory = std::malloc(size == 0 ? 1 : size);
+        if (memory == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    std::string formatDouble(const double _value)
+    {
+        std::ostringstream out;
+        out << std::setprecision(6) << _value;
+        return out.str();
+    }
+}
+
+// Every allocation of the benchmark process goes through these, the
+// harness reads the counters before and after the measured iterations.
+//
+void* operator new(std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+const uint64_t BenchHarness::_MAX_ITERATIONS_ = 1000000000ull;
+volatile char BenchHarness::sink_ = 0;
+
+BenchState::BenchState(uint64_t iterations) :
+    _iterations_(iterations),
+    running_(false),
+    seconds_(0.0),
+    start_allocations_(0),
+    start_bytes_(0),
+    allocations_(0),
+    bytes_(0)
+{
+    ResumeTiming();
+}
+
+void BenchState::PauseTiming()
+{
+    if (!running_)
+    {
+        return;
+    }
+
+    seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    allocations_ += BenchHarness::GetAllocationCount() - start_allocations_;
+    bytes_ += BenchHarness::GetAllocatedBytes() - start_bytes_;
+    running_ = false;
+}
+
+void BenchState::ResumeTiming()
+{
+    if (running_)
+    {
+        return;
+    }
+
+    start_allocations_ = BenchHarness::GetAllocationCount();
+    start_bytes_ = BenchHarness::GetAllocatedBytes();
+    running_ = true;
+    start_ = std::chrono::steady_clock::now();
+}
+
+void BenchState::Finish()
+{
+    PauseTiming();
+}
+
+uint64_t BenchState::GetIterations()
+{
+    return _iterations_;
+}
+
+double BenchState::GetSeconds()
+{
+    return seconds_;
+}
+
+uint64_t BenchState::GetAllocations()
+{
+    return allocations_;
+}
+
+uint64_t BenchState::GetAllocatedBytes()
+{
+    return bytes_;
+}
+
+BenchHarness::BenchHarness(const double _min_seconds) :
+    _min_seconds_(_min_seconds)
+{
+    printHeader();
+}
+
+void BenchHarness::Run(const std::string _name, const uint64_t _grid_size,
+    const uint64_t _entity_count, const uint64_t _items_per_op,
+    BenchFunction body)
+{
+    // Start with a single iteration and scale the count by the measured time
+    // until a run is long enough. The growth is capped at 10x per round so a
+    // body with a slow first iteration (cold caches) doesn't overshoot.
+    //
+    uint64_t iterations = 1;
+    while (true)
+    {
+        BenchState state(iterations);
+        body(state);
+        state.Finish();
+
+        double seconds = state.GetSeconds();
+        if (seconds >= _min_seconds_ || iterations >= _MAX_ITERATIONS_)
+        {
+            BenchHarness::Result result;
+            result.name = _name;
+            result.grid_size = _grid_size;
+            result.entity_count = _entity_count;
+            result.iterations = iterations;
+            result.ns_per_op = seconds * 1e9 / (double)iterations;
+            result.items_per_second = (seconds > 0.0) ?
+                (double)_items_per_op * (double)iterations / seconds : 0.0;
+            result.allocs_per_op = (double)state.GetAllocations() / (double)iterations;
+            result.bytes_per_op = (double)state.GetAllocatedBytes() / (double)iterations;
+            results_.push_back(result);
+            printResult(result);
+            return;
+        }
+
+        double scale = (seconds > 0.0) ? (_min_seconds_ * 1.4 / seconds) : 10.0;
+        scale = std::min(std::max(scale, 1.5), 10.0);
+        iterations = std::min((uint64_t)((double)iterations * scale) + 1, _MAX_ITERATIONS_);
+    }
+}
+
+void BenchHarness::SetContext(const std::string _key, const std::string _value)
+{
+    context_.push_back(std::make_pair(_key, _value));
+}
+
+bool BenchHarness::WriteJson(const std::string _path)
+{
+    std::ofstream file(_path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR::BENCH_HARNESS::WRITE_JSON::COULD_NOT_OPEN::" << _path << std::endl;
+        return false;
+    }
+
+    // Names and context values are written as they are, they never contain
+    // characters that need escaping in a JSON string.
+    //
+    file << "{" << std::endl;
+    file << "  \"context\": {";
+    for (std::size_t i = 0; i < context_.size(); i++)
+    {
+        file << ((i == 0) ? "" : ", ") << "\"" << context_.at(i).first << "\": \"" <<
+            context_.at(i).second << "\"";
+    }
+    file << "}," << std::endl;
+
+    file << "  \"benchmarks\": [" << std::endl;
+    for (std::size_t i = 0; i < results_.size(); i++)
+    {
+        const BenchHarness::Result& result = results_.at(i);
+        file << "    {\"name\": \"" << result.name << "\", \"grid_size\": " << result.grid_size <<
+            ", \"entity_count\": " << result.entity_count << ", \"iterations\": " << result.iterations <<
+            ", \"ns_per_op\": " << formatDouble(result.ns_per_op) <<
+            ", \"items_per_second\": " << formatDouble(result.items_per_second) <<
+            ", \"allocs_per_op\": " << formatDouble(result.allocs_per_op) <<
+            ", \"bytes_per_op\": " << formatDouble(result.bytes_per_op) << "}" <<
+            ((i + 1 < results_.size()) ? "," : "") << std::endl;
+    }
+    file << "  ]" << std::endl;
+    file << "}" << std::endl;
+
+    std::cout << "INFO::BENCH_HARNESS::WRITE_JSON::" << _path << std::endl;
+    return true;
+}
+
+const std::vector<BenchHarness::Result>& BenchHarness::GetResults()
+{
+    return results_;
+}
+
+uint64_t BenchHarness::GetAllocationCount()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+uint64_t BenchHarness::GetAllocatedBytes()
+{
+    return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+void BenchHarness::printHeader()
+{
+    std::cout << std::left << std::setw(34) << "benchmark" << std::right <<
+        std::setw(8) << "grid" << std::setw(10) << "entities" << std::setw(14) << "ns/op" <<
+        std::setw(14) << "items/s" << std::setw(12) << "allocs/op" << std::setw(14) << "bytes/op" << std::endl;
+}
+
+void BenchHarness::printResult(const BenchHarness::Result& result)
+{
+    std::cout << std::left << std::setw(34) << result.name << std::right <<
+        std::setw(8) << result.grid_size << std::setw(10) << result.entity_count <<
+        std::setw(14) << std::fixed << std::setprecision(1) << result.ns_per_op <<
+        std::setw(14) << std::scientific << std::setprecision(3) << result.items_per_second <<
+        std::setw(12) << std::fixed << std::setprecision(2) << result.allocs_per_op <<
+        std::setw(14) << std::setprecision(0) << result.bytes_per_op << std::endl;
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
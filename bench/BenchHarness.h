@@ -0,0 +1,101 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+// Timer handed to a benchmark body. The body runs GetIterations() operations
+// and can pause the timer around setup that shouldn't be measured (refilling
+// a container that the measured operation empties, for example). Allocations
+// made while paused aren't counted either.
+//
+class BenchState
+{
+public:
+    BenchState(uint64_t iterations);
+
+    void PauseTiming();
+    void ResumeTiming();
+    void Finish();
+
+    uint64_t GetIterations();
+    double GetSeconds();
+    uint64_t GetAllocations();
+    uint64_t GetAllocatedBytes();
+
+private:
+    const uint64_t _iterations_;
+    bool running_;
+    std::chrono::steady_clock::time_point start_;
+    double seconds_;
+    uint64_t start_allocations_;
+    uint64_t start_bytes_;
+    uint64_t allocations_;
+    uint64_t bytes_;
+};
+
+// Runs named microbenchmarks parameterized over grid size and entity count
+// and collects ns/op, items/s and allocs/op. Every body is repeated with a
+// growing iteration count until it runs for at least the minimum time. The
+// results are written as JSON with one benchmark per line and fixed keys, so
+// the files of two commits can be diffed directly.
+//
+// Allocations are counted by replacing the global operator new, so the
+// counts cover every allocation of the benchmark process.
+//
+class BenchHarness
+{
+public:
+    typedef std::function<void(BenchState& state)> BenchFunction;
+
+    struct Result
+    {
+        std::string name;
+        uint64_t grid_size;
+        uint64_t entity_count;
+        uint64_t iterations;
+        double ns_per_op;
+        double items_per_second;
+        double allocs_per_op;
+        double bytes_per_op;
+    };
+
+    BenchHarness(const double _min_seconds = 0.25);
+
+    void Run(const std::string _name, const uint64_t _grid_size,
+        const uint64_t _entity_count, const uint64_t _items_per_op,
+        BenchFunction body);
+    void SetContext(const std::string _key, const std::string _value);
+    bool WriteJson(const std::string _path);
+
+    const std::vector<BenchHarness::Result>& GetResults();
+
+    // Keeps the compiler from discarding a result that is otherwise unused.
+    //
+    template <class T>
+    static void KeepAlive(const T& value);
+
+    static uint64_t GetAllocationCount();
+    static uint64_t GetAllocatedBytes();
+
+private:
+    const double _min_seconds_;
+    std::vector<BenchHarness::Result> results_;
+    std::vector<std::pair<std::string, std::string>> context_;
+
+    static const uint64_t _MAX_ITERATIONS_;
+    static volatile char sink_;
+
+    void printHeader();
+    void printResult(const BenchHarness::Result& result);
+};
+
+template <class T>
+inline void BenchHarness::KeepAlive(const T& value)
+{
+    // The volatile read forces the value to be stored before it is read.
+    //
+    sink_ = *reinterpret_cast<const volatile char*>(&value);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+// Every benchmark is a function run by name from Main.cpp.
+//
+void RunNoiseBenchmark();
+void RunQuadTreeBenchmark();
+void RunJobSystemBenchmark();
+void RunEngineBenchmark(const std::string _json_path);
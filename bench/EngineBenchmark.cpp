@@ -0,0 +1,327 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+#include "Terrain/NoiseGenerator.h"
+#include "Terrain/TerrainGenerator.h"
+#include "Terrain/Terrain.h"
+#include "World/QuadTree.h"
+#include "World/CollectibleRegistry.h"
+#include "World/HeightSampler.h"
+#include "Types/AABB.h"
+#include "BenchHarness.h"
+#include "Benchmarks.h"
+
+// CPU microbenchmarks of the engine's hot functions, parameterized over the
+// grid size (samples per side) and the entity count. Nothing here needs a
+// window or a GL context: Terrain only touches GL in Upload/Draw.
+//
+// GameWorld owns models and shaders, so it can't be constructed without a
+// context. Its hot paths are measured through the code they are made of:
+// GetGridHeight is HeightSampler::GridHeight on a single chunk, and the
+// per pickup cost of RemoveCollectibles is the registry swap-and-pop plus
+// the quadtree removal. Setting the instance buffer slot is one
+// glBufferSubData and isn't part of the CPU cost.
+//
+// The private terrain stages are measured through their public entry
+// points: the TerrainGenerator constructor is generateHeightMap,
+// generateGrid, the vertex stages and the vegetation placement. A Terrain
+// is a TerrainGenerator followed by setupVertices (or setupIndexedVertices),
+// setupVegetation and setupCollectibles, so the difference between the two
+// is the cost of the setup stages.
+//
+namespace
+{
+    const uint32_t _SEED_ = 1337;
+    const float _HEIGHT_SCALE_ = 10.0f;
+    const std::vector<uint32_t> _GRID_SIZES_ = { 64, 128, 256 };
+    const std::vector<uint32_t> _ENTITY_COUNTS_ = { 1000, 10000, 100000 };
+
+    // Positions spread over a world of 16 entities per square unit, the
+    // density doesn't change with the entity count.
+    //
+    float worldHalfDimension(const uint32_t _entity_count)
+    {
+        return std::sqrt((float)_entity_count / 16.0f) / 2.0f;
+    }
+
+    std::vector<glm::vec3> randomPositions(const uint32_t _count, const float _half_dimension,
+        const uint32_t _seed)
+    {
+        std::mt19937 rng(_seed);
+        std::uniform_real_distribution<float> coord(-_half_dimension, _half_dimension);
+        std::vector<glm::vec3> positions(_count);
+        for (std::size_t i = 0; i < positions.size(); i++)
+        {
+            positions.at(i) = glm::vec3(coord(rng), 0.0f, coord(rng));
+        }
+        return positions;
+    }
+
+    // ChunkManager::GetSampleHeight for a world of a single chunk with
+    // _chunk_size quads per side.
+    //
+    bool sampleHeight(Terrain& terrain, const int64_t _chunk_size, int64_t i, int64_t j, float& height)
+    {
+        int64_t samples = (int64_t)terrain.GetSamplesPerSide();
+        int64_t li, lj;
+        HeightSampler::Locate(i, j, _chunk_size, 1, li, lj);
+        if (li < 0 || lj < 0 || li >= samples || lj >= samples)
+        {
+            return false;
+        }
+
+        height = terrain.GetGrid()->at(li * samples + lj).y;
+        return true;
+    }
+
+    void noiseBenchmarks(BenchHarness& harness)
+    {
+        for (std::size_t g = 0; g < _GRID_SIZES_.size(); g++)
+        {
+            const int grid_size = (int)_GRID_SIZES_.at(g);
+            harness.Run("noise/perlin_2d", grid_size, 0, (uint64_t)grid_size * grid_size,
+                [&](BenchState& state)
+                {
+                    for (uint64_t k = 0; k < state.GetIterations(); k++)
+                    {
+                        std::shared_ptr<float[]> noise = NoiseGenerator::PerlinNoise2D(grid_size, grid_size,
+                            6, 0.2f, _SEED_, 128, 0, 0, 1);
+                        BenchHarness::KeepAlive(noise[0]);
+                    }
+                });
+        }
+    }
+
+    void terrainBenchmarks(BenchHarness& harness)
+    {
+        for (std::size_t g = 0; g < _GRID_SIZES_.size(); g++)
+        {
+            const uint32_t grid_size = _GRID_SIZES_.at(g);
+            const uint64_t samples = (uint64_t)(grid_size + 1) * (grid_size + 1);
+            for (int mesh = 0; mesh < 2; mesh++)
+            {
+                const TERRMESHenum mesh_type = (mesh == 0) ? TERRMESHenum::INDEXED : TERRMESHenum::FLAT_ARRAYS;
+                const std::string suffix = (mesh == 0) ? "_indexed" : "_flat";
+
+                harness.Run("terrain/generator" + suffix, grid_size, 0, samples,
+                    [&](BenchState& state)
+                    {
+                        for (uint64_t k = 0; k < state.GetIterations(); k++)
+                        {
+                            TerrainGenerator generator(grid_size, mesh_type, _SEED_, glm::ivec2(0), grid_size);
+                            BenchHarness::KeepAlive(generator.GetPositions().front());
+                        }
+                    });
+
+                harness.Run("terrain/terrain" + suffix, grid_size, 0, samples,
+                    [&](BenchState& state)
+                    {
+                        for (uint64_t k = 0; k < state.GetIterations(); k++)
+                        {
+                            Terrain terrain(grid_size, _HEIGHT_SCALE_, mesh_type, _SEED_, glm::ivec2(0), grid_size);
+                            BenchHarness::KeepAlive(terrain.GetGrid()->front());
+                        }
+                    });
+            }
+        }
+    }
+
+    void gridHeightBenchmarks(BenchHarness& harness)
+    {
+        for (std::size_t g = 0; g < _GRID_SIZES_.size(); g++)
+        {
+            const uint32_t grid_size = _GRID_SIZES_.at(g);
+            Terrain terrain(grid_size, _HEIGHT_SCALE_, TERRMESHenum::INDEXED, _SEED_, glm::ivec2(0), grid_size);
+            std::vector<glm::vec3> positions = randomPositions(4096, (float)grid_size, _SEED_);
+            HeightSampleFunction sample = [&terrain, grid_size](int64_t i, int64_t j, float& height) {
+                return sampleHeight(terrain, (int64_t)grid_size, i, j, height);
+            };
+
+            harness.Run("world/grid_height", grid_size, 0, 1,
+                [&](BenchState& state)
+                {
+                    float sum = 0.0f;
+                    for (uint64_t k = 0; k < state.GetIterations(); k++)
+                    {
+                        sum += HeightSampler::GridHeight(positions[k & 4095], (int64_t)grid_size, 
+                            (int64_t)grid_size, sample);
+                    }
+                    BenchHarness::KeepAlive(sum);
+                });
+        }
+    }
+
+    void quadTreeBenchmarks(BenchHarness& harness)
+    {
+        for (std::size_t e = 0; e < _ENTITY_COUNTS_.size(); e++)
+        {
+            const uint32_t count = _ENTITY_COUNTS_.at(e);
+            const float half_dimension = worldHalfDimension(count);
+            const AABB bounds(glm::vec3(0.0f), half_dimension);
+            std::vector<glm::vec3> positions = randomPositions(count, half_dimension, _SEED_);
+
+            // One operation is one Insert, the tree is cleared (untimed)
+            // whenever every position was inserted.
+            //
+            harness.Run("quadtree/insert", 0, count, 1,
+                [&](BenchState& state)
+                {
+                    QuadTree tree(bounds);
+                    for (uint64_t k = 0; k < state.GetIterations(); k++)
+                    {
+                        uint32_t index = (uint32_t)(k % count);
+                        if (index == 0 && k > 0)
+                        {
+                            state.PauseTiming();
+                            tree.Clear();
+                            state.ResumeTiming();
+                        }
+                        tree.Insert(index, positions[index]);
+                    }
+                    BenchHarness::KeepAlive(tree.GetItemCount());
+                });
+
+            harness.Run("quadtree/build", 0, count, count,
+                [&](BenchState& state)
+                {
+                    QuadTree tree(bounds);
+                    for (uint64_t k = 0; k < state.GetIterations(); k++)
+                    {
+                        tree.Build(positions);
+                    }
+                    BenchHarness::KeepAlive(tree.GetItemCount());
+                });
+
+            // The pickup query of the player: a box of 1x1 units.
+            //
+            QuadTree tree(bounds);
+            tree.Build(positions);
+            std::vector<glm::vec3> centers = randomPositions(4096, half_dimension, _SEED_ + 1);
+            harness.Run("quadtree/query", 0, count, 1,
+                [&](BenchState& state)
+                {
+                    uint32_t result[256];
+                    std::size_t found = 0;
+                    for (uint64_t k = 0; k < state.GetIterations(); k++)
+                    {
+                        found += tree.Query(AABB(centers[k & 4095], 0.5f), result, 256);
+                    }
+                    BenchHarness::KeepAlive(found);
+                });
+        }
+    }
+
+    void collectibleBenchmarks(BenchHarness& harness)
+    {
+        for (std::size_t e = 0; e < _ENTITY_COUNTS_.size(); e++)
+        {
+            const uint32_t count = _ENTITY_COUNTS_.at(e);
+            const float half_dimension = worldHalfDimension(count);
+            std::vector<glm::vec3> positions = randomPositions(count, half_dimension, _SEED_);
+
+            // Pickups happen in whatever order the player walks, not in
+            // insertion order.
+            //
+            std::vector<uint32_t> order(count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                order.at(i) = i;
+            }
+            std::shuffle(order.begin(), order.end(), std::mt19937(_SEED_));
+
+            // One operation is one pickup. Everything is registered again
+            // (untimed) when the last hazelnut is gone.
+            //
+            harness.Run("world/remove_collectible", 0, count, 1,
+                [&](BenchState& state)
+                {
+                    CollectibleRegistry registry;
+                    QuadTree tree(AABB(glm::vec3(0.0f), half_dimension));
+                    std::vector<CollectibleHandle> handles(count);
+                    uint32_t moved_index = 0;
+                    for (uint64_t k = 0; k < state.GetIterations(); k++)
+                    {
+                        uint32_t pickup = (uint32_t)(k % count);
+                        if (pickup == 0)
+                        {
+                            state.PauseTiming();
+                            registry.Clear();
+                            tree.Build(positions);
+                            for (uint32_t i = 0; i < count; i++)
+                            {
+                                handles.at(i) = registry.Add(Instance::Pack(positions.at(i)));
+                            }
+                            state.ResumeTiming();
+                        }
+
+                        uint32_t index = order[pickup];
+                        registry.Remove(handles[index], moved_index);
+                        tree.Remove(index, positions[index]);
+                    }
+                    BenchHarness::KeepAlive(moved_index);
+                });
+        }
+    }
+
+    void aabbBenchmarks(BenchHarness& harness)
+    {
+        for (std::size_t e = 0; e < _ENTITY_COUNTS_.size(); e++)
+        {
+            const uint32_t count = _ENTITY_COUNTS_.at(e);
+            const float half_dimension = worldHalfDimension(count);
+            std::vector<glm::vec3> positions = randomPositions(count, half_dimension, _SEED_);
+            std::vector<AABB> boxes(count);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                boxes.at(i) = AABB(positions.at(i), 0.5f);
+            }
+            AABB player(glm::vec3(0.0f), 0.5f, 1.0f, 0.5f);
+
+            harness.Run("aabb/contains", 0, count, 1,
+                [&](BenchState& state)
+                {
+                    uint32_t hits = 0;
+                    for (uint64_t k = 0; k < state.GetIterations(); k++)
+                    {
+                        hits += boxes[k % count].Contains(player.center_position) ? 1 : 0;
+                    }
+                    BenchHarness::KeepAlive(hits);
+                });
+
+            harness.Run("aabb/collides", 0, count, 1,
+                [&](BenchState& state)
+                {
+                    uint32_t hits = 0;
+                    for (uint64_t k = 0; k < state.GetIterations(); k++)
+                    {
+                        hits += boxes[k % count].Collides(player) ? 1 : 0;
+                    }
+                    BenchHarness::KeepAlive(hits);
+                });
+        }
+    }
+}
+
+void RunEngineBenchmark(const std::string _json_path)
+{
+    BenchHarness harness;
+    harness.SetContext("simd_path", NoiseGenerator::GetSimdPath());
+    harness.SetContext("hardware_threads", std::to_string(std::max(std::thread::hardware_concurrency(), 1u)));
+
+    noiseBenchmarks(harness);
+    terrainBenchmarks(harness);
+    gridHeightBenchmarks(harness);
+    quadTreeBenchmarks(harness);
+    collectibleBenchmarks(harness);
+    aabbBenchmarks(harness);
+
+    if (!_json_path.empty())
+    {
+        harness.WriteJson(_json_path);
+    }
+}
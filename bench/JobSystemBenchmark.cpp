@@ -0,0 +1,111 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "Jobs/JobSystem.h"
+#include "Benchmarks.h"
+
+namespace
+{
+    const uint32_t _EMPTY_JOBS_ = 200000;
+    const uint32_t _CHAIN_LENGTH_ = 20000;
+    const uint32_t _WORK_ITEMS_ = 1 << 22;
+    const uint32_t _WORK_GRAIN_ = 1 << 14;
+
+    double msSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Scheduling overhead: empty jobs pushed from the main thread, which 
+    // helps while it waits.
+    //
+    double emptyJobNs(JobSystem& jobs)
+    {
+        JobCounter counter;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < _EMPTY_JOBS_; i++)
+        {
+            jobs.Run([]() {}, &counter);
+        }
+        jobs.Wait(counter);
+        return msSince(start) * 1e6 / _EMPTY_JOBS_;
+    }
+
+    // Dependency latency: every job only becomes runnable once the previous
+    // one finished.
+    //
+    double chainJobNs(JobSystem& jobs)
+    {
+        std::vector<std::unique_ptr<JobCounter>> counters;
+        for (uint32_t i = 0; i < _CHAIN_LENGTH_; i++)
+        {
+            counters.push_back(std::unique_ptr<JobCounter>(new JobCounter()));
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        jobs.Run([]() {}, counters.at(0).get());
+        for (uint32_t i = 1; i < _CHAIN_LENGTH_; i++)
+        {
+            jobs.Run([]() {}, counters.at(i).get(), counters.at(i - 1).get());
+        }
+        jobs.Wait(*counters.back());
+        return msSince(start) * 1e6 / _CHAIN_LENGTH_;
+    }
+
+    // Compute bound ParallelFor, the scaling curve.
+    //
+    double parallelForMs(JobSystem& jobs, std::vector<float>& data)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        jobs.ParallelFor((uint32_t)data.size(), _WORK_GRAIN_, [&data](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                float x = (float)i;
+                for (int k = 0; k < 16; k++)
+                {
+                    x = std::sqrt(x * 1.0001f + 1.0f);
+                }
+                data[i] = x;
+            }
+        });
+        return msSince(start);
+    }
+}
+
+void RunJobSystemBenchmark()
+{
+    uint32_t max_workers = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<float> data(_WORK_ITEMS_);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(8) << "workers" << std::setw(14) << "empty ns/job" << 
+        std::setw(14) << "chain ns/job" << std::setw(14) << "for ms" << 
+        std::setw(10) << "speedup" << std::endl;
+
+    double base_ms = 0.0;
+    for (uint32_t workers = 1; workers <= max_workers; workers++)
+    {
+        JobSystem jobs(workers);
+
+        // Warm up the threads and the allocator before measuring.
+        //
+        emptyJobNs(jobs);
+        parallelForMs(jobs, data);
+
+        double empty_ns = emptyJobNs(jobs);
+        double chain_ns = chainJobNs(jobs);
+        double for_ms = parallelForMs(jobs, data);
+        if (workers == 1)
+        {
+            base_ms = for_ms;
+        }
+
+        std::cout << std::setw(8) << workers << std::setw(14) << empty_ns << 
+            std::setw(14) << chain_ns << std::setw(14) << for_ms << 
+            std::setw(10) << base_ms / for_ms << std::endl;
+    }
+}
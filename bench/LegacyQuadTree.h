@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+
+#include "Types/AABB.h"
+
+// The quadtree as it was before the arena rewrite (World/QuadTree.cpp), kept
+// only as the baseline for QuadTreeBenchmark. Every node is allocated with
+// new, items are stored by value and Query returns a vector that children
+// results are concatenated into. T stands in for Entity and needs a public
+// AABB bounding_box_.
+//
+template <class T>
+class LegacyQuadTree
+{
+public:
+    LegacyQuadTree(AABB bounding_box);
+    ~LegacyQuadTree();
+
+    bool Insert(T ent);
+    std::vector<T> Query(AABB range);
+    std::size_t GetMemoryFootprint();
+
+private:
+    const uint32_t _node_capacity_;
+
+    AABB bounding_box_;
+    std::vector<T> entities_;
+
+    LegacyQuadTree* quadrant_1_;
+    LegacyQuadTree* quadrant_2_;
+    LegacyQuadTree* quadrant_3_;
+    LegacyQuadTree* quadrant_4_;
+
+    void subdivide();
+};
+
+template<class T>
+inline LegacyQuadTree<T>::LegacyQuadTree(AABB bounding_box) :
+    _node_capacity_(4),
+    bounding_box_(bounding_box),
+    quadrant_1_(nullptr),
+    quadrant_2_(nullptr),
+    quadrant_3_(nullptr),
+    quadrant_4_(nullptr)
+{
+}
+
+template<class T>
+inline LegacyQuadTree<T>::~LegacyQuadTree()
+{
+    delete quadrant_1_;
+    delete quadrant_2_;
+    delete quadrant_3_;
+    delete quadrant_4_;
+}
+
+template<class T>
+inline bool LegacyQuadTree<T>::Insert(T ent)
+{
+    if (!bounding_box_.Contains(ent.bounding_box_.GetCenter()))
+    {
+        return false;
+    }
+
+    if (entities_.size() < _node_capacity_)
+    {
+        entities_.push_back(ent);
+        return true;
+    }
+
+    if (quadrant_1_ == nullptr)
+    {
+        subdivide();
+    }
+
+    if (quadrant_1_->Insert(ent)) return true;
+    if (quadrant_2_->Insert(ent)) return true;
+    if (quadrant_3_->Insert(ent)) return true;
+    if (quadrant_4_->Insert(ent)) return true;
+
+    return false;
+}
+
+template<class T>
+inline std::vector<T> LegacyQuadTree<T>::Query(AABB range)
+{
+    std::vector<T> matching_ents;
+
+    if (!bounding_box_.Collides(range))
+    {
+        return matching_ents;
+    }
+
+    for (std::size_t i = 0; i < entities_.size(); i++)
+    {
+        if (range.Contains(entities_.at(i).bounding_box_.GetCenter()))
+        {
+            matching_ents.push_back(entities_.at(i));
+        }
+    }
+
+    if (quadrant_1_ == nullptr)
+    {
+        return matching_ents;
+    }
+
+    std::vector<T> match;
+    match = quadrant_1_->Query(range);
+    matching_ents.insert(matching_ents.end(), match.begin(), match.end());
+    match = quadrant_2_->Query(range);
+    matching_ents.insert(matching_ents.end(), match.begin(), match.end());
+    match = quadrant_3_->Query(range);
+    matching_ents.insert(matching_ents.end(), match.begin(), match.end());
+    match = quadrant_4_->Query(range);
+    matching_ents.insert(matching_ents.end(), match.begin(), match.end());
+
+    return matching_ents;
+}
+
+template<class T>
+inline std::size_t LegacyQuadTree<T>::GetMemoryFootprint()
+{
+    std::size_t bytes = sizeof(LegacyQuadTree<T>) + entities_.capacity() * sizeof(T);
+    if (quadrant_1_ != nullptr)
+    {
+        bytes += quadrant_1_->GetMemoryFootprint() + quadrant_2_->GetMemoryFootprint() + 
+            quadrant_3_->GetMemoryFootprint() + quadrant_4_->GetMemoryFootprint();
+    }
+    return bytes;
+}
+
+template<class T>
+inline void LegacyQuadTree<T>::subdivide()
+{
+    float _x = bounding_box_.center_position.x;
+    float _z = bounding_box_.center_position.z;
+    float _h_dim = bounding_box_.x_half_dim / 2;
+
+    quadrant_1_ = new LegacyQuadTree(AABB(glm::vec3(_x + _h_dim, 0.0f, _z - _h_dim), _h_dim));
+    quadrant_2_ = new LegacyQuadTree(AABB(glm::vec3(_x - _h_dim, 0.0f, _z - _h_dim), _h_dim));
+    quadrant_3_ = new LegacyQuadTree(AABB(glm::vec3(_x - _h_dim, 0.0f, _z + _h_dim), _h_dim));
+    quadrant_4_ = new LegacyQuadTree(AABB(glm::vec3(_x + _h_dim, 0.0f, _z + _h_dim), _h_dim));
+}
@@ -0,0 +1,50 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+#include "Benchmarks.h"
+
+// Usage: Benchmark [--json FILE] [name ...], without names every benchmark
+// runs. --json writes the results of the engine microbenchmarks to FILE.
+//
+int main(int argc, char** argv)
+{
+    std::string json_path;
+    std::vector<std::string> names;
+    for (int a = 1; a < argc; a++)
+    {
+        std::string argument = argv[a];
+        if (argument == "--json" && a + 1 < argc)
+        {
+            json_path = argv[++a];
+        }
+        else
+        {
+            names.push_back(argument);
+        }
+    }
+
+    std::vector<std::pair<std::string, std::function<void()>>> benchmarks = {
+        { "noise", RunNoiseBenchmark },
+        { "quadtree", RunQuadTreeBenchmark },
+        { "jobs", RunJobSystemBenchmark },
+        { "engine", [&]() { RunEngineBenchmark(json_path); } }
+    };
+
+    for (std::size_t i = 0; i < benchmarks.size(); i++)
+    {
+        bool selected = names.empty() ||
+            (std::find(names.begin(), names.end(), benchmarks.at(i).first) != names.end());
+
+        if (selected)
+        {
+            std::cout << "INFO::BENCHMARK::RUN::" << benchmarks.at(i).first << std::endl;
+            benchmarks.at(i).second();
+            std::cout << std::endl;
+        }
+    }
+
+    return 0;
+}
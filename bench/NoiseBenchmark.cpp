@@ -0,0 +1,79 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstring>
+
+#include "Terrain/NoiseGenerator.h"
+#include "Benchmarks.h"
+
+// Throughput of NoiseGenerator::PerlinNoise2D for square grids of 128 to 8192 
+// samples per side, single threaded and on every hardware thread. Uses the 
+// same octaves, bias and pitch as the terrain. Also checks that the threaded
+// result is bit identical to the single threaded one, and compares the value
+// noise against the gradient noises on a single thread.
+//
+namespace
+{
+    const int _OCTAVES_ = 6;
+    const float _BIAS_ = 0.2f;
+    const int _PITCH_ = 128;
+    const uint32_t _SEED_ = 1337;
+    const double _MIN_SECONDS_ = 0.5;
+
+    double samplesPerSecond(const NOISETYPEenum _type, const int _grid_size, 
+        const uint32_t _threads, std::shared_ptr<float[]>& result)
+    {
+        // Repeat until the measurement runs for at least _MIN_SECONDS_, the
+        // small grids finish in microseconds.
+        //
+        int iterations = 0;
+        double seconds = 0.0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while (seconds < _MIN_SECONDS_ || iterations == 0)
+        {
+            result = NoiseGenerator::FractalNoise2D(_type, _grid_size, _grid_size, _OCTAVES_, 
+                _BIAS_, _SEED_, _PITCH_, 0, 0, _threads);
+            iterations++;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        return (double)_grid_size * (double)_grid_size * iterations / seconds;
+    }
+}
+
+void RunNoiseBenchmark()
+{
+    uint32_t hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::cout << "INFO::NOISE_BENCHMARK::SIMD_PATH::" << NoiseGenerator::GetSimdPath() << std::endl;
+    std::cout << "INFO::NOISE_BENCHMARK::HARDWARE_THREADS::" << hardware_threads << std::endl;
+    std::cout << std::setw(8) << "grid" << std::setw(18) << "1 thread MS/s" << 
+        std::setw(18) << "N threads MS/s" << std::setw(10) << "speedup" << std::setw(12) << "identical" << std::endl;
+
+    for (int grid_size = 128; grid_size <= 8192; grid_size *= 2)
+    {
+        std::shared_ptr<float[]> single, threaded;
+        double single_rate = samplesPerSecond(NOISETYPEenum::VALUE, grid_size, 1, single);
+        double threaded_rate = samplesPerSecond(NOISETYPEenum::VALUE, grid_size, hardware_threads, threaded);
+        bool identical = std::memcmp(single.get(), threaded.get(), 
+            sizeof(float) * (std::size_t)grid_size * grid_size) == 0;
+
+        std::cout << std::fixed << std::setprecision(1) <<
+            std::setw(8) << grid_size << 
+            std::setw(18) << single_rate / 1e6 << 
+            std::setw(18) << threaded_rate / 1e6 << 
+            std::setw(9) << threaded_rate / single_rate << "x" <<
+            std::setw(12) << (identical ? "yes" : "NO") << std::endl;
+    }
+
+    const char* type_names[] = { "VALUE", "PERLIN", "SIMPLEX" };
+    NOISETYPEenum types[] = { NOISETYPEenum::VALUE, NOISETYPEenum::PERLIN, NOISETYPEenum::SIMPLEX };
+    std::cout << std::endl << std::setw(8) << "type" << std::setw(18) << "1024 MS/s" << std::endl;
+    for (int t = 0; t < 3; t++)
+    {
+        std::shared_ptr<float[]> result;
+        std::cout << std::setw(8) << type_names[t] << std::setw(18) << 
+            samplesPerSecond(types[t], 1024, 1, result) / 1e6 << std::endl;
+    }
+}
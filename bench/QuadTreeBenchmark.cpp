@@ -0,0 +1,117 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "World/QuadTree.h"
+#include "LegacyQuadTree.h"
+#include "Benchmarks.h"
+
+namespace
+{
+    // Stand-in for the Entity the old tree stored by value, same size as
+    // sizeof(Entity) on x64. The real entity additionally owns copies of its
+    // model's mesh vectors which are not counted here, so the legacy memory
+    // numbers are a lower bound.
+    //
+    struct LegacyPayload
+    {
+        AABB bounding_box_;
+        unsigned char rest_[256 - sizeof(AABB)];
+    };
+
+    const float _WORLD_HALF_DIM_ = 512.0f;
+    const float _QUERY_HALF_DIM_ = 2.0f;
+    const int _QUERY_COUNT_ = 20000;
+
+    double msSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    void runSize(std::size_t count)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> coord(-_WORLD_HALF_DIM_, _WORLD_HALF_DIM_);
+
+        std::vector<glm::vec3> positions(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            positions[i] = glm::vec3(coord(rng), 0.0f, coord(rng));
+        }
+
+        std::vector<AABB> ranges(_QUERY_COUNT_);
+        for (std::size_t i = 0; i < ranges.size(); i++)
+        {
+            ranges[i] = AABB(glm::vec3(coord(rng), 0.0f, coord(rng)), _QUERY_HALF_DIM_);
+        }
+
+        AABB world(glm::vec3(0.0f), _WORLD_HALF_DIM_);
+
+        // Legacy: one insert per entity, Query returns a vector of copies.
+        //
+        auto start = std::chrono::steady_clock::now();
+        LegacyQuadTree<LegacyPayload>* legacy = new LegacyQuadTree<LegacyPayload>(world);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            LegacyPayload payload;
+            payload.bounding_box_ = AABB(positions[i], 0.5f);
+            legacy->Insert(payload);
+        }
+        double legacy_build = msSince(start);
+
+        std::size_t legacy_found = 0;
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < ranges.size(); i++)
+        {
+            legacy_found += legacy->Query(ranges[i]).size();
+        }
+        double legacy_query = msSince(start) * 1e6 / ranges.size();
+        std::size_t legacy_memory = legacy->GetMemoryFootprint();
+        delete legacy;
+
+        // Arena tree: bulk build, queries write indices into a fixed buffer.
+        //
+        start = std::chrono::steady_clock::now();
+        QuadTree tree(world);
+        tree.Build(positions);
+        double tree_build = msSince(start);
+
+        std::vector<uint32_t> result(256);
+        std::size_t tree_found = 0;
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < ranges.size(); i++)
+        {
+            tree_found += tree.Query(ranges[i], result.data(), result.size());
+        }
+        double tree_query = msSince(start) * 1e6 / ranges.size();
+        std::size_t tree_memory = tree.GetMemoryFootprint();
+
+        std::cout << std::setw(9) << count << std::setw(8) << "legacy" << 
+            std::setw(12) << legacy_build << std::setw(12) << legacy_query << 
+            std::setw(12) << legacy_memory / (1024.0 * 1024.0) << std::endl;
+        std::cout << std::setw(9) << "" << std::setw(8) << "arena" << 
+            std::setw(12) << tree_build << std::setw(12) << tree_query << 
+            std::setw(12) << tree_memory / (1024.0 * 1024.0) << std::endl;
+
+        if (legacy_found != tree_found)
+        {
+            std::cout << "ERROR::QUADTREE_BENCHMARK::RUN_SIZE::RESULTS_DIFFER " << 
+                legacy_found << " vs " << tree_found << std::endl;
+        }
+    }
+}
+
+void RunQuadTreeBenchmark()
+{
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(9) << "entities" << std::setw(8) << "tree" << 
+        std::setw(12) << "build ms" << std::setw(12) << "ns/query" << 
+        std::setw(12) << "MiB" << std::endl;
+
+    runSize(10000);
+    runSize(100000);
+    runSize(1000000);
+}
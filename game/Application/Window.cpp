@@ -2,6 +2,7 @@
 
 const int Window::_GL_VERSION_MAJOR_ = 4;
 const int Window::_GL_VERSION_MINOR_ = 2;
+const int Window::_HEADLESS_CONTEXT_APIS_[3] = { GLFW_OSMESA_CONTEXT_API, GLFW_EGL_CONTEXT_API, GLFW_NATIVE_CONTEXT_API };
 
 Window::Window(const uint32_t _width,
 	const uint32_t _height,
@@ -10,6 +11,7 @@ Window::Window(const uint32_t _width,
 	const int _gl_version_minor,
 	const bool _gl_use_multisampling,
 	const int _gl_multisample_count,
+	const bool _headless,
 	int gl_profile,
 	GLFWmonitor* monitor,
 	GLFWwindow* share) :
@@ -20,7 +22,8 @@ Window::Window(const uint32_t _width,
 	_gl_version_minor_(_gl_version_minor),
 	gl_profile_(gl_profile),
 	gl_use_multisampling_(_gl_use_multisampling),
-	gl_multisample_count_(_gl_multisample_count)
+	gl_multisample_count_(_gl_multisample_count),
+	headless_(_headless)
 {
 	std::cout << "INFO::WINDOW::WINDOW::GLFW::INIT_START" << std::endl;
 	std::cout << "INFO::WINDOW::WINDOW::OPEN_GL::VERSION" << std::endl;
@@ -49,7 +52,7 @@ Window::Window(const uint32_t _width,
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif // __APPLE__
 
-	window_ = glfwCreateWindow(width_, height_, name_.c_str(), monitor, share);
+	window_ = createWindow(monitor, share);
 	if (window_ == NULL)
 	{
 		std::cout << "ERROR::WINDOW::WINDOW::GLFW::INIT" << std::endl;
@@ -126,6 +129,11 @@ bool Window::GetMultisamplingEnabled() const
 	return gl_use_multisampling_;
 }
 
+bool Window::GetHeadless() const
+{
+	return headless_;
+}
+
 void Window::SetWindowShouldClose(bool shouldClose)
 {
 	glfwSetWindowShouldClose(window_, (GLboolean)shouldClose);
@@ -155,3 +163,27 @@ void Window::SetMouseScrollCallback(MouseCallbackFunction callback)
 {
 	glfwSetScrollCallback(window_, callback);
 }
+
+GLFWwindow* Window::createWindow(GLFWmonitor* monitor, GLFWwindow* share)
+{
+	if (!headless_)
+	{
+		return glfwCreateWindow(width_, height_, name_.c_str(), monitor, share);
+	}
+
+	// Try the context APIs that don't need a display first, the hidden
+	// native window is the last resort.
+	//
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	for (int i = 0; i < 3; i++)
+	{
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, _HEADLESS_CONTEXT_APIS_[i]);
+		GLFWwindow* window = glfwCreateWindow(width_, height_, name_.c_str(), NULL, share);
+		if (window != NULL)
+		{
+			std::cout << "INFO::WINDOW::CREATE_WINDOW::HEADLESS_CONTEXT_API_" << i << std::endl;
+			return window;
+		}
+	}
+	return NULL;
+}
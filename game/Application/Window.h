@@ -10,6 +10,10 @@
 
 #include "Types/FWindow.h"
 
+// With _headless the window is never shown and the context is created 
+// through OSMesa or EGL when GLFW supports them (Mesa llvmpipe works), so 
+// the game can render offscreen on a machine without a desktop or GPU.
+//
 class Window
 {
 public:
@@ -20,6 +24,7 @@ public:
         const int _gl_version_minor = _GL_VERSION_MINOR_,
         const bool _gl_use_multisampling = false, 
         const int _gl_multisample_count = 2,
+        const bool _headless = false,
         int gl_profile = GLFW_OPENGL_CORE_PROFILE, 
         GLFWmonitor* monitor = NULL, 
         GLFWwindow* share = NULL);
@@ -31,6 +36,7 @@ public:
     void SetHeight(int height);
     int GetWindowShouldClose() const;
     bool GetMultisamplingEnabled() const;
+    bool GetHeadless() const;
     void SetInputMode(int mode, int value);
     std::string GetWindowName() const;
     void SetWindowName(const std::string _name);
@@ -46,10 +52,14 @@ private:
     uint32_t height_;
     bool gl_use_multisampling_;
     uint32_t gl_multisample_count_;
+    bool headless_;
     const int _gl_version_major_;
     const int _gl_version_minor_;
     int gl_profile_;
 
     static const int _GL_VERSION_MAJOR_;
     static const int _GL_VERSION_MINOR_;
+    static const int _HEADLESS_CONTEXT_APIS_[3];
+
+    GLFWwindow* createWindow(GLFWmonitor* monitor, GLFWwindow* share);
 };
\ No newline at end of file
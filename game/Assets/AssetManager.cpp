@@ -0,0 +1,208 @@
+#include "Assets/AssetManager.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fstream>
+#include <unistd.h>
+#endif
+
+AssetManager::AssetManager(JobSystem& job_system) :
+    texture_loader_(job_system),
+    load_count_(0),
+    reuse_count_(0)
+{
+}
+
+ModelHandle AssetManager::LoadModel(const std::string _path, bool embedded,
+    bool gamma)
+{
+    std::string key = modelKey(_path, embedded, gamma);
+    ModelHandle model;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        model = find(models_, key);
+    }
+    if (model)
+    {
+        model->Upload();
+        return model;
+    }
+
+    model = std::make_shared<Model>(_path, embedded, gamma, true, &texture_loader_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    models_[key] = model;
+    load_count_++;
+    return model;
+}
+
+ModelHandle AssetManager::ImportModel(const std::string _path, bool embedded,
+    bool gamma)
+{
+    // Parsed outside the lock so imports run in parallel. Two imports of
+    // the same model at once both parse it, the first one registered wins.
+    //
+    std::string key = modelKey(_path, embedded, gamma);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ModelHandle model = find(models_, key);
+        if (model)
+        {
+            return model;
+        }
+    }
+
+    ModelHandle model = std::make_shared<Model>(_path, embedded, gamma, false, &texture_loader_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    ModelHandle registered = find(models_, key);
+    if (registered)
+    {
+        return registered;
+    }
+    models_[key] = model;
+    load_count_++;
+    return model;
+}
+
+ShaderHandle AssetManager::LoadShader(const std::string _vertex_path,
+    const std::string _fragment_path)
+{
+    std::string key = _vertex_path + "|" + _fragment_path;
+    std::lock_guard<std::mutex> lock(mutex_);
+    ShaderHandle shader = find(shaders_, key);
+    if (shader)
+    {
+        return shader;
+    }
+
+    shader = std::make_shared<Shader>(_vertex_path, _fragment_path);
+    shaders_[key] = shader;
+    load_count_++;
+    return shader;
+}
+
+ShaderHandle AssetManager::LoadShader(const std::string _vertex_path,
+    const std::string _geometry_path, const std::string _fragment_path)
+{
+    std::string key = _vertex_path + "|" + _geometry_path + "|" + _fragment_path;
+    std::lock_guard<std::mutex> lock(mutex_);
+    ShaderHandle shader = find(shaders_, key);
+    if (shader)
+    {
+        return shader;
+    }
+
+    shader = std::make_shared<Shader>(_vertex_path, _geometry_path, _fragment_path);
+    shaders_[key] = shader;
+    load_count_++;
+    return shader;
+}
+
+TextureHandle AssetManager::LoadCubemap(const std::vector<std::string>& _paths)
+{
+    std::string key;
+    for (std::size_t i = 0; i < _paths.size(); i++)
+    {
+        key += _paths.at(i) + "|";
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    TextureHandle texture = find(textures_, key);
+    if (texture)
+    {
+        return texture;
+    }
+
+    texture = texture_loader_.LoadCubemap(_paths);
+    textures_[key] = texture;
+    load_count_++;
+    return texture;
+}
+
+void AssetManager::Update()
+{
+    texture_loader_.Update();
+}
+
+uint32_t AssetManager::GetModelCount()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return countAlive(models_);
+}
+
+uint32_t AssetManager::GetShaderCount()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return countAlive(shaders_);
+}
+
+uint32_t AssetManager::GetTextureCount()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return countAlive(textures_);
+}
+
+uint32_t AssetManager::GetLoadCount()
+{
+    return load_count_;
+}
+
+uint32_t AssetManager::GetReuseCount()
+{
+    return reuse_count_;
+}
+
+std::size_t AssetManager::GetMemoryFootprint()
+{
+    std::size_t bytes = sizeof(AssetManager);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = models_.begin(); it != models_.end(); it++)
+    {
+        ModelHandle model = it->second.lock();
+        bytes += model ? model->GetMemoryFootprint() : 0;
+    }
+    return bytes;
+}
+
+void AssetManager::PrintStats()
+{
+    std::cout << "INFO::ASSET_MANAGER::PRINT_STATS" << std::endl;
+    std::cout << "Models:" << GetModelCount() << "|Shaders:" << GetShaderCount() << 
+        "|Textures:" << GetTextureCount() << 
+        "|Loads:" << load_count_ << "|Reused:" << reuse_count_ << std::endl;
+    std::cout << "Model data:" << GetMemoryFootprint() / 1024 << "KB|Resident memory:" << 
+        GetResidentMemory() / (1024 * 1024) << "MB" << std::endl;
+}
+
+std::string AssetManager::modelKey(const std::string _path, bool embedded, bool gamma)
+{
+    // The flags change what is loaded, so they are part of the key.
+    //
+    return _path + (embedded ? "|embedded" : "") + (gamma ? "|gamma" : "");
+}
+
+std::size_t AssetManager::GetResidentMemory()
+{
+    // Working set of the whole process, used to compare memory use before
+    // and after changes. 0 if the platform doesn't tell.
+    //
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return (std::size_t)counters.WorkingSetSize;
+    }
+    return 0;
+#else
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0, resident = 0;
+    if (!(statm >> pages >> resident))
+    {
+        return 0;
+    }
+    return resident * (std::size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+
+#include "Renderer/Model.h"
+#include "Renderer/Shader.h"
+#include "Assets/TextureLoader.h"
+#include "Jobs/JobSystem.h"
+
+typedef std::shared_ptr<Model> ModelHandle;
+typedef std::shared_ptr<Shader> ShaderHandle;
+
+// Loads every model and shader once and hands out reference counted handles
+// keyed by the source path, so terrain elements, entities and the player
+// share one copy of the mesh data and GPU objects instead of copying them.
+// The manager only keeps weak references: an asset lives as long as somebody
+// holds a handle, asking for it again afterwards loads it again.
+//
+// Loads create GL objects, so the manager is used on the thread that owns the
+// context. Handles can be copied anywhere (chunk workers copy them into the
+// entities they create). The exception is ImportModel, which parses a model
+// without uploading it and can run on any thread, a later LoadModel of the
+// same model uploads it (see Model::Upload).
+//
+// Textures, the model's texture files included, go through the texture
+// loader: they are decoded by jobs and uploaded a slice at a time by Update,
+// which the owner calls once a frame.
+//
+class AssetManager
+{
+public:
+    AssetManager(JobSystem& job_system);
+
+    ModelHandle LoadModel(const std::string _path, bool embedded = false,
+        bool gamma = false);
+    ModelHandle ImportModel(const std::string _path, bool embedded = true,
+        bool gamma = false);
+    ShaderHandle LoadShader(const std::string _vertex_path,
+        const std::string _fragment_path);
+    ShaderHandle LoadShader(const std::string _vertex_path,
+        const std::string _geometry_path, const std::string _fragment_path);
+    TextureHandle LoadCubemap(const std::vector<std::string>& _paths);
+    void Update();
+
+    uint32_t GetModelCount();
+    uint32_t GetShaderCount();
+    uint32_t GetTextureCount();
+    uint32_t GetLoadCount();
+    uint32_t GetReuseCount();
+    std::size_t GetMemoryFootprint();
+    void PrintStats();
+
+    static std::size_t GetResidentMemory();
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::weak_ptr<Model>> models_;
+    std::unordered_map<std::string, std::weak_ptr<Shader>> shaders_;
+    std::unordered_map<std::string, std::weak_ptr<AsyncTexture>> textures_;
+    TextureLoader texture_loader_;
+    uint32_t load_count_;
+    uint32_t reuse_count_;
+
+    static std::string modelKey(const std::string _path, bool embedded, bool gamma);
+
+    template <class T>
+    std::shared_ptr<T> find(std::unordered_map<std::string, std::weak_ptr<T>>& assets,
+        const std::string _key);
+    template <class T>
+    uint32_t countAlive(std::unordered_map<std::string, std::weak_ptr<T>>& assets);
+};
+
+template <class T>
+inline std::shared_ptr<T> AssetManager::find(std::unordered_map<std::string, std::weak_ptr<T>>& assets,
+    const std::string _key)
+{
+    auto it = assets.find(_key);
+    if (it == assets.end())
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<T> asset = it->second.lock();
+    if (!asset)
+    {
+        assets.erase(it);
+        return nullptr;
+    }
+
+    reuse_count_++;
+    return asset;
+}
+
+template <class T>
+inline uint32_t AssetManager::countAlive(std::unordered_map<std::string, std::weak_ptr<T>>& assets)
+{
+    uint32_t count = 0;
+    for (auto it = assets.begin(); it != assets.end(); it++)
+    {
+        count += it->second.expired() ? 0 : 1;
+    }
+    return count;
+}
@@ -0,0 +1,412 @@
+#include "Assets/BlockCompressor.h"
+
+const int BlockCompressor::_BC7_WEIGHTS_[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+std::size_t BlockCompressor::GetBlockSize(TEXCOMPRESSenum format)
+{
+    if (format == TEXCOMPRESSenum::BC1)
+    {
+        return 8;
+    }
+    else if (format == TEXCOMPRESSenum::BC3 || format == TEXCOMPRESSenum::BC7)
+    {
+        return 16;
+    }
+    return 0;
+}
+
+std::size_t BlockCompressor::GetCompressedSize(uint32_t width, uint32_t height, TEXCOMPRESSenum format)
+{
+    return (std::size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+void BlockCompressor::Compress(const uint8_t* rgba, uint32_t width, uint32_t height, TEXCOMPRESSenum format,
+    uint8_t* blocks)
+{
+    // Blocks row by row, the order glCompressedTexSubImage2D expects.
+    //
+    std::size_t block_size = GetBlockSize(format);
+    uint32_t blocks_x = (width + 3) / 4;
+    uint32_t blocks_y = (height + 3) / 4;
+    uint8_t block[16][4];
+    for (uint32_t y = 0; y < blocks_y; y++)
+    {
+        for (uint32_t x = 0; x < blocks_x; x++)
+        {
+            fetchBlock(rgba, width, height, x, y, block);
+            uint8_t* out = blocks + ((std::size_t)y * blocks_x + x) * block_size;
+            if (format == TEXCOMPRESSenum::BC1)
+            {
+                encodeBC1(block, out);
+            }
+            else if (format == TEXCOMPRESSenum::BC3)
+            {
+                encodeBC3Alpha(block, out);
+                encodeBC1(block, out + 8);
+            }
+            else if (format == TEXCOMPRESSenum::BC7)
+            {
+                encodeBC7(block, out);
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> BlockCompressor::Downsample(const uint8_t* rgba, uint32_t width, uint32_t height)
+{
+    uint32_t next_width = std::max(width / 2, 1u);
+    uint32_t next_height = std::max(height / 2, 1u);
+    std::vector<uint8_t> next((std::size_t)next_width * next_height * 4);
+    for (uint32_t y = 0; y < next_height; y++)
+    {
+        uint32_t y0 = std::min(y * 2, height - 1);
+        uint32_t y1 = std::min(y * 2 + 1, height - 1);
+        for (uint32_t x = 0; x < next_width; x++)
+        {
+            uint32_t x0 = std::min(x * 2, width - 1);
+            uint32_t x1 = std::min(x * 2 + 1, width - 1);
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                uint32_t sum = rgba[((std::size_t)y0 * width + x0) * 4 + c] + rgba[((std::size_t)y0 * width + x1) * 4 + c] +
+                    rgba[((std::size_t)y1 * width + x0) * 4 + c] + rgba[((std::size_t)y1 * width + x1) * 4 + c];
+                next[((std::size_t)y * next_width + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+            }
+        }
+    }
+    return next;
+}
+
+void BlockCompressor::fetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height,
+    uint32_t block_x, uint32_t block_y, uint8_t block[16][4])
+{
+    // Blocks over the edge of the image repeat its last row and column, the
+    // extra pixels are never sampled but shouldn't pull the endpoints away.
+    //
+    for (uint32_t y = 0; y < 4; y++)
+    {
+        uint32_t source_y = std::min(block_y * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            uint32_t source_x = std::min(block_x * 4 + x, width - 1);
+            const uint8_t* pixel = rgba + ((std::size_t)source_y * width + source_x) * 4;
+            std::copy(pixel, pixel + 4, block[y * 4 + x]);
+        }
+    }
+}
+
+void BlockCompressor::fitEndpoints(const uint8_t block[16][4], int channels, float start[4], float end[4])
+{
+    // Principal axis by power iteration on the covariance of the block,
+    // seeded with the bounding box diagonal.
+    //
+    float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float low[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+    float high[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; i++)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            mean[c] += block[i][c] / 16.0f;
+            low[c] = std::min(low[c], (float)block[i][c]);
+            high[c] = std::max(high[c], (float)block[i][c]);
+        }
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++)
+            {
+                covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+            }
+        }
+    }
+
+    float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int c = 0; c < channels; c++)
+    {
+        axis[c] = high[c] - low[c];
+    }
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float length = 0.0f;
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++)
+            {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+        if (length < 1e-6f)
+        {
+            break;
+        }
+        length = std::sqrt(length);
+        for (int c = 0; c < channels; c++)
+        {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float axis_length = 0.0f;
+    for (int c = 0; c < channels; c++)
+    {
+        axis_length += axis[c] * axis[c];
+    }
+    if (axis_length < 1e-6f)
+    {
+        std::copy(mean, mean + 4, start);
+        std::copy(mean, mean + 4, end);
+        return;
+    }
+    axis_length = std::sqrt(axis_length);
+    for (int c = 0; c < channels; c++)
+    {
+        axis[c] /= axis_length;
+    }
+
+    float t_min = 0.0f, t_max = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        float t = 0.0f;
+        for (int c = 0; c < channels; c++)
+        {
+            t += (block[i][c] - mean[c]) * axis[c];
+        }
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+
+    for (int c = 0; c < 4; c++)
+    {
+        start[c] = (c < channels) ? std::min(std::max(mean[c] + axis[c] * t_min, 0.0f), 255.0f) : 0.0f;
+        end[c] = (c < channels) ? std::min(std::max(mean[c] + axis[c] * t_max, 0.0f), 255.0f) : 0.0f;
+    }
+}
+
+void BlockCompressor::encodeBC1(const uint8_t block[16][4], uint8_t* out)
+{
+    // Always the four color mode (color 0 above color 1), equal endpoints
+    // leave every index at 0.
+    //
+    float start[4], end[4];
+    fitEndpoints(block, 3, start, end);
+
+    uint16_t endpoints[2];
+    const float* colors[2] = { end, start };
+    for (int e = 0; e < 2; e++)
+    {
+        uint32_t r = (uint32_t)std::lround(colors[e][0] * 31.0f / 255.0f);
+        uint32_t g = (uint32_t)std::lround(colors[e][1] * 63.0f / 255.0f);
+        uint32_t b = (uint32_t)std::lround(colors[e][2] * 31.0f / 255.0f);
+        endpoints[e] = (uint16_t)((r << 11) | (g << 5) | b);
+    }
+    if (endpoints[0] < endpoints[1])
+    {
+        std::swap(endpoints[0], endpoints[1]);
+    }
+
+    int palette[4][3];
+    for (int e = 0; e < 2; e++)
+    {
+        uint32_t r = (endpoints[e] >> 11) & 31;
+        uint32_t g = (endpoints[e] >> 5) & 63;
+        uint32_t b = endpoints[e] & 31;
+        palette[e][0] = (int)((r << 3) | (r >> 2));
+        palette[e][1] = (int)((g << 2) | (g >> 4));
+        palette[e][2] = (int)((b << 3) | (b >> 2));
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    uint32_t indices = 0;
+    if (endpoints[0] != endpoints[1])
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0;
+            int best_error = INT32_MAX;
+            for (int p = 0; p < 4; p++)
+            {
+                int error = 0;
+                for (int c = 0; c < 3; c++)
+                {
+                    int difference = block[i][c] - palette[p][c];
+                    error += difference * difference;
+                }
+                if (error < best_error)
+                {
+                    best = p;
+                    best_error = error;
+                }
+            }
+            indices |= (uint32_t)best << (i * 2);
+        }
+    }
+
+    out[0] = (uint8_t)(endpoints[0] & 0xFF);
+    out[1] = (uint8_t)(endpoints[0] >> 8);
+    out[2] = (uint8_t)(endpoints[1] & 0xFF);
+    out[3] = (uint8_t)(endpoints[1] >> 8);
+    for (int i = 0; i < 4; i++)
+    {
+        out[4 + i] = (uint8_t)(indices >> (i * 8));
+    }
+}
+
+void BlockCompressor::encodeBC3Alpha(const uint8_t block[16][4], uint8_t* out)
+{
+    // The eight level mode, alpha 0 is the maximum.
+    //
+    int alpha_max = 0, alpha_min = 255;
+    for (int i = 0; i < 16; i++)
+    {
+        alpha_max = std::max(alpha_max, (int)block[i][3]);
+        alpha_min = std::min(alpha_min, (int)block[i][3]);
+    }
+
+    int palette[8];
+    palette[0] = alpha_max;
+    palette[1] = alpha_min;
+    for (int p = 2; p < 8; p++)
+    {
+        palette[p] = ((8 - p) * alpha_max + (p - 1) * alpha_min) / 7;
+    }
+
+    uint64_t indices = 0;
+    if (alpha_max != alpha_min)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0;
+            for (int p = 1; p < 8; p++)
+            {
+                if (std::abs(block[i][3] - palette[p]) < std::abs(block[i][3] - palette[best]))
+                {
+                    best = p;
+                }
+            }
+            indices |= (uint64_t)best << (i * 3);
+        }
+    }
+
+    out[0] = (uint8_t)alpha_max;
+    out[1] = (uint8_t)alpha_min;
+    for (int i = 0; i < 6; i++)
+    {
+        out[2 + i] = (uint8_t)(indices >> (i * 8));
+    }
+}
+
+void BlockCompressor::encodeBC7(const uint8_t block[16][4], uint8_t* out)
+{
+    // Mode 6: 7 bit RGBA endpoints with one extra low bit (p-bit) each and
+    // 4 bit indices. The p-bit of every endpoint is the one that gets its
+    // channels closest. The first index has an implied top bit of 0, the
+    // endpoints are swapped if the first pixel needs it set.
+    //
+    float start[4], end[4];
+    fitEndpoints(block, 4, start, end);
+
+    int quantized[2][4];
+    int p_bits[2];
+    int endpoints[2][4];
+    const float* colors[2] = { start, end };
+    for (int e = 0; e < 2; e++)
+    {
+        float best_error = 0.0f;
+        for (int p = 0; p < 2; p++)
+        {
+            int candidate[4];
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                candidate[c] = std::min(std::max((int)std::lround((colors[e][c] - p) / 2.0f), 0), 127);
+                float difference = (float)((candidate[c] << 1) | p) - colors[e][c];
+                error += difference * difference;
+            }
+            if (p == 0 || error < best_error)
+            {
+                best_error = error;
+                p_bits[e] = p;
+                std::copy(candidate, candidate + 4, quantized[e]);
+            }
+        }
+        for (int c = 0; c < 4; c++)
+        {
+            endpoints[e][c] = (quantized[e][c] << 1) | p_bits[e];
+        }
+    }
+
+    int palette[16][4];
+    for (int w = 0; w < 16; w++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            palette[w][c] = ((64 - _BC7_WEIGHTS_[w]) * endpoints[0][c] + _BC7_WEIGHTS_[w] * endpoints[1][c] + 32) >> 6;
+        }
+    }
+
+    int indices[16];
+    for (int i = 0; i < 16; i++)
+    {
+        int best = 0;
+        int best_error = INT32_MAX;
+        for (int p = 0; p < 16; p++)
+        {
+            int error = 0;
+            for (int c = 0; c < 4; c++)
+            {
+                int difference = block[i][c] - palette[p][c];
+                error += difference * difference;
+            }
+            if (error < best_error)
+            {
+                best = p;
+                best_error = error;
+            }
+        }
+        indices[i] = best;
+    }
+
+    if (indices[0] & 8)
+    {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(p_bits[0], p_bits[1]);
+        for (int i = 0; i < 16; i++)
+        {
+            indices[i] = 15 - indices[i];
+        }
+    }
+
+    std::fill(out, out + 16, (uint8_t)0);
+    uint32_t position = 0;
+    writeBits(out, position, 1u << 6, 7);
+    for (int c = 0; c < 4; c++)
+    {
+        writeBits(out, position, (uint32_t)quantized[0][c], 7);
+        writeBits(out, position, (uint32_t)quantized[1][c], 7);
+    }
+    writeBits(out, position, (uint32_t)p_bits[0], 1);
+    writeBits(out, position, (uint32_t)p_bits[1], 1);
+    writeBits(out, position, (uint32_t)indices[0], 3);
+    for (int i = 1; i < 16; i++)
+    {
+        writeBits(out, position, (uint32_t)indices[i], 4);
+    }
+}
+
+void BlockCompressor::writeBits(uint8_t* out, uint32_t& position, uint32_t value, uint32_t count)
+{
+    for (uint32_t b = 0; b < count; b++, position++)
+    {
+        out[position / 8] |= (uint8_t)(((value >> b) & 1) << (position % 8));
+    }
+}
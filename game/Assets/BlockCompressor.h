@@ -0,0 +1,46 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Types/ETexture.h"
+
+// CPU encoder for the block compressed texture formats, it doesn't touch GL
+// and runs on any thread. Input is always RGBA8, tightly packed. Every 4x4
+// block is encoded on its own: the endpoints are the extremes of the block's
+// colors along their principal axis, every pixel takes the nearest palette
+// entry. That is far from the quality of an offline encoder with endpoint
+// refinement, but fast enough to bake textures on first launch.
+//
+// BC7 only uses mode 6 (one subset, RGBA endpoints, 16 levels), which covers
+// smooth content like skies well.
+//
+class BlockCompressor
+{
+public:
+    static std::size_t GetBlockSize(TEXCOMPRESSenum format);
+    static std::size_t GetCompressedSize(uint32_t width, uint32_t height, TEXCOMPRESSenum format);
+    static void Compress(const uint8_t* rgba, uint32_t width, uint32_t height, TEXCOMPRESSenum format,
+        uint8_t* blocks);
+
+    // Next level of a mip chain, 2x2 box filter. Odd sizes repeat the last
+    // row and column.
+    //
+    static std::vector<uint8_t> Downsample(const uint8_t* rgba, uint32_t width, uint32_t height);
+
+private:
+    static const int _BC7_WEIGHTS_[16];
+
+    BlockCompressor();
+
+    static void fetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height,
+        uint32_t block_x, uint32_t block_y, uint8_t block[16][4]);
+    static void fitEndpoints(const uint8_t block[16][4], int channels, float start[4], float end[4]);
+    static void encodeBC1(const uint8_t block[16][4], uint8_t* out);
+    static void encodeBC3Alpha(const uint8_t block[16][4], uint8_t* out);
+    static void encodeBC7(const uint8_t block[16][4], uint8_t* out);
+    static void writeBits(uint8_t* out, uint32_t& position, uint32_t value, uint32_t count);
+};
@@ -0,0 +1,615 @@
+#include "Assets/TextureLoader.h"
+
+#include <stb/stb_image.h>
+
+const std::size_t TextureLoader::_UPLOAD_BUDGET_ = (std::size_t)16 * 1024 * 1024;
+const uint32_t TextureLoader::_PIXEL_BUFFER_COUNT_ = 4;
+const std::string TextureLoader::_CACHE_DIRECTORY_ = "Cache/Textures/";
+
+AsyncTexture::AsyncTexture(GLenum target, uint32_t image_count, GLenum wrapping,
+    GLenum min_filter, GLenum mag_filter, TEXCOMPRESSenum compression) :
+    _target_(target),
+    _wrapping_(wrapping),
+    _min_filter_(min_filter),
+    _mag_filter_(mag_filter),
+    _compression_(compression),
+    _image_count_(image_count),
+    ready_(false),
+    failed_(false),
+    id_(0),
+    pending_images_(image_count),
+    width_(0),
+    height_(0),
+    components_(0),
+    levels_(0),
+    format_(TEXCOMPRESSenum::NONE),
+    decode_ms_(0.0),
+    upload_ms_(0.0),
+    memory_size_(0),
+    cached_images_(0)
+{
+}
+
+AsyncTexture::~AsyncTexture()
+{
+    // The loader holds on to a texture until it is done with it, so the last
+    // handle is dropped by its users, on the context thread.
+    //
+    if (id_ != 0)
+    {
+        glDeleteTextures(1, &id_);
+    }
+}
+
+bool AsyncTexture::IsReady() const
+{
+    return ready_.load(std::memory_order_acquire);
+}
+
+bool AsyncTexture::IsFailed() const
+{
+    return failed_.load(std::memory_order_acquire);
+}
+
+uint32_t AsyncTexture::GetId() const
+{
+    return IsReady() ? id_ : 0;
+}
+
+GLenum AsyncTexture::GetTarget() const
+{
+    return _target_;
+}
+
+int AsyncTexture::GetWidth() const
+{
+    return width_;
+}
+
+int AsyncTexture::GetHeight() const
+{
+    return height_;
+}
+
+double AsyncTexture::GetDecodeTime() const
+{
+    return decode_ms_;
+}
+
+double AsyncTexture::GetUploadTime() const
+{
+    return upload_ms_;
+}
+
+std::size_t AsyncTexture::GetMemorySize() const
+{
+    return memory_size_;
+}
+
+const uint8_t* TextureLoader::Image::GetBlocks() const
+{
+    return cache_file ? cache_file->GetData() : blocks.data();
+}
+
+TextureLoader::TextureLoader(JobSystem& job_system) :
+    job_system_(job_system),
+    next_pixel_buffer_(0),
+    s3tc_supported_(hasExtension("GL_EXT_texture_compression_s3tc"))
+{
+    if (!s3tc_supported_)
+    {
+        std::cout << "INFO::TEXTURE_LOADER::TEXTURE_LOADER::NO_S3TC_USING_BC7" << std::endl;
+    }
+}
+
+TextureLoader::~TextureLoader()
+{
+    job_system_.Wait(decode_jobs_);
+    if (!pixel_buffers_.empty())
+    {
+        glDeleteBuffers((GLsizei)pixel_buffers_.size(), pixel_buffers_.data());
+    }
+}
+
+TextureHandle TextureLoader::LoadTexture(const std::string _path, bool flip_vertical,
+    GLenum wrapping, GLenum min_filter, GLenum mag_filter, TEXCOMPRESSenum compression)
+{
+    TextureHandle texture = std::make_shared<AsyncTexture>(GL_TEXTURE_2D, 1, wrapping, min_filter, mag_filter,
+        supportedCompression(compression));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loading_.push_back(texture);
+    }
+    decode(texture, _path, 0, flip_vertical);
+    return texture;
+}
+
+TextureHandle TextureLoader::LoadCubemap(const std::vector<std::string>& _paths,
+    GLenum min_filter, GLenum mag_filter, TEXCOMPRESSenum compression)
+{
+    // Faces in cube map order (+X, -X, +Y, -Y, +Z, -Z), never flipped.
+    //
+    TextureHandle texture = std::make_shared<AsyncTexture>(GL_TEXTURE_CUBE_MAP, (uint32_t)_paths.size(),
+        GL_CLAMP_TO_EDGE, min_filter, mag_filter, supportedCompression(compression));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loading_.push_back(texture);
+    }
+    for (uint32_t face = 0; face < (uint32_t)_paths.size(); face++)
+    {
+        decode(texture, _paths.at(face), face, false);
+    }
+    return texture;
+}
+
+void TextureLoader::Update(std::size_t budget_bytes)
+{
+    // At least one image per call, so an image bigger than the budget still
+    // gets through.
+    //
+    PROFILE_SCOPE("TextureLoader::Update");
+    if (pixel_buffers_.empty())
+    {
+        pixel_buffers_.resize(_PIXEL_BUFFER_COUNT_);
+        glGenBuffers((GLsizei)pixel_buffers_.size(), pixel_buffers_.data());
+    }
+
+    std::size_t uploaded = 0;
+    while (uploaded < budget_bytes)
+    {
+        TextureLoader::Image image;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (decoded_.empty())
+            {
+                break;
+            }
+            image = std::move(decoded_.front());
+            decoded_.pop_front();
+        }
+        uploaded += upload(image);
+    }
+}
+
+uint32_t TextureLoader::GetLoadingCount()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (uint32_t)loading_.size();
+}
+
+TextureLoader::Image TextureLoader::Decode(const std::string _path, bool flip_vertical,
+    TEXCOMPRESSenum compression)
+{
+    // A failed decode leaves both the pixels and the levels empty.
+    //
+    PROFILE_SCOPE("TextureLoader::Decode");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    TextureLoader::Image image;
+    image.face = 0;
+    image.path = _path;
+    image.width = image.height = image.components = 0;
+    image.format = TEXCOMPRESSenum::NONE;
+    image.cached = false;
+
+    if (compression == TEXCOMPRESSenum::NONE)
+    {
+        image.pixels = std::shared_ptr<unsigned char>(
+            stbi_load(_path.c_str(), &image.width, &image.height, &image.components, 0), stbi_image_free);
+        if (image.pixels && flip_vertical)
+        {
+            flipRows(image.pixels.get(), image.width, image.height, image.components);
+        }
+    }
+    else
+    {
+        MappedFile source;
+        if (source.Open(_path))
+        {
+            uint64_t source_hash = TextureCache::SourceHash(source.GetData(), source.GetSize());
+            image.cache_file = TextureCache::Open(TextureCache::CachePath(_CACHE_DIRECTORY_, _path), 
+                source_hash, compression, flip_vertical ? 1 : 0);
+            if (image.cache_file)
+            {
+                image.format = TextureCache::GetFormat(*image.cache_file);
+                image.levels = TextureCache::GetLevels(*image.cache_file);
+                image.width = (int)image.levels.front().width;
+                image.height = (int)image.levels.front().height;
+                image.components = 4;
+                image.cached = true;
+            }
+            else
+            {
+                bake(image, source, source_hash, flip_vertical, compression);
+            }
+        }
+    }
+
+    image.decode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return image;
+}
+
+GLenum TextureLoader::GetFormat(int components)
+{
+    if (components == 1)
+    {
+        return GL_RED;
+    }
+    else if (components == 2)
+    {
+        return GL_RG;
+    }
+    else if (components == 4)
+    {
+        return GL_RGBA;
+    }
+    return GL_RGB;
+}
+
+GLenum TextureLoader::GetCompressedFormat(TEXCOMPRESSenum format)
+{
+    if (format == TEXCOMPRESSenum::BC1)
+    {
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+    else if (format == TEXCOMPRESSenum::BC3)
+    {
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    }
+    return GL_COMPRESSED_RGBA_BPTC_UNORM;
+}
+
+const char* TextureLoader::GetFormatName(TEXCOMPRESSenum format)
+{
+    if (format == TEXCOMPRESSenum::BC1)
+    {
+        return "BC1";
+    }
+    else if (format == TEXCOMPRESSenum::BC3)
+    {
+        return "BC3";
+    }
+    else if (format == TEXCOMPRESSenum::BC7)
+    {
+        return "BC7";
+    }
+    return "RAW";
+}
+
+GLenum TextureLoader::GetInternalFormat(int components)
+{
+    if (components == 1)
+    {
+        return GL_R8;
+    }
+    else if (components == 2)
+    {
+        return GL_RG8;
+    }
+    else if (components == 4)
+    {
+        return GL_RGBA8;
+    }
+    return GL_RGB8;
+}
+
+bool TextureLoader::hasExtension(const std::string _name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension != nullptr && _name == extension)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEXCOMPRESSenum TextureLoader::supportedCompression(TEXCOMPRESSenum compression)
+{
+    // Without S3TC an upload of BC1 or BC3 blocks fails with 
+    // GL_INVALID_ENUM and the texture stays black.
+    //
+    if (!s3tc_supported_ && (compression == TEXCOMPRESSenum::BC1 || compression == TEXCOMPRESSenum::BC3))
+    {
+        return TEXCOMPRESSenum::BC7;
+    }
+    return compression;
+}
+
+void TextureLoader::flipRows(unsigned char* pixels, int width, int height, int components)
+{
+    std::size_t row_size = (std::size_t)width * components;
+    std::vector<unsigned char> row(row_size);
+    for (int y = 0; y < height / 2; y++)
+    {
+        unsigned char* top = pixels + (std::size_t)y * row_size;
+        unsigned char* bottom = pixels + (std::size_t)(height - 1 - y) * row_size;
+        std::memcpy(row.data(), top, row_size);
+        std::memcpy(top, bottom, row_size);
+        std::memcpy(bottom, row.data(), row_size);
+    }
+}
+
+void TextureLoader::bake(TextureLoader::Image& image, const MappedFile& source, uint64_t source_hash,
+    bool flip_vertical, TEXCOMPRESSenum compression)
+{
+    // Decoded to RGBA whatever the file has, the compressors only take
+    // that. Every level down to 1x1 is kept, the loader decides how many
+    // it uploads.
+    //
+    PROFILE_SCOPE("TextureLoader::Bake");
+    int width = 0, height = 0, components = 0;
+    std::shared_ptr<unsigned char> pixels(stbi_load_from_memory(source.GetData(), (int)source.GetSize(),
+        &width, &height, &components, 4), stbi_image_free);
+    if (!pixels)
+    {
+        return;
+    }
+    if (flip_vertical)
+    {
+        flipRows(pixels.get(), width, height, 4);
+    }
+
+    image.width = width;
+    image.height = height;
+    image.components = 4;
+    image.format = (compression == TEXCOMPRESSenum::BC1 && (components == 2 || components == 4)) ? 
+        TEXCOMPRESSenum::BC3 : compression;
+
+    std::vector<uint8_t> level_pixels;
+    const uint8_t* rgba = pixels.get();
+    uint32_t level_width = (uint32_t)width, level_height = (uint32_t)height;
+    while (true)
+    {
+        TextureCache::Level level;
+        level.offset = image.blocks.size();
+        level.size = BlockCompressor::GetCompressedSize(level_width, level_height, image.format);
+        level.width = level_width;
+        level.height = level_height;
+        image.blocks.resize((std::size_t)(level.offset + level.size));
+        BlockCompressor::Compress(rgba, level_width, level_height, image.format, image.blocks.data() + level.offset);
+        image.levels.push_back(level);
+
+        if (level_width == 1 && level_height == 1)
+        {
+            break;
+        }
+        level_pixels = BlockCompressor::Downsample(rgba, level_width, level_height);
+        rgba = level_pixels.data();
+        level_width = std::max(level_width / 2, 1u);
+        level_height = std::max(level_height / 2, 1u);
+    }
+
+    std::cout << "INFO::TEXTURE_LOADER::BAKE::" << GetFormatName(image.format) << "::" << image.path << std::endl;
+    TextureCache::Write(TextureCache::CachePath(_CACHE_DIRECTORY_, image.path), source_hash, compression,
+        flip_vertical ? 1 : 0, image.format, image.levels, image.blocks.data());
+}
+
+void TextureLoader::decode(const TextureHandle& texture, const std::string _path, uint32_t face,
+    bool flip_vertical)
+{
+    TEXCOMPRESSenum compression = texture->_compression_;
+    job_system_.Run([this, texture, _path, face, flip_vertical, compression]() {
+        TextureLoader::Image image = Decode(_path, flip_vertical, compression);
+        image.texture = texture;
+        image.face = face;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        decoded_.push_back(std::move(image));
+    }, &decode_jobs_);
+}
+
+std::size_t TextureLoader::upload(TextureLoader::Image& image)
+{
+    // The data is copied into a pixel buffer and the texture is filled from
+    // there, the copy into the texture doesn't have to finish before the
+    // glTex*SubImage2D calls return. Each buffer of the ring is orphaned
+    // before it is written, so a transfer still reading it is never waited
+    // for. A compressed image goes in one buffer with all its levels.
+    //
+    AsyncTexture& texture = *image.texture;
+    if (texture.IsFailed())
+    {
+        return 0;
+    }
+    bool compressed = image.format != TEXCOMPRESSenum::NONE;
+    if (compressed ? image.levels.empty() : !image.pixels)
+    {
+        fail(texture, image.path);
+        return 0;
+    }
+    if (texture.id_ == 0 && !allocate(texture, image))
+    {
+        return 0;
+    }
+    if (image.width != texture.width_ || image.height != texture.height_ || image.components != texture.components_ ||
+        image.format != texture.format_ || (compressed && (int)image.levels.size() < texture.levels_))
+    {
+        std::cout << "ERROR::TEXTURE_LOADER::UPLOAD::IMAGE_SIZE_MISMATCH" << std::endl;
+        fail(texture, image.path);
+        return 0;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GLenum target = (texture._target_ == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + image.face : GL_TEXTURE_2D;
+    GLenum format = compressed ? GetCompressedFormat(image.format) : GetFormat(image.components);
+    int level_count = compressed ? texture.levels_ : 1;
+    std::size_t size = 0;
+    for (int level = 0; level < level_count; level++)
+    {
+        size += compressed ? (std::size_t)image.levels.at(level).size :
+            (std::size_t)image.width * image.height * image.components;
+    }
+    uint32_t pixel_buffer = pixel_buffers_.at(next_pixel_buffer_);
+    next_pixel_buffer_ = (next_pixel_buffer_ + 1) % (uint32_t)pixel_buffers_.size();
+
+    glBindTexture(texture._target_, texture.id_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_DRAW);
+    uint8_t* mapped = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    const uint8_t* source = compressed ? image.GetBlocks() : image.pixels.get();
+    if (mapped != nullptr)
+    {
+        std::size_t offset = 0;
+        for (int level = 0; level < level_count; level++)
+        {
+            std::size_t level_size = compressed ? (std::size_t)image.levels.at(level).size : size;
+            std::memcpy(mapped + offset, source + (compressed ? image.levels.at(level).offset : 0), level_size);
+            offset += level_size;
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    // Offsets into the bound buffer, or plain pointers without one.
+    //
+    std::size_t offset = 0;
+    for (int level = 0; level < level_count; level++)
+    {
+        if (compressed)
+        {
+            const TextureCache::Level& data = image.levels.at(level);
+            const void* pointer = (mapped != nullptr) ? (const void*)offset : (const void*)(source + data.offset);
+            glCompressedTexSubImage2D(target, level, 0, 0, (GLsizei)data.width, (GLsizei)data.height, format, 
+                (GLsizei)data.size, pointer);
+            offset += (std::size_t)data.size;
+        }
+        else
+        {
+            const void* pointer = (mapped != nullptr) ? (const void*)0 : (const void*)source;
+            glTexSubImage2D(target, 0, 0, 0, image.width, image.height, format, GL_UNSIGNED_BYTE, pointer);
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(texture._target_, 0);
+
+    texture.decode_ms_ += image.decode_ms;
+    texture.upload_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    texture.cached_images_ += image.cached ? 1 : 0;
+    if (--texture.pending_images_ == 0)
+    {
+        complete(texture);
+    }
+    return size;
+}
+
+bool TextureLoader::allocate(AsyncTexture& texture, const TextureLoader::Image& _image)
+{
+    // Immutable storage for every level, sized by the first image. A mipmap
+    // filter asks for the full chain, compressed images bring theirs.
+    //
+    bool mipmapped = texture._min_filter_ != GL_LINEAR && texture._min_filter_ != GL_NEAREST;
+    bool compressed = _image.format != TEXCOMPRESSenum::NONE;
+    texture.width_ = _image.width;
+    texture.height_ = _image.height;
+    texture.components_ = _image.components;
+    texture.format_ = _image.format;
+    texture.name_ = (texture._target_ == GL_TEXTURE_CUBE_MAP) ? 
+        _image.path.substr(0, _image.path.find_last_of('/') + 1) : _image.path;
+    if (!mipmapped)
+    {
+        texture.levels_ = 1;
+    }
+    else if (compressed)
+    {
+        texture.levels_ = (int)_image.levels.size();
+    }
+    else
+    {
+        texture.levels_ = (int)std::floor(std::log2((double)std::max(_image.width, _image.height))) + 1;
+    }
+    if (texture._target_ == GL_TEXTURE_CUBE_MAP && _image.width != _image.height)
+    {
+        std::cout << "ERROR::TEXTURE_LOADER::ALLOCATE::CUBEMAP_FACE_NOT_SQUARE" << std::endl;
+        fail(texture, _image.path);
+        return false;
+    }
+
+    // What the storage takes on the GPU. Drivers keep RGB8 as four bytes
+    // per texel.
+    //
+    std::size_t image_size = 0;
+    for (int level = 0; level < texture.levels_; level++)
+    {
+        std::size_t texels = (std::size_t)std::max(_image.width >> level, 1) * std::max(_image.height >> level, 1);
+        image_size += compressed ? (std::size_t)_image.levels.at(level).size :
+            texels * (_image.components == 3 ? 4 : _image.components);
+    }
+    texture.memory_size_ = image_size * texture._image_count_;
+
+    glGenTextures(1, &texture.id_);
+    glBindTexture(texture._target_, texture.id_);
+    glTexStorage2D(texture._target_, texture.levels_, 
+        compressed ? GetCompressedFormat(_image.format) : GetInternalFormat(_image.components),
+        _image.width, _image.height);
+    glBindTexture(texture._target_, 0);
+    return true;
+}
+
+void TextureLoader::complete(AsyncTexture& texture)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    glBindTexture(texture._target_, texture.id_);
+    if (texture.levels_ > 1 && texture.format_ == TEXCOMPRESSenum::NONE)
+    {
+        glGenerateMipmap(texture._target_);
+    }
+    glTexParameteri(texture._target_, GL_TEXTURE_WRAP_S, texture._wrapping_);
+    glTexParameteri(texture._target_, GL_TEXTURE_WRAP_T, texture._wrapping_);
+    if (texture._target_ == GL_TEXTURE_CUBE_MAP)
+    {
+        glTexParameteri(texture._target_, GL_TEXTURE_WRAP_R, texture._wrapping_);
+    }
+    glTexParameteri(texture._target_, GL_TEXTURE_MIN_FILTER, texture._min_filter_);
+    glTexParameteri(texture._target_, GL_TEXTURE_MAG_FILTER, texture._mag_filter_);
+    glBindTexture(texture._target_, 0);
+    texture.upload_ms_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "INFO::TEXTURE_LOADER::COMPLETE::" << texture.name_ << std::endl;
+    std::cout << "Format:" << GetFormatName(texture.format_) << "|Size:" << texture.width_ << "x" << texture.height_ <<
+        "x" << texture._image_count_ << "|Levels:" << texture.levels_ << "|Cached:" << texture.cached_images_ << "/" <<
+        texture._image_count_ << std::endl;
+    std::cout << "Decode:" << texture.decode_ms_ << "ms|Upload:" << texture.upload_ms_ << "ms|VRAM:" <<
+        texture.memory_size_ / 1024 << "KB" << std::endl;
+
+    texture.ready_.store(true, std::memory_order_release);
+    release(texture);
+}
+
+void TextureLoader::fail(AsyncTexture& texture, const std::string _path)
+{
+    std::cout << "ERROR::TEXTURE_LOADER::FAIL::FILE_READ_ERROR" << std::endl;
+    std::cout << "Path:" << _path << std::endl;
+    if (texture.id_ != 0)
+    {
+        glDeleteTextures(1, &texture.id_);
+        texture.id_ = 0;
+    }
+    texture.failed_.store(true, std::memory_order_release);
+    release(texture);
+}
+
+void TextureLoader::release(AsyncTexture& texture)
+{
+    // Images of a failed texture still in flight hold their own handle,
+    // they are dropped when Update gets to them.
+    //
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::vector<TextureHandle>::iterator it = loading_.begin(); it != loading_.end(); it++)
+    {
+        if (it->get() == &texture)
+        {
+            loading_.erase(it);
+            return;
+        }
+    }
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <chrono>
+
+#include <glad/glad.h>
+
+#include "Assets/BlockCompressor.h"
+#include "Cache/TextureCache.h"
+#include "Cache/MappedFile.h"
+#include "Jobs/JobSystem.h"
+#include "Profiler/Profiler.h"
+#include "Types/ETexture.h"
+
+// S3TC isn't core, glad was generated without the extension. The loader
+// checks for it once and asks for BC7 (core since 4.2) without it.
+//
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// A texture that is still being loaded, the future side of a TextureLoader
+// request. GetId is 0 until every image of the texture is uploaded, users
+// check IsReady (or just bind 0 and draw nothing) until then. A texture
+// whose file couldn't be decoded never gets ready, it turns failed instead.
+//
+// The timings and the memory size are final once the texture is ready:
+// decode time is the job time summed over the images (cache reads or
+// decode and compression), upload time the main thread time spent on them.
+//
+class AsyncTexture
+{
+public:
+    AsyncTexture(GLenum target, uint32_t image_count, GLenum wrapping,
+        GLenum min_filter, GLenum mag_filter, TEXCOMPRESSenum compression);
+    ~AsyncTexture();
+
+    AsyncTexture(const AsyncTexture&) = delete;
+    AsyncTexture& operator=(const AsyncTexture&) = delete;
+
+    bool IsReady() const;
+    bool IsFailed() const;
+    uint32_t GetId() const;
+    GLenum GetTarget() const;
+    int GetWidth() const;
+    int GetHeight() const;
+    double GetDecodeTime() const;
+    double GetUploadTime() const;
+    std::size_t GetMemorySize() const;
+
+private:
+    friend class TextureLoader;
+
+    const GLenum _target_;
+    const GLenum _wrapping_;
+    const GLenum _min_filter_;
+    const GLenum _mag_filter_;
+    const TEXCOMPRESSenum _compression_;
+    const uint32_t _image_count_;
+    std::atomic<bool> ready_;
+    std::atomic<bool> failed_;
+
+    // Only touched by TextureLoader::Update on the context thread.
+    //
+    uint32_t id_;
+    uint32_t pending_images_;
+    int width_;
+    int height_;
+    int components_;
+    int levels_;
+    TEXCOMPRESSenum format_;
+    std::string name_;
+    double decode_ms_;
+    double upload_ms_;
+    std::size_t memory_size_;
+    uint32_t cached_images_;
+};
+
+typedef std::shared_ptr<AsyncTexture> TextureHandle;
+
+// Loads 2D textures and cube maps without blocking the thread that owns the
+// GL context. Requests can come from any thread, every image is decoded by
+// a job. Update runs on the context thread once a frame: it allocates the
+// storage of a texture when its first image arrives, streams the decoded
+// images through a ring of pixel buffer objects and builds the mipmaps once
+// the last image of a texture is in, so a cube map gets one mipmap pass and
+// not one per face.
+//
+// A texture asked for with compression is never uploaded as raw pixels: the
+// decode job reads the blocks of every level from the texture cache, or
+// decodes, builds the mip chain, compresses it and writes the cache for the
+// next launch.
+//
+class TextureLoader
+{
+public:
+    // Either pixels (format NONE) or the blocks of every level, held by the
+    // mapped cache file or the image itself.
+    //
+    struct Image
+    {
+        TextureHandle texture;
+        uint32_t face;
+        std::string path;
+        int width;
+        int height;
+        int components;
+        std::shared_ptr<unsigned char> pixels;
+        TEXCOMPRESSenum format;
+        std::vector<TextureCache::Level> levels;
+        std::shared_ptr<MappedFile> cache_file;
+        std::vector<uint8_t> blocks;
+        bool cached;
+        double decode_ms;
+
+        const uint8_t* GetBlocks() const;
+    };
+
+    TextureLoader(JobSystem& job_system);
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    TextureHandle LoadTexture(const std::string _path, bool flip_vertical = true,
+        GLenum wrapping = GL_REPEAT, GLenum min_filter = GL_LINEAR_MIPMAP_LINEAR,
+        GLenum mag_filter = GL_LINEAR, TEXCOMPRESSenum compression = TEXCOMPRESSenum::BC1);
+    TextureHandle LoadCubemap(const std::vector<std::string>& _paths,
+        GLenum min_filter = GL_LINEAR, GLenum mag_filter = GL_LINEAR,
+        TEXCOMPRESSenum compression = TEXCOMPRESSenum::BC7);
+    void Update(std::size_t budget_bytes = _UPLOAD_BUDGET_);
+    uint32_t GetLoadingCount();
+
+    // Decodes on the calling thread. Flipping is done here and not through
+    // stb_image's switch, which is global and would race between jobs.
+    //
+    static TextureLoader::Image Decode(const std::string _path, bool flip_vertical,
+        TEXCOMPRESSenum compression = TEXCOMPRESSenum::NONE);
+    static GLenum GetFormat(int components);
+    static GLenum GetInternalFormat(int components);
+    static GLenum GetCompressedFormat(TEXCOMPRESSenum format);
+    static const char* GetFormatName(TEXCOMPRESSenum format);
+
+private:
+    JobSystem& job_system_;
+    JobCounter decode_jobs_;
+
+    // Shared with the decode jobs. loading_ keeps every texture that isn't
+    // done yet alive until Update is through with it.
+    //
+    std::mutex mutex_;
+    std::deque<TextureLoader::Image> decoded_;
+    std::vector<TextureHandle> loading_;
+
+    std::vector<uint32_t> pixel_buffers_;
+    uint32_t next_pixel_buffer_;
+    bool s3tc_supported_;
+
+    static const std::size_t _UPLOAD_BUDGET_;
+    static const uint32_t _PIXEL_BUFFER_COUNT_;
+    static const std::string _CACHE_DIRECTORY_;
+
+    static bool hasExtension(const std::string _name);
+    static void flipRows(unsigned char* pixels, int width, int height, int components);
+    static void bake(TextureLoader::Image& image, const MappedFile& source, uint64_t source_hash,
+        bool flip_vertical, TEXCOMPRESSenum compression);
+    TEXCOMPRESSenum supportedCompression(TEXCOMPRESSenum compression);
+    void decode(const TextureHandle& texture, const std::string _path, uint32_t face,
+        bool flip_vertical);
+    std::size_t upload(TextureLoader::Image& image);
+    bool allocate(AsyncTexture& texture, const TextureLoader::Image& _image);
+    void complete(AsyncTexture& texture);
+    void fail(AsyncTexture& texture, const std::string _path);
+    void release(AsyncTexture& texture);
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <iostream>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Offscreen render target, an sRGB color and a depth renderbuffer. Used by 
+// the headless benchmark in place of the default framebuffer.
+//
+class FrameBuffer
+{
+public:
+    FrameBuffer(uint32_t width, uint32_t height);
+    ~FrameBuffer();
+
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+    void Bind();
+    void Unbind();
+    bool IsComplete();
+    uint32_t GetId() const;
+
+private:
+    uint32_t id_;
+    uint32_t color_id_;
+    uint32_t depth_id_;
+    uint32_t width_;
+    uint32_t height_;
+
+    void generate();
+    void remove();
+};
+
+inline FrameBuffer::FrameBuffer(uint32_t width, uint32_t height) :
+    width_(width),
+    height_(height)
+{
+    generate();
+}
+
+inline FrameBuffer::~FrameBuffer()
+{
+    remove();
+}
+
+inline void FrameBuffer::Bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, id_);
+    glViewport(0, 0, width_, height_);
+}
+
+inline void FrameBuffer::Unbind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+inline bool FrameBuffer::IsComplete()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, id_);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+inline uint32_t FrameBuffer::GetId() const
+{
+    return id_;
+}
+
+inline void FrameBuffer::generate()
+{
+    glGenRenderbuffers(1, &color_id_);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_id_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_SRGB8_ALPHA8, width_, height_);
+
+    glGenRenderbuffers(1, &depth_id_);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_id_);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width_, height_);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &id_);
+    glBindFramebuffer(GL_FRAMEBUFFER, id_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_id_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_id_);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+inline void FrameBuffer::remove()
+{
+    glDeleteFramebuffers(1, &id_);
+    glDeleteRenderbuffers(1, &color_id_);
+    glDeleteRenderbuffers(1, &depth_id_);
+}
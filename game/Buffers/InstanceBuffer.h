@@ -0,0 +1,179 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Persistent per-instance vertex buffer. The buffer object lives as long as
+// its owner, so instanced draws only pay for an upload when the instance set
+// actually changes. Full uploads orphan the previous storage, partial updates
+// only touch the dirty range.
+//
+template <class T>
+class InstanceBuffer
+{
+public:
+    InstanceBuffer(uint32_t capacity = 0);
+    ~InstanceBuffer();
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    void Data(const std::vector<T>& data);
+    void SubData(const std::vector<T>& data, uint32_t sub_start);
+    void SubData(const T& data, uint32_t index);
+    void SetCount(uint32_t count);
+
+    uint32_t GetId() const;
+    uint32_t GetCount() const;
+    uint32_t GetCapacity() const;
+
+private:
+    uint32_t id_;
+    std::size_t single_size_;
+    uint32_t capacity_;
+    uint32_t count_;
+
+    void generate();
+    void bind();
+    void allocate();
+    void unbind();
+    void remove();
+};
+
+template<class T>
+inline InstanceBuffer<T>::InstanceBuffer(uint32_t capacity) :
+    single_size_(sizeof(T)),
+    capacity_(capacity),
+    count_(0)
+{
+    generate();
+    bind();
+    allocate();
+    unbind();
+}
+
+template<class T>
+inline InstanceBuffer<T>::~InstanceBuffer()
+{
+    remove();
+}
+
+template<class T>
+inline void InstanceBuffer<T>::Data(const std::vector<T>& data)
+{
+    bind();
+
+    // Grow geometrically so a slowly growing instance set doesn't reallocate
+    // on every change. When the storage is big enough we still re-specify it
+    // with a NULL pointer (orphaning) so the driver can hand us fresh memory
+    // instead of waiting for in-flight draws that read the old contents.
+    //
+    if (data.size() > capacity_)
+    {
+        capacity_ = std::max((uint32_t)data.size(), capacity_ * 2);
+    }
+    allocate();
+
+    if (!data.empty())
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, data.size() * single_size_, data.data());
+    }
+    count_ = (uint32_t)data.size();
+
+    unbind();
+}
+
+template<class T>
+inline void InstanceBuffer<T>::SubData(const std::vector<T>& data, uint32_t sub_start)
+{
+    if (data.size() > capacity_)
+    {
+        Data(data);
+        return;
+    }
+
+    // Only the range [sub_start, data.size()) is dirty.
+    //
+    bind();
+    if (sub_start < data.size())
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, sub_start * single_size_,
+            (data.size() - sub_start) * single_size_, data.data() + sub_start);
+    }
+    count_ = (uint32_t)data.size();
+    unbind();
+}
+
+template<class T>
+inline void InstanceBuffer<T>::SubData(const T& data, uint32_t index)
+{
+    if (index >= capacity_)
+    {
+        return;
+    }
+
+    bind();
+    glBufferSubData(GL_ARRAY_BUFFER, index * single_size_, single_size_, &data);
+    unbind();
+}
+
+template<class T>
+inline void InstanceBuffer<T>::SetCount(uint32_t count)
+{
+    count_ = std::min(count, capacity_);
+}
+
+template<class T>
+inline uint32_t InstanceBuffer<T>::GetId() const
+{
+    return id_;
+}
+
+template<class T>
+inline uint32_t InstanceBuffer<T>::GetCount() const
+{
+    return count_;
+}
+
+template<class T>
+inline uint32_t InstanceBuffer<T>::GetCapacity() const
+{
+    return capacity_;
+}
+
+template<class T>
+inline void InstanceBuffer<T>::generate()
+{
+    glGenBuffers(1, &id_);
+}
+
+template<class T>
+inline void InstanceBuffer<T>::bind()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, id_);
+}
+
+template<class T>
+inline void InstanceBuffer<T>::allocate()
+{
+    glBufferData(GL_ARRAY_BUFFER, capacity_ * single_size_, NULL, GL_DYNAMIC_DRAW);
+}
+
+template<class T>
+inline void InstanceBuffer<T>::unbind()
+{
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+template<class T>
+inline void InstanceBuffer<T>::remove()
+{
+    glDeleteBuffers(1, &id_);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free hand over of the latest value from one producer thread to one
+// consumer thread. The producer fills the back slot and publishes it by
+// swapping it with the middle slot, the consumer picks the middle slot up
+// by swapping it with its front slot. Neither side ever waits, the consumer
+// just sees the newest value published so far, values in between are
+// skipped.
+//
+template <class T>
+class TripleBuffer
+{
+public:
+    TripleBuffer();
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    T& GetWriteBuffer();
+    void Publish();
+
+    bool Update();
+    const T& GetReadBuffer() const;
+
+private:
+    T slots_[3];
+    uint8_t write_index_;
+    uint8_t read_index_;
+    std::atomic<uint8_t> middle_;
+
+    // Set on the middle index while it holds a value the consumer hasn't
+    // picked up yet.
+    //
+    static const uint8_t _FRESH_ = 4;
+    static const uint8_t _INDEX_MASK_ = 3;
+};
+
+template<class T>
+inline TripleBuffer<T>::TripleBuffer() :
+    write_index_(0),
+    read_index_(1),
+    middle_(2)
+{
+}
+
+template<class T>
+inline T& TripleBuffer<T>::GetWriteBuffer()
+{
+    return slots_[write_index_];
+}
+
+template<class T>
+inline void TripleBuffer<T>::Publish()
+{
+    // Release makes the write visible to the consumer's acquire, the slot
+    // coming back is one the consumer is done with.
+    //
+    uint8_t previous = middle_.exchange(write_index_ | _FRESH_, std::memory_order_acq_rel);
+    write_index_ = previous & _INDEX_MASK_;
+}
+
+template<class T>
+inline bool TripleBuffer<T>::Update()
+{
+    if ((middle_.load(std::memory_order_relaxed) & _FRESH_) == 0)
+    {
+        return false;
+    }
+
+    uint8_t previous = middle_.exchange(read_index_, std::memory_order_acq_rel);
+    read_index_ = previous & _INDEX_MASK_;
+    return true;
+}
+
+template<class T>
+inline const T& TripleBuffer<T>::GetReadBuffer() const
+{
+    return slots_[read_index_];
+}
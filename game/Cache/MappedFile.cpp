@@ -0,0 +1,140 @@
+#include "Cache/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+std::atomic<uint32_t> MappedFile::temp_counter_(0);
+
+MappedFile::MappedFile() :
+    data_(nullptr),
+    size_(0),
+#ifdef _WIN32
+    file_handle_(INVALID_HANDLE_VALUE),
+    mapping_handle_(NULL)
+#else
+    file_descriptor_(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string _path)
+{
+    Close();
+
+#ifdef _WIN32
+    file_handle_ = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file_handle_ == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle_, &file_size) || file_size.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    mapping_handle_ = CreateFileMappingA(file_handle_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping_handle_ == NULL)
+    {
+        Close();
+        return false;
+    }
+
+    data_ = (const uint8_t*)MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0);
+    size_ = (std::size_t)file_size.QuadPart;
+#else
+    file_descriptor_ = open(_path.c_str(), O_RDONLY);
+    if (file_descriptor_ < 0)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(file_descriptor_, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        Close();
+        return false;
+    }
+
+    void* mapping = mmap(NULL, (std::size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, file_descriptor_, 0);
+    data_ = (mapping == MAP_FAILED) ? nullptr : (const uint8_t*)mapping;
+    size_ = (std::size_t)file_stat.st_size;
+#endif
+
+    if (data_ == nullptr)
+    {
+        std::cout << "ERROR::MAPPED_FILE::OPEN::MAPPING_FAILED::" << _path << std::endl;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (data_ != nullptr)
+    {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_ != NULL)
+    {
+        CloseHandle(mapping_handle_);
+        mapping_handle_ = NULL;
+    }
+    if (file_handle_ != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(file_handle_);
+        file_handle_ = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (data_ != nullptr)
+    {
+        munmap((void*)data_, size_);
+    }
+    if (file_descriptor_ >= 0)
+    {
+        close(file_descriptor_);
+        file_descriptor_ = -1;
+    }
+#endif
+
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+    return data_ != nullptr;
+}
+
+const uint8_t* MappedFile::GetData() const
+{
+    return data_;
+}
+
+std::size_t MappedFile::GetSize() const
+{
+    return size_;
+}
+
+std::string MappedFile::TempPath(const std::string _path)
+{
+    return _path + "." + std::to_string(temp_counter_.fetch_add(1)) + ".tmp";
+}
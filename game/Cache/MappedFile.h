@@ -0,0 +1,42 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <atomic>
+
+// Read only memory mapping of a whole file. The mapping stays valid until 
+// Close or destruction, pointers into GetData must not outlive it.
+//
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string _path);
+    void Close();
+
+    bool IsOpen() const;
+    const uint8_t* GetData() const;
+    std::size_t GetSize() const;
+
+    // Where a cache writes before it renames to _path. Every call gets its
+    // own name, so two writers of the same file don't share a temporary.
+    //
+    static std::string TempPath(const std::string _path);
+
+private:
+    const uint8_t* data_;
+    std::size_t size_;
+#ifdef _WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#else
+    int file_descriptor_;
+#endif
+
+    static std::atomic<uint32_t> temp_counter_;
+};
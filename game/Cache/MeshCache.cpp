@@ -0,0 +1,237 @@
+#include "Cache/MeshCache.h"
+
+const char MeshCache::_MAGIC_[4] = { 'S', 'G', 'M', 'C' };
+const uint32_t MeshCache::_VERSION_ = 1;
+const uint64_t MeshCache::_ALIGNMENT_ = 16;
+
+std::string MeshCache::CachePath(const std::string _directory, const std::string _source_path)
+{
+    // The file name alone isn't unique enough (every model could be called
+    // model.obj), so the parent directory goes into the name as well.
+    //
+    std::filesystem::path source(_source_path);
+    std::string parent = source.parent_path().filename().string();
+    return _directory + (parent.empty() ? "" : parent + "_") + source.stem().string() + ".mch";
+}
+
+uint64_t MeshCache::SourceHash(const std::string _source_path)
+{
+    // FNV-1a over the OBJ and every material library it names, the material
+    // colors come from the .mtl files.
+    //
+    MappedFile source;
+    if (!source.Open(_source_path))
+    {
+        return 0;
+    }
+
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashBytes(hash, source.GetData(), source.GetSize());
+
+    std::string directory = std::filesystem::path(_source_path).parent_path().string();
+    const char* text = (const char*)source.GetData();
+    const std::string _keyword = "mtllib ";
+    std::size_t line_start = 0;
+    while (line_start < source.GetSize())
+    {
+        std::size_t line_end = line_start;
+        while (line_end < source.GetSize() && text[line_end] != '\n')
+        {
+            line_end++;
+        }
+
+        std::string line(text + line_start, line_end - line_start);
+        if (line.compare(0, _keyword.size(), _keyword) == 0)
+        {
+            std::string library = line.substr(_keyword.size());
+            library.erase(library.find_last_not_of(" \t\r") + 1);
+
+            MappedFile material;
+            if (material.Open((std::filesystem::path(directory) / library).string()))
+            {
+                hash = hashBytes(hash, material.GetData(), material.GetSize());
+            }
+        }
+        line_start = line_end + 1;
+    }
+
+    return hash;
+}
+
+std::shared_ptr<MappedFile> MeshCache::Open(const std::string _path, const uint64_t _source_hash,
+    const uint32_t _vertex_size)
+{
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->Open(_path))
+    {
+        return nullptr;
+    }
+
+    if (file->GetSize() < sizeof(MeshCache::Header))
+    {
+        std::cout << "ERROR::MESH_CACHE::OPEN::TRUNCATED_HEADER::" << _path << std::endl;
+        return nullptr;
+    }
+
+    const MeshCache::Header* header = (const MeshCache::Header*)file->GetData();
+    if (!std::equal(header->magic, header->magic + 4, _MAGIC_) || header->version != _VERSION_ ||
+        header->vertex_size != _vertex_size)
+    {
+        std::cout << "ERROR::MESH_CACHE::OPEN::LAYOUT_MISMATCH::" << _path << std::endl;
+        return nullptr;
+    }
+
+    // The source changed since it was baked, not an error.
+    //
+    if (header->source_hash != _source_hash)
+    {
+        std::cout << "INFO::MESH_CACHE::OPEN::STALE::" << _path << std::endl;
+        return nullptr;
+    }
+
+    if (!inFile(*file, sizeof(MeshCache::Header), header->mesh_count, sizeof(MeshCache::MeshEntry)))
+    {
+        std::cout << "ERROR::MESH_CACHE::OPEN::TRUNCATED_TABLE::" << _path << std::endl;
+        return nullptr;
+    }
+
+    const MeshCache::MeshEntry* entries = (const MeshCache::MeshEntry*)(file->GetData() + sizeof(MeshCache::Header));
+    for (uint32_t i = 0; i < header->mesh_count; i++)
+    {
+        const MeshCache::MeshEntry& entry = entries[i];
+        if (!inFile(*file, entry.vertex_offset, entry.vertex_count, _vertex_size) ||
+            !inFile(*file, entry.index_offset, entry.index_count, sizeof(uint32_t)) ||
+            !inFile(*file, entry.material_offset, entry.material_count, sizeof(MeshCache::Material)))
+        {
+            std::cout << "ERROR::MESH_CACHE::OPEN::BAD_MESH_" << i << "::" << _path << std::endl;
+            return nullptr;
+        }
+    }
+
+    return file;
+}
+
+bool MeshCache::Write(const std::string _path, const uint64_t _source_hash,
+    const uint32_t _vertex_size, const std::vector<MeshCache::MeshData>& meshes)
+{
+    MeshCache::Header header = {};
+    std::copy(_MAGIC_, _MAGIC_ + 4, header.magic);
+    header.version = _VERSION_;
+    header.source_hash = _source_hash;
+    header.vertex_size = _vertex_size;
+    header.mesh_count = (uint32_t)meshes.size();
+
+    // Lay out the data of every mesh after the table: vertices, indices and
+    // materials, each array starting on a 16 byte boundary.
+    //
+    std::vector<MeshCache::MeshEntry> entries(meshes.size());
+    uint64_t offset = sizeof(MeshCache::Header) + meshes.size() * sizeof(MeshCache::MeshEntry);
+    for (std::size_t i = 0; i < meshes.size(); i++)
+    {
+        offset = (offset + _ALIGNMENT_ - 1) / _ALIGNMENT_ * _ALIGNMENT_;
+        entries.at(i).vertex_offset = offset;
+        entries.at(i).vertex_count = meshes.at(i).vertex_count;
+        offset += meshes.at(i).vertex_count * _vertex_size;
+
+        offset = (offset + _ALIGNMENT_ - 1) / _ALIGNMENT_ * _ALIGNMENT_;
+        entries.at(i).index_offset = offset;
+        entries.at(i).index_count = meshes.at(i).index_count;
+        offset += meshes.at(i).index_count * sizeof(uint32_t);
+
+        offset = (offset + _ALIGNMENT_ - 1) / _ALIGNMENT_ * _ALIGNMENT_;
+        entries.at(i).material_offset = offset;
+        entries.at(i).material_count = meshes.at(i).material_count;
+        offset += meshes.at(i).material_count * sizeof(MeshCache::Material);
+    }
+
+    // Write next to the final file and rename, like the world cache.
+    //
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(_path).parent_path(), error);
+    std::string temp_path = MappedFile::TempPath(_path);
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::MESH_CACHE::WRITE::CANNOT_OPEN::" << temp_path << std::endl;
+            return false;
+        }
+
+        file.write((const char*)&header, sizeof(MeshCache::Header));
+        if (!entries.empty())
+        {
+            file.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(MeshCache::MeshEntry)));
+        }
+
+        const char padding[16] = { 0 };
+        uint64_t written = sizeof(MeshCache::Header) + entries.size() * sizeof(MeshCache::MeshEntry);
+        for (std::size_t i = 0; i < meshes.size(); i++)
+        {
+            const uint64_t offsets[3] = { entries.at(i).vertex_offset, entries.at(i).index_offset, entries.at(i).material_offset };
+            const void* data[3] = { meshes.at(i).vertices, meshes.at(i).indices, meshes.at(i).materials };
+            const uint64_t bytes[3] = { meshes.at(i).vertex_count * _vertex_size,
+                meshes.at(i).index_count * sizeof(uint32_t),
+                meshes.at(i).material_count * sizeof(MeshCache::Material) };
+            for (int j = 0; j < 3; j++)
+            {
+                file.write(padding, (std::streamsize)(offsets[j] - written));
+                if (bytes[j] > 0)
+                {
+                    file.write((const char*)data[j], (std::streamsize)bytes[j]);
+                }
+                written = offsets[j] + bytes[j];
+            }
+        }
+
+        if (!file.good())
+        {
+            std::cout << "ERROR::MESH_CACHE::WRITE::FAILED::" << temp_path << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, _path, error);
+    if (error)
+    {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+}
+
+std::vector<MeshCache::MeshData> MeshCache::GetMeshes(const MappedFile& file)
+{
+    const MeshCache::Header* header = (const MeshCache::Header*)file.GetData();
+    const MeshCache::MeshEntry* entries = (const MeshCache::MeshEntry*)(file.GetData() + sizeof(MeshCache::Header));
+
+    std::vector<MeshCache::MeshData> meshes(header->mesh_count);
+    for (uint32_t i = 0; i < header->mesh_count; i++)
+    {
+        meshes.at(i).vertices = file.GetData() + entries[i].vertex_offset;
+        meshes.at(i).vertex_count = entries[i].vertex_count;
+        meshes.at(i).indices = (const uint32_t*)(file.GetData() + entries[i].index_offset);
+        meshes.at(i).index_count = entries[i].index_count;
+        meshes.at(i).materials = (const MeshCache::Material*)(file.GetData() + entries[i].material_offset);
+        meshes.at(i).material_count = entries[i].material_count;
+    }
+
+    return meshes;
+}
+
+uint64_t MeshCache::hashBytes(uint64_t hash, const uint8_t* data,
+    const std::size_t _size)
+{
+    for (std::size_t i = 0; i < _size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool MeshCache::inFile(const MappedFile& file, const uint64_t _offset,
+    const uint64_t _count, const uint64_t _element_size)
+{
+    return _offset % _ALIGNMENT_ == 0 && _offset <= file.GetSize() &&
+        _count <= (file.GetSize() - _offset) / _element_size;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+
+#include "Cache/MappedFile.h"
+
+// Baked model meshes, so a warm start doesn't go through Assimp. One file per
+// source model holds a fixed header with a content hash of the source (the
+// OBJ and the material libraries it references), a table with one entry per
+// mesh and the raw, 16 byte aligned vertex, index and material color arrays.
+// A file whose hash doesn't match the source on disk is ignored and baked
+// again. Loading maps the file, the vertex and index arrays can be handed to
+// glBufferData as they are.
+//
+class MeshCache
+{
+public:
+    struct Material
+    {
+        glm::vec4 color;
+        uint32_t type;
+        uint32_t format;
+        uint32_t padding[2];
+    };
+
+    struct MeshData
+    {
+        const void* vertices;
+        uint64_t vertex_count;
+        const uint32_t* indices;
+        uint64_t index_count;
+        const MeshCache::Material* materials;
+        uint64_t material_count;
+    };
+
+    static std::string CachePath(const std::string _directory, const std::string _source_path);
+    static uint64_t SourceHash(const std::string _source_path);
+    static std::shared_ptr<MappedFile> Open(const std::string _path, const uint64_t _source_hash,
+        const uint32_t _vertex_size);
+    static bool Write(const std::string _path, const uint64_t _source_hash,
+        const uint32_t _vertex_size, const std::vector<MeshCache::MeshData>& meshes);
+    static std::vector<MeshCache::MeshData> GetMeshes(const MappedFile& file);
+
+private:
+    struct MeshEntry
+    {
+        uint64_t vertex_offset;
+        uint64_t vertex_count;
+        uint64_t index_offset;
+        uint64_t index_count;
+        uint64_t material_offset;
+        uint64_t material_count;
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t source_hash;
+        uint32_t vertex_size;
+        uint32_t mesh_count;
+        uint32_t padding[2];
+    };
+
+    static const char _MAGIC_[4];
+    static const uint32_t _VERSION_;
+    static const uint64_t _ALIGNMENT_;
+
+    MeshCache();
+
+    static uint64_t hashBytes(uint64_t hash, const uint8_t* data,
+        const std::size_t _size);
+    static bool inFile(const MappedFile& file, const uint64_t _offset,
+        const uint64_t _count, const uint64_t _element_size);
+};
@@ -0,0 +1,126 @@
+#include "Cache/ShaderCache.h"
+
+const char ShaderCache::_MAGIC_[4] = { 'S', 'G', 'S', 'C' };
+const uint32_t ShaderCache::_VERSION_ = 1;
+
+std::string ShaderCache::CachePath(const std::string _directory, const std::vector<std::string>& _source_paths)
+{
+    // Programs share stage files (and stage file names), so the name ends
+    // in a hash of every stage path.
+    //
+    std::filesystem::path source(_source_paths.empty() ? "" : _source_paths.front());
+    std::string parent = source.parent_path().filename().string();
+    std::stringstream name;
+    name << (parent.empty() ? "" : parent + "_") << source.stem().string() << "_" <<
+        std::hex << std::setw(8) << std::setfill('0') << (uint32_t)Hash(_source_paths) << ".shc";
+    return _directory + name.str();
+}
+
+uint64_t ShaderCache::Hash(const std::vector<std::string>& _texts)
+{
+    // FNV-1a over every text, the terminating zero keeps "ab" + "c" apart
+    // from "a" + "bc".
+    //
+    uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < _texts.size(); i++)
+    {
+        const std::string& text = _texts.at(i);
+        for (std::size_t j = 0; j <= text.size(); j++)
+        {
+            hash ^= (uint8_t)text.c_str()[j];
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+std::shared_ptr<MappedFile> ShaderCache::Open(const std::string _path, const uint64_t _source_hash,
+    const uint64_t _driver_hash)
+{
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->Open(_path))
+    {
+        return nullptr;
+    }
+
+    if (file->GetSize() < sizeof(ShaderCache::Header))
+    {
+        std::cout << "ERROR::SHADER_CACHE::OPEN::TRUNCATED_HEADER::" << _path << std::endl;
+        return nullptr;
+    }
+
+    const ShaderCache::Header* header = (const ShaderCache::Header*)file->GetData();
+    if (!std::equal(header->magic, header->magic + 4, _MAGIC_) || header->version != _VERSION_)
+    {
+        std::cout << "ERROR::SHADER_CACHE::OPEN::LAYOUT_MISMATCH::" << _path << std::endl;
+        return nullptr;
+    }
+
+    // Edited sources or a driver update, not an error.
+    //
+    if (header->source_hash != _source_hash || header->driver_hash != _driver_hash)
+    {
+        std::cout << "INFO::SHADER_CACHE::OPEN::STALE::" << _path << std::endl;
+        return nullptr;
+    }
+
+    if (header->binary_size == 0 || header->binary_size > file->GetSize() - sizeof(ShaderCache::Header))
+    {
+        std::cout << "ERROR::SHADER_CACHE::OPEN::TRUNCATED_BINARY::" << _path << std::endl;
+        return nullptr;
+    }
+
+    return file;
+}
+
+bool ShaderCache::Write(const std::string _path, const uint64_t _source_hash, const uint64_t _driver_hash,
+    const ShaderCache::Binary& binary)
+{
+    ShaderCache::Header header = {};
+    std::copy(_MAGIC_, _MAGIC_ + 4, header.magic);
+    header.version = _VERSION_;
+    header.source_hash = _source_hash;
+    header.driver_hash = _driver_hash;
+    header.binary_format = binary.format;
+    header.binary_size = binary.size;
+
+    // Write next to the final file and rename, like the other caches.
+    //
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(_path).parent_path(), error);
+    std::string temp_path = MappedFile::TempPath(_path);
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::SHADER_CACHE::WRITE::CANNOT_OPEN::" << temp_path << std::endl;
+            return false;
+        }
+
+        file.write((const char*)&header, sizeof(ShaderCache::Header));
+        file.write((const char*)binary.data, (std::streamsize)binary.size);
+        if (!file.good())
+        {
+            std::cout << "ERROR::SHADER_CACHE::WRITE::FAILED::" << temp_path << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, _path, error);
+    if (error)
+    {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+}
+
+ShaderCache::Binary ShaderCache::GetBinary(const MappedFile& file)
+{
+    const ShaderCache::Header* header = (const ShaderCache::Header*)file.GetData();
+    ShaderCache::Binary binary;
+    binary.format = header->binary_format;
+    binary.data = file.GetData() + sizeof(ShaderCache::Header);
+    binary.size = header->binary_size;
+    return binary;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+
+#include "Cache/MappedFile.h"
+
+// Linked program binaries from glGetProgramBinary, so a warm start skips
+// compiling and linking GLSL. One file per program holds a fixed header with
+// a hash of the stage sources, a hash of the driver (vendor, renderer and
+// version strings), the binary format and the binary itself. A binary is
+// only valid for the driver that produced it: a file whose hashes don't
+// match is ignored and written again after the program is compiled.
+//
+class ShaderCache
+{
+public:
+    struct Binary
+    {
+        uint32_t format;
+        const uint8_t* data;
+        uint64_t size;
+    };
+
+    static std::string CachePath(const std::string _directory, const std::vector<std::string>& _source_paths);
+    static uint64_t Hash(const std::vector<std::string>& _texts);
+    static std::shared_ptr<MappedFile> Open(const std::string _path, const uint64_t _source_hash,
+        const uint64_t _driver_hash);
+    static bool Write(const std::string _path, const uint64_t _source_hash, const uint64_t _driver_hash,
+        const ShaderCache::Binary& binary);
+    static ShaderCache::Binary GetBinary(const MappedFile& file);
+
+private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t source_hash;
+        uint64_t driver_hash;
+        uint32_t binary_format;
+        uint32_t padding;
+        uint64_t binary_size;
+    };
+
+    static const char _MAGIC_[4];
+    static const uint32_t _VERSION_;
+
+    ShaderCache();
+};
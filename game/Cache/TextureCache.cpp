@@ -0,0 +1,155 @@
+#include "Cache/TextureCache.h"
+
+const char TextureCache::_MAGIC_[4] = { 'S', 'G', 'T', 'C' };
+const uint32_t TextureCache::_VERSION_ = 1;
+const uint64_t TextureCache::_ALIGNMENT_ = 16;
+
+std::string TextureCache::CachePath(const std::string _directory, const std::string _source_path)
+{
+    // Like the mesh cache, the parent directory keeps the six right.jpg of
+    // different skyboxes apart.
+    //
+    std::filesystem::path source(_source_path);
+    std::string parent = source.parent_path().filename().string();
+    return _directory + (parent.empty() ? "" : parent + "_") + source.stem().string() + ".tch";
+}
+
+uint64_t TextureCache::SourceHash(const uint8_t* data, const std::size_t _size)
+{
+    // FNV-1a over the encoded file.
+    //
+    uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < _size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::shared_ptr<MappedFile> TextureCache::Open(const std::string _path, const uint64_t _source_hash,
+    const TEXCOMPRESSenum _requested, const uint32_t _flags)
+{
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->Open(_path))
+    {
+        return nullptr;
+    }
+
+    if (file->GetSize() < sizeof(TextureCache::Header))
+    {
+        std::cout << "ERROR::TEXTURE_CACHE::OPEN::TRUNCATED_HEADER::" << _path << std::endl;
+        return nullptr;
+    }
+
+    const TextureCache::Header* header = (const TextureCache::Header*)file->GetData();
+    if (!std::equal(header->magic, header->magic + 4, _MAGIC_) || header->version != _VERSION_)
+    {
+        std::cout << "ERROR::TEXTURE_CACHE::OPEN::LAYOUT_MISMATCH::" << _path << std::endl;
+        return nullptr;
+    }
+
+    // The source or the settings changed since it was baked, not an error.
+    //
+    if (header->source_hash != _source_hash || header->requested != (uint32_t)_requested || header->flags != _flags)
+    {
+        std::cout << "INFO::TEXTURE_CACHE::OPEN::STALE::" << _path << std::endl;
+        return nullptr;
+    }
+
+    uint64_t table_end = sizeof(TextureCache::Header) + (uint64_t)header->level_count * sizeof(TextureCache::Level);
+    if (header->level_count == 0 || table_end > file->GetSize())
+    {
+        std::cout << "ERROR::TEXTURE_CACHE::OPEN::TRUNCATED_TABLE::" << _path << std::endl;
+        return nullptr;
+    }
+
+    const TextureCache::Level* levels = (const TextureCache::Level*)(file->GetData() + sizeof(TextureCache::Header));
+    for (uint32_t i = 0; i < header->level_count; i++)
+    {
+        if (levels[i].offset % _ALIGNMENT_ != 0 || levels[i].offset > file->GetSize() ||
+            levels[i].size > file->GetSize() - levels[i].offset)
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::OPEN::BAD_LEVEL_" << i << "::" << _path << std::endl;
+            return nullptr;
+        }
+    }
+
+    return file;
+}
+
+bool TextureCache::Write(const std::string _path, const uint64_t _source_hash,
+    const TEXCOMPRESSenum _requested, const uint32_t _flags, const TEXCOMPRESSenum _format,
+    const std::vector<TextureCache::Level>& levels, const uint8_t* blocks)
+{
+    TextureCache::Header header = {};
+    std::copy(_MAGIC_, _MAGIC_ + 4, header.magic);
+    header.version = _VERSION_;
+    header.source_hash = _source_hash;
+    header.requested = (uint32_t)_requested;
+    header.format = (uint32_t)_format;
+    header.flags = _flags;
+    header.level_count = (uint32_t)levels.size();
+
+    std::vector<TextureCache::Level> entries(levels);
+    uint64_t offset = sizeof(TextureCache::Header) + levels.size() * sizeof(TextureCache::Level);
+    for (std::size_t i = 0; i < entries.size(); i++)
+    {
+        offset = (offset + _ALIGNMENT_ - 1) / _ALIGNMENT_ * _ALIGNMENT_;
+        entries.at(i).offset = offset;
+        offset += entries.at(i).size;
+    }
+
+    // Write next to the final file and rename, like the mesh cache. Two
+    // jobs baking the same image get different temporary files.
+    //
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(_path).parent_path(), error);
+    std::string temp_path = MappedFile::TempPath(_path);
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::WRITE::CANNOT_OPEN::" << temp_path << std::endl;
+            return false;
+        }
+
+        file.write((const char*)&header, sizeof(TextureCache::Header));
+        file.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(TextureCache::Level)));
+
+        const char padding[16] = { 0 };
+        uint64_t written = sizeof(TextureCache::Header) + entries.size() * sizeof(TextureCache::Level);
+        for (std::size_t i = 0; i < entries.size(); i++)
+        {
+            file.write(padding, (std::streamsize)(entries.at(i).offset - written));
+            file.write((const char*)(blocks + levels.at(i).offset), (std::streamsize)levels.at(i).size);
+            written = entries.at(i).offset + entries.at(i).size;
+        }
+
+        if (!file.good())
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::WRITE::FAILED::" << temp_path << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, _path, error);
+    if (error)
+    {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+}
+
+TEXCOMPRESSenum TextureCache::GetFormat(const MappedFile& file)
+{
+    return (TEXCOMPRESSenum)((const TextureCache::Header*)file.GetData())->format;
+}
+
+std::vector<TextureCache::Level> TextureCache::GetLevels(const MappedFile& file)
+{
+    const TextureCache::Header* header = (const TextureCache::Header*)file.GetData();
+    const TextureCache::Level* levels = (const TextureCache::Level*)(file.GetData() + sizeof(TextureCache::Header));
+    return std::vector<TextureCache::Level>(levels, levels + header->level_count);
+}
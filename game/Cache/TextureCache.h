@@ -0,0 +1,65 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+
+#include "Cache/MappedFile.h"
+#include "Types/ETexture.h"
+
+// Block compressed textures with their whole mip chain, so a warm start
+// neither decodes the source image nor compresses it. One file per source
+// image holds a fixed header with a content hash of the source file and the
+// compression that was asked for, a table with one entry per level (largest
+// first) and the 16 byte aligned block data of every level. A file whose
+// hash or settings don't match is ignored and baked again. Loading maps the
+// file, the levels can be handed to glCompressedTexSubImage2D as they are.
+//
+class TextureCache
+{
+public:
+    // Offsets are relative to whatever holds the blocks: the mapped file
+    // from GetLevels, the bake's own buffer when writing.
+    //
+    struct Level
+    {
+        uint64_t offset;
+        uint64_t size;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    static std::string CachePath(const std::string _directory, const std::string _source_path);
+    static uint64_t SourceHash(const uint8_t* data, const std::size_t _size);
+    static std::shared_ptr<MappedFile> Open(const std::string _path, const uint64_t _source_hash,
+        const TEXCOMPRESSenum _requested, const uint32_t _flags);
+    static bool Write(const std::string _path, const uint64_t _source_hash,
+        const TEXCOMPRESSenum _requested, const uint32_t _flags, const TEXCOMPRESSenum _format,
+        const std::vector<TextureCache::Level>& levels, const uint8_t* blocks);
+    static TEXCOMPRESSenum GetFormat(const MappedFile& file);
+    static std::vector<TextureCache::Level> GetLevels(const MappedFile& file);
+
+private:
+    // requested is what the loader asked for, format what was stored (BC1
+    // turns into BC3 for images with alpha).
+    //
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t source_hash;
+        uint32_t requested;
+        uint32_t format;
+        uint32_t flags;
+        uint32_t level_count;
+    };
+
+    static const char _MAGIC_[4];
+    static const uint32_t _VERSION_;
+    static const uint64_t _ALIGNMENT_;
+
+    TextureCache();
+};
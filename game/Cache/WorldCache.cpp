@@ -0,0 +1,161 @@
+#include "Cache/WorldCache.h"
+
+const char WorldCache::_MAGIC_[4] = { 'S', 'G', 'W', 'C' };
+const uint32_t WorldCache::_VERSION_ = 2;
+const uint64_t WorldCache::_ALIGNMENT_ = 16;
+
+std::string WorldCache::ChunkPath(const std::string _directory, const WorldCache::ChunkKey& key)
+{
+    // Everything but the chunk coordinates goes into the world part of the
+    // name, so all chunks of one world sit next to each other.
+    //
+    std::stringstream path;
+    path << _directory << std::hex << std::setfill('0') << 
+        std::setw(8) << key.seed << "_" << 
+        std::setw(8) << key.generator_hash << std::dec << "_" << 
+        key.grid_size << "_" << key.chunk_size << "_" << (int)key.mesh_type << "_" << 
+        (int)(key.height_scale * 100.0f) << "_" << 
+        key.chunk.x << "_" << key.chunk.y << ".wch";
+    return path.str();
+}
+
+std::shared_ptr<MappedFile> WorldCache::Open(const std::string _path, const WorldCache::ChunkKey& key)
+{
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->Open(_path))
+    {
+        return nullptr;
+    }
+
+    if (file->GetSize() < sizeof(WorldCache::Header))
+    {
+        std::cout << "ERROR::WORLD_CACHE::OPEN::TRUNCATED_HEADER::" << _path << std::endl;
+        return nullptr;
+    }
+
+    const WorldCache::Header* header = (const WorldCache::Header*)file->GetData();
+    if (!matches(*header, key))
+    {
+        std::cout << "ERROR::WORLD_CACHE::OPEN::KEY_MISMATCH::" << _path << std::endl;
+        return nullptr;
+    }
+
+    for (int i = 0; i < (int)WCSECTIONenum::COUNT; i++)
+    {
+        const WorldCache::SectionEntry& entry = header->sections[i];
+        if (entry.offset % _ALIGNMENT_ != 0 || entry.offset + entry.count * entry.element_size > file->GetSize())
+        {
+            std::cout << "ERROR::WORLD_CACHE::OPEN::BAD_SECTION_" << i << "::" << _path << std::endl;
+            return nullptr;
+        }
+    }
+
+    return file;
+}
+
+bool WorldCache::Write(const std::string _path, const WorldCache::ChunkKey& key,
+    const std::vector<WorldCache::Section>& sections)
+{
+    if (sections.size() != (std::size_t)WCSECTIONenum::COUNT)
+    {
+        return false;
+    }
+
+    WorldCache::Header header = makeHeader(key);
+    uint64_t offset = sizeof(WorldCache::Header);
+    for (std::size_t i = 0; i < sections.size(); i++)
+    {
+        offset = (offset + _ALIGNMENT_ - 1) / _ALIGNMENT_ * _ALIGNMENT_;
+        header.sections[i].offset = offset;
+        header.sections[i].count = sections.at(i).count;
+        header.sections[i].element_size = sections.at(i).element_size;
+        offset += sections.at(i).count * sections.at(i).element_size;
+    }
+
+    // Write next to the final file and rename, so a crash or a second writer
+    // never leaves a half written cache file under the real name. Every 
+    // write gets its own temporary file.
+    //
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(_path).parent_path(), error);
+    std::string temp_path = MappedFile::TempPath(_path);
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::WORLD_CACHE::WRITE::CANNOT_OPEN::" << temp_path << std::endl;
+            return false;
+        }
+
+        const char padding[16] = { 0 };
+        file.write((const char*)&header, sizeof(WorldCache::Header));
+        uint64_t written = sizeof(WorldCache::Header);
+        for (std::size_t i = 0; i < sections.size(); i++)
+        {
+            file.write(padding, (std::streamsize)(header.sections[i].offset - written));
+            uint64_t bytes = sections.at(i).count * sections.at(i).element_size;
+            if (bytes > 0)
+            {
+                file.write((const char*)sections.at(i).data, (std::streamsize)bytes);
+            }
+            written = header.sections[i].offset + bytes;
+        }
+
+        if (!file.good())
+        {
+            std::cout << "ERROR::WORLD_CACHE::WRITE::FAILED::" << temp_path << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, _path, error);
+    if (error)
+    {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+}
+
+WorldCache::Section WorldCache::GetSection(const MappedFile& file, const WCSECTIONenum _section)
+{
+    const WorldCache::Header* header = (const WorldCache::Header*)file.GetData();
+    const WorldCache::SectionEntry& entry = header->sections[(int)_section];
+
+    WorldCache::Section section;
+    section.data = file.GetData() + entry.offset;
+    section.count = entry.count;
+    section.element_size = entry.element_size;
+    return section;
+}
+
+WorldCache::Header WorldCache::makeHeader(const WorldCache::ChunkKey& key)
+{
+    WorldCache::Header header = {};
+    std::copy(_MAGIC_, _MAGIC_ + 4, header.magic);
+    header.version = _VERSION_;
+    header.seed = key.seed;
+    header.grid_size = key.grid_size;
+    header.chunk_size = key.chunk_size;
+    header.chunk_x = key.chunk.x;
+    header.chunk_y = key.chunk.y;
+    header.mesh_type = (uint32_t)key.mesh_type;
+    header.height_scale = key.height_scale;
+    header.generator_hash = key.generator_hash;
+    return header;
+}
+
+bool WorldCache::matches(const WorldCache::Header& header, const WorldCache::ChunkKey& key)
+{
+    WorldCache::Header expected = makeHeader(key);
+    return std::equal(header.magic, header.magic + 4, expected.magic) &&
+        header.version == expected.version &&
+        header.seed == expected.seed &&
+        header.grid_size == expected.grid_size &&
+        header.chunk_size == expected.chunk_size &&
+        header.chunk_x == expected.chunk_x &&
+        header.chunk_y == expected.chunk_y &&
+        header.mesh_type == expected.mesh_type &&
+        header.height_scale == expected.height_scale &&
+        header.generator_hash == expected.generator_hash;
+}
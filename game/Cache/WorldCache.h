@@ -0,0 +1,82 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+
+#include <glm/glm.hpp>
+
+#include "Cache/MappedFile.h"
+#include "Types/ETerrain.h"
+#include "Types/ECache.h"
+
+// Binary cache of generated terrain chunks. One file per chunk holds a fixed
+// header with the key it was generated for and a table of sections (height
+// grid, vertices, indices and the instance matrices of every vegetation type),
+// each section is raw, 16 byte aligned data. Loading maps the file and hands 
+// out pointers into the mapping, nothing is parsed per element.
+//
+class WorldCache
+{
+public:
+    struct ChunkKey
+    {
+        uint32_t seed;
+        uint32_t grid_size;
+        uint32_t chunk_size;
+        glm::ivec2 chunk;
+        TERRMESHenum mesh_type;
+        float height_scale;
+        uint32_t generator_hash;
+    };
+
+    struct Section
+    {
+        const void* data;
+        uint64_t count;
+        uint64_t element_size;
+    };
+
+    static std::string ChunkPath(const std::string _directory, const WorldCache::ChunkKey& key);
+    static std::shared_ptr<MappedFile> Open(const std::string _path, const WorldCache::ChunkKey& key);
+    static bool Write(const std::string _path, const WorldCache::ChunkKey& key, 
+        const std::vector<WorldCache::Section>& sections);
+    static WorldCache::Section GetSection(const MappedFile& file, const WCSECTIONenum _section);
+
+private:
+    struct SectionEntry
+    {
+        uint64_t offset;
+        uint64_t count;
+        uint64_t element_size;
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t seed;
+        uint32_t grid_size;
+        uint32_t chunk_size;
+        int32_t chunk_x;
+        int32_t chunk_y;
+        uint32_t mesh_type;
+        float height_scale;
+        uint32_t generator_hash;
+        WorldCache::SectionEntry sections[(int)WCSECTIONenum::COUNT];
+    };
+
+    static const char _MAGIC_[4];
+    static const uint32_t _VERSION_;
+    static const uint64_t _ALIGNMENT_;
+
+    WorldCache();
+
+    static WorldCache::Header makeHeader(const WorldCache::ChunkKey& key);
+    static bool matches(const WorldCache::Header& header, const WorldCache::ChunkKey& key);
+};
@@ -0,0 +1,130 @@
+#include "CameraPath.h"
+
+CameraPath::CameraPath()
+{
+}
+
+bool CameraPath::Load(const std::string _path)
+{
+    std::ifstream file(_path);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR::CAMERA_PATH::LOAD::CANNOT_OPEN::" << _path << std::endl;
+        return false;
+    }
+
+    keyframes_.clear();
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream values(line);
+        CameraPath::Keyframe keyframe;
+        if (values >> keyframe.time >> keyframe.position.x >> keyframe.position.y >> 
+            keyframe.position.z >> keyframe.yaw)
+        {
+            keyframes_.push_back(keyframe);
+        }
+    }
+
+    std::cout << "INFO::CAMERA_PATH::LOAD::" << keyframes_.size() << "_KEYFRAMES" << std::endl;
+    return !keyframes_.empty();
+}
+
+bool CameraPath::Save(const std::string _path)
+{
+    std::ofstream file(_path);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR::CAMERA_PATH::SAVE::CANNOT_OPEN::" << _path << std::endl;
+        return false;
+    }
+
+    for (std::size_t i = 0; i < keyframes_.size(); i++)
+    {
+        const CameraPath::Keyframe& keyframe = keyframes_.at(i);
+        file << keyframe.time << " " << keyframe.position.x << " " << keyframe.position.y << " " << 
+            keyframe.position.z << " " << keyframe.yaw << "\n";
+    }
+
+    std::cout << "INFO::CAMERA_PATH::SAVE::" << keyframes_.size() << "_KEYFRAMES" << std::endl;
+    return true;
+}
+
+void CameraPath::AddKeyframe(float time, glm::vec3 position, 
+    float yaw)
+{
+    CameraPath::Keyframe keyframe;
+    keyframe.time = time;
+    keyframe.position = position;
+    keyframe.yaw = yaw;
+    keyframes_.push_back(keyframe);
+}
+
+CameraPath::Keyframe CameraPath::Sample(float time)
+{
+    // Linear between the surrounding keyframes, clamped at both ends. Yaw 
+    // takes the short way around.
+    //
+    if (keyframes_.empty())
+    {
+        return CameraPath::Keyframe{ time, glm::vec3(0.0f), 0.0f };
+    }
+    if (time <= keyframes_.front().time)
+    {
+        return keyframes_.front();
+    }
+    if (time >= keyframes_.back().time)
+    {
+        return keyframes_.back();
+    }
+
+    std::size_t next = 1;
+    while (keyframes_.at(next).time < time)
+    {
+        next++;
+    }
+    const CameraPath::Keyframe& a = keyframes_.at(next - 1);
+    const CameraPath::Keyframe& b = keyframes_.at(next);
+
+    float span = b.time - a.time;
+    float t = (span > 0.0f) ? (time - a.time) / span : 0.0f;
+    float yaw_delta = std::remainder(b.yaw - a.yaw, 360.0f);
+
+    CameraPath::Keyframe result;
+    result.time = time;
+    result.position = glm::mix(a.position, b.position, t);
+    result.yaw = a.yaw + yaw_delta * t;
+    return result;
+}
+
+float CameraPath::GetDuration()
+{
+    return keyframes_.empty() ? 0.0f : keyframes_.back().time;
+}
+
+bool CameraPath::IsEmpty()
+{
+    return keyframes_.empty();
+}
+
+CameraPath CameraPath::Figure8(float half_extent, float duration)
+{
+    // Built in path for when no recording is given, a figure eight over the
+    // world with the camera behind the player. The camera sits at 
+    // (sin(yaw), cos(yaw)) from the player, so it looks along 
+    // -(sin(yaw), cos(yaw)).
+    //
+    CameraPath path;
+    const int keyframes = 240;
+    const float two_pi = 6.28318530718f;
+    for (int i = 0; i <= keyframes; i++)
+    {
+        float time = duration * (float)i / (float)keyframes;
+        float angle = two_pi * (float)i / (float)keyframes;
+        glm::vec3 position(half_extent * std::sin(angle), 0.0f, half_extent * std::sin(2.0f * angle) * 0.5f);
+        glm::vec2 direction(std::cos(angle), std::cos(2.0f * angle));
+        float yaw = glm::degrees(std::atan2(-direction.x, -direction.y));
+        path.AddKeyframe(time, position, yaw);
+    }
+    return path;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+// A recorded player path, keyframes of time, position and camera yaw. The 
+// headless benchmark replays it with a fixed time step so every run sees
+// exactly the same frames. Paths are plain text, one "time x y z yaw" 
+// keyframe per line.
+//
+class CameraPath
+{
+public:
+    struct Keyframe
+    {
+        float time;
+        glm::vec3 position;
+        float yaw;
+    };
+
+    CameraPath();
+
+    bool Load(const std::string _path);
+    bool Save(const std::string _path);
+    void AddKeyframe(float time, glm::vec3 position, 
+        float yaw);
+    CameraPath::Keyframe Sample(float time);
+
+    float GetDuration();
+    bool IsEmpty();
+
+    static CameraPath Figure8(float half_extent, float duration);
+
+private:
+    std::vector<CameraPath::Keyframe> keyframes_;
+};
@@ -1,9 +1,23 @@
 #include "Entity.h"
 
-Entity::Entity(TerrainElement& terr_el, glm::mat4& world_transform, bool is_collectible) :
+Entity::Entity(TerrainElement& terr_el, const glm::mat4& world_transform, bool is_collectible,
+    uint32_t element_type) :
+    is_collectible_(is_collectible),
+    element_type_(element_type),
     terrain_element_(terr_el),
     world_transform_(world_transform),
-    is_collectible_(is_collectible)
+    instance_(Instance::Pack(glm::vec3(world_transform[3])))
+{
+    setupBoundingBox();
+}
+
+Entity::Entity(TerrainElement& terr_el, const Instance& instance, bool is_collectible,
+    uint32_t element_type) :
+    is_collectible_(is_collectible),
+    element_type_(element_type),
+    terrain_element_(terr_el),
+    world_transform_(instance.GetMatrix()),
+    instance_(instance)
 {
     setupBoundingBox();
 }
@@ -18,6 +32,14 @@ AABB Entity::GetBoundingBox()
     return bounding_box_;
 }
 
+std::size_t Entity::GetMemoryFootprint()
+{
+    // The model is shared by every entity of its type and counted once by
+    // the asset manager.
+    //
+    return sizeof(Entity);
+}
+
 bool Entity::Collides(Entity oth_ent)
 {
     return bounding_box_.Collides(oth_ent.bounding_box_);
@@ -33,11 +55,27 @@ bool Entity::IsCollectible()
     return is_collectible_;
 }
 
+float Entity::GetCullRadius()
+{
+    // The bounding box half extents are in model space, scale them by the 
+    // largest scale of the world transform so the radius stays conservative.
+    //
+    float scale = std::max(glm::length(glm::vec3(world_transform_[0])), 
+        std::max(glm::length(glm::vec3(world_transform_[1])), glm::length(glm::vec3(world_transform_[2]))));
+    return glm::length(glm::vec3(bounding_box_.x_half_dim, bounding_box_.y_half_dim, 
+        bounding_box_.z_half_dim)) * scale;
+}
+
 glm::mat4& Entity::GetModelMatrix()
 {
     return world_transform_;
 }
 
+const Instance& Entity::GetInstance()
+{
+    return instance_;
+}
+
 glm::vec3 Entity::GetCenter()
 {
     return bounding_box_.GetCenter();
@@ -80,11 +118,24 @@ float Entity::GetZMinAABB()
 
 void Entity::setupBoundingBox()
 {
-    AABB ent_bounding_box = terrain_element_.GetModelBoundingBox();
-    
-    glm::vec4 ent_aabb_center_v4 = glm::vec4(ent_bounding_box.center_position, 1.0f);
-    glm::vec3 ent_aabb_center_v3 = glm::vec3(world_transform_ * ent_aabb_center_v4);
-    ent_bounding_box.center_position = ent_aabb_center_v3;
-
-    bounding_box_ = ent_bounding_box;
+    // Instances can be rotated and scaled, so the box is the world space box
+    // around the 8 transformed corners of the model box, not just the moved
+    // model box.
+    //
+    AABB model_box = terrain_element_.GetModelBoundingBox();
+    glm::vec3 box_min(std::numeric_limits<float>::max());
+    glm::vec3 box_max(std::numeric_limits<float>::lowest());
+    for (int i = 0; i < 8; i++)
+    {
+        glm::vec3 corner(
+            (i & 1) ? model_box.XMax() : model_box.XMin(),
+            (i & 2) ? model_box.YMax() : model_box.YMin(),
+            (i & 4) ? model_box.ZMax() : model_box.ZMin());
+        corner = glm::vec3(world_transform_ * glm::vec4(corner, 1.0f));
+        box_min = glm::min(box_min, corner);
+        box_max = glm::max(box_max, corner);
+    }
+
+    glm::vec3 half = (box_max - box_min) / 2.0f;
+    bounding_box_ = AABB(box_min + half, half.x, half.y, half.z);
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -10,23 +12,33 @@
 
 #include "Types/AABB.h"
 #include "World/TerrainElement.h"
+#include "World/CollectibleRegistry.h"
+#include "Types/Instance.h"
 
 class Entity
 {
 public:
     AABB bounding_box_;
     bool is_collectible_;
+    CollectibleHandle collectible_handle_;
+    uint32_t element_type_;
 
-    Entity(TerrainElement& terr_el, glm::mat4& world_transform, bool is_collectible = false);
+    Entity(TerrainElement& terr_el, const glm::mat4& world_transform, bool is_collectible = false,
+        uint32_t element_type = 0);
+    Entity(TerrainElement& terr_el, const Instance& instance, bool is_collectible = false,
+        uint32_t element_type = 0);
 
     void Draw(glm::vec3 position, float yaw);
 
     AABB GetBoundingBox();
+    std::size_t GetMemoryFootprint();
     bool Collides(Entity oth_ent);
     bool Contains(glm::vec3 oth_pos);
 
     bool IsCollectible();
+    float GetCullRadius();
     glm::mat4& GetModelMatrix();
+    const Instance& GetInstance();
     glm::vec3 GetCenter();
     void SetCenter(glm::vec3 bbx_center);
     float GetXMaxAABB();
@@ -40,5 +52,10 @@ private:
     TerrainElement terrain_element_;
     glm::mat4 world_transform_;
 
+    // What the entity uploads when it is drawn instanced. Entities made from
+    // a model matrix only have the translation in here.
+    //
+    Instance instance_;
+
     void setupBoundingBox();
 };
@@ -3,25 +3,66 @@
 const glm::vec3 Game::_DEFAULT_CAMERA_POSITION_ = glm::vec3(0.0f, 0.0f, 0.0f);
 const glm::vec3 Game::_DEFAULT_PLAYER_POSITION_ = glm::vec3(0.0f, 0.0f, 0.0f);
 const glm::vec3 Game::_WORLD_CENTER_ = glm::vec3(0.0f, 0.0f, 0.0f);
+const uint32_t Game::_WORLD_SEED_ = 0;
+const float Game::_BENCHMARK_PATH_EXTENT_ = 100.0f;
+const float Game::_BENCHMARK_PATH_DURATION_ = 40.0f;
+const double Game::_LOADING_FRAME_BUDGET_ = 8.0;
+const std::string Game::_PLAYER_MODEL_PATH_ = "Resources/Models/player/player.obj";
 
-Game::Game(Window& window) :
+Game::Game(Window& window, uint32_t world_seed, uint32_t worker_count) :
     renderer_(window),
     camera_(Camera(_DEFAULT_CAMERA_POSITION_)),
-    game_world_(GameWorld()),
-    player_(Player(_DEFAULT_PLAYER_POSITION_))
+    job_system_(worker_count),
+    asset_manager_(job_system_)
 {
+    load(world_seed);
+
     glm::vec3 player_start_pos = _DEFAULT_PLAYER_POSITION_;
-    player_start_pos.y = game_world_.GetGridHeight(player_start_pos);
-    player_.position_ = player_start_pos;
+    player_start_pos.y = game_world_->GetGridHeight(player_start_pos);
+    player_->position_ = player_start_pos;
     camera_.SetPlayerPosition(player_start_pos);
     camera_.FollowPlayer();
-    player_.SetTimeLimit(300.0);
-    player_.SetScore(0);
+    player_->SetTimeLimit(300.0);
+    player_->SetScore(0);
+
+    asset_manager_.PrintStats();
+}
+
+void Game::Start(const std::string _record_path)
+{
+    if (_record_path.empty())
+    {
+        renderer_.Render(camera_, *player_, *game_world_);
+        return;
+    }
+
+    CameraPath recording;
+    renderer_.Render(camera_, *player_, *game_world_, &recording);
+    recording.Save(_record_path);
+}
+
+void Game::RunBenchmark(const std::string _path_file, uint32_t frame_count, 
+    const std::string _output_prefix)
+{
+    // Without a recorded path the built in one is used, it stays inside the
+    // 128 grid world.
+    //
+    CameraPath path;
+    if (_path_file.empty() || !path.Load(_path_file))
+    {
+        path = CameraPath::Figure8(_BENCHMARK_PATH_EXTENT_, _BENCHMARK_PATH_DURATION_);
+    }
+    renderer_.RenderBenchmark(camera_, *player_, *game_world_, path, frame_count, _output_prefix);
 }
 
-void Game::Start()
+void Game::SetLodMode(int lod_mode)
 {
-    renderer_.Render(camera_, player_, game_world_);
+    game_world_->SetLodMode(lod_mode);
+}
+
+void Game::SetImpostorDistance(float distance)
+{
+    game_world_->SetImpostorDistance(distance);
 }
 
 void Game::HandleFramebuffer(GLFWwindow* window, int width,
@@ -33,5 +74,49 @@ void Game::HandleFramebuffer(GLFWwindow* window, int width,
 void Game::HandleMouse(GLFWwindow* window, double x_pos,
     double y_pos)
 {
-    renderer_.ProcessMouse(camera_, player_, window, x_pos, y_pos);
+    renderer_.ProcessMouse(camera_, *player_, window, x_pos, y_pos);
+}
+
+void Game::load(uint32_t world_seed)
+{
+    // Parsing, image decoding and LOD generation run on the workers, shader
+    // compiles and GL uploads on this thread, a slice between two loading
+    // screen frames. Decoded textures are streamed in between the same
+    // frames. The world is created once its assets are in, its spawn chunks
+    // are generated by jobs and uploaded as they finish.
+    //
+    GameWorld::Assets world_assets;
+    ModelHandle player_model;
+    ShaderHandle player_shader;
+    StartupGraph graph(job_system_);
+
+    std::vector<StartupGraph::TaskId> world_dependencies = GameWorld::Preload(graph, asset_manager_, world_assets);
+    StartupGraph::TaskId world = graph.AddMainTask("create world", [this, &world_assets, world_seed]() {
+        game_world_.reset(new GameWorld(job_system_, asset_manager_, world_assets, 
+            glm::vec3(0.0f, -1.0f, 0.0f), 128, world_seed));
+    }, world_dependencies);
+    graph.AddPolledTask("spawn chunks", [this]() { return game_world_->LoadStep(); }, { world });
+
+    StartupGraph::TaskId player_import = graph.AddWorkerTask("import player.obj", [this, &player_model]() {
+        player_model = asset_manager_.ImportModel(_PLAYER_MODEL_PATH_, true);
+    });
+    StartupGraph::TaskId player_upload = graph.AddMainTask("upload player.obj", [&player_model]() {
+        player_model->Upload();
+    }, { player_import });
+    StartupGraph::TaskId player_compile = graph.AddMainTask("compile lowPolyPlayer.vert", [this, &player_shader]() {
+        player_shader = asset_manager_.LoadShader("Resources/Shaders/Model/lowPolyPlayer.vert", 
+            "Resources/Shaders/Model/lowPolyPlayer.frag");
+    });
+    graph.AddMainTask("create player", [this, &player_model, &player_shader]() {
+        player_.reset(new Player(TerrainElement(player_model, player_shader), _DEFAULT_PLAYER_POSITION_));
+    }, { player_upload, player_compile });
+
+    graph.Start();
+    while (!graph.Pump(_LOADING_FRAME_BUDGET_))
+    {
+        asset_manager_.Update();
+        renderer_.RenderLoadingScreen(graph.GetProgress());
+    }
+    graph.PrintTimeline();
+    Shader::PrintCacheStats();
 }
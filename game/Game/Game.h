@@ -12,13 +12,25 @@
 #include "Renderer/Camera.h"
 #include "World/GameWorld.h"
 #include "Game/Player.h"
+#include "Game/CameraPath.h"
+#include "Jobs/JobSystem.h"
+#include "Jobs/StartupGraph.h"
+#include "Assets/AssetManager.h"
 
 class Game
 {
 public:
-    Game(Window& window);
+    // A worker count of 0 uses one worker per hardware thread but one.
+    // Everything is loaded here, behind a loading screen.
+    //
+    Game(Window& window, uint32_t world_seed = _WORLD_SEED_, uint32_t worker_count = 0);
 
-    void Start();
+    void Start(const std::string _record_path = "");
+    void RunBenchmark(const std::string _path_file, uint32_t frame_count, 
+        const std::string _output_prefix);
+
+    void SetLodMode(int lod_mode);
+    void SetImpostorDistance(float distance);
 
     void HandleFramebuffer(GLFWwindow* window, int width,
         int height);
@@ -28,10 +40,25 @@ public:
 private:
     Renderer renderer_;
     Camera camera_;
-    GameWorld game_world_;
-    Player player_;
+
+    // Declared before the world so it outlives every job the world runs.
+    //
+    JobSystem job_system_;
+
+    // Declared before everything that holds asset handles.
+    //
+    AssetManager asset_manager_;
+    std::unique_ptr<GameWorld> game_world_;
+    std::unique_ptr<Player> player_;
 
     static const glm::vec3 _DEFAULT_CAMERA_POSITION_;
     static const glm::vec3 _DEFAULT_PLAYER_POSITION_;
     static const glm::vec3 _WORLD_CENTER_;
+    static const uint32_t _WORLD_SEED_;
+    static const float _BENCHMARK_PATH_EXTENT_;
+    static const float _BENCHMARK_PATH_DURATION_;
+    static const double _LOADING_FRAME_BUDGET_;
+    static const std::string _PLAYER_MODEL_PATH_;
+
+    void load(uint32_t world_seed);
 };
@@ -8,7 +8,7 @@ const float Player::_SENSITIVITY_ = 0.08f;
 const double Player::_TIME_LIMIT_ = 300.0;
 
 
-Player::Player(glm::vec3 starting_position, TerrainElement terrel, glm::mat4 world_transform) :
+Player::Player(TerrainElement terrel, glm::vec3 starting_position, glm::mat4 world_transform) :
 	Entity(terrel, world_transform),
 	position_(starting_position),
 	world_up_(glm::vec3(0.0f, 1.0f, 0.0f)),
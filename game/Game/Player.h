@@ -27,10 +27,8 @@ public:
     float yaw_;
     float pitch_;
     
-    Player(glm::vec3 starting_position = glm::vec3(0.0f, 0.0f, 0.0f),
-        TerrainElement terrel = TerrainElement(
-                Model("Resources/Models/player/player.obj", true),
-                Shader("Resources/Shaders/Model/lowPolyPlayer.vert", "Resources/Shaders/Model/lowPolyPlayer.frag")),
+    Player(TerrainElement terrel, 
+        glm::vec3 starting_position = glm::vec3(0.0f, 0.0f, 0.0f),
         glm::mat4 world_transform = glm::mat4(1.0f));
 
     glm::vec3 GetPosition();
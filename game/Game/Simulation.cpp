@@ -0,0 +1,159 @@
+#include "Game/Simulation.h"
+
+const double Simulation::_TICK_RATE_ = 120.0;
+const uint32_t Simulation::_MAX_TICKS_PER_UPDATE_ = 8;
+
+Simulation::Simulation(GameWorld& world, glm::vec3 start_position, double tick_rate) :
+    world_(world),
+    _time_step_(1.0 / tick_rate),
+    running_(false)
+{
+    state_.position = start_position;
+    state_.time = 0.0;
+    state_.tick = 0;
+
+    // Both sides start out with something valid to read.
+    //
+    Simulation::Input& input = input_.GetWriteBuffer();
+    input.front = glm::vec3(0.0f, 0.0f, -1.0f);
+    input.right = glm::vec3(1.0f, 0.0f, 0.0f);
+    input.speed = 0.0f;
+    input.move_forward = input.move_back = input.move_left = input.move_right = false;
+    input_.Publish();
+    publish(state_, Now());
+}
+
+Simulation::~Simulation()
+{
+    Stop();
+}
+
+void Simulation::Start()
+{
+    if (running_.load())
+    {
+        return;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&Simulation::run, this);
+    std::cout << "INFO::SIMULATION::START::" << (int)(1.0 / _time_step_) << "_HZ" << std::endl;
+}
+
+void Simulation::Stop()
+{
+    running_ = false;
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+void Simulation::SetInput(const Simulation::Input& input)
+{
+    input_.GetWriteBuffer() = input;
+    input_.Publish();
+}
+
+const Simulation::Snapshot& Simulation::GetSnapshot()
+{
+    snapshots_.Update();
+    return snapshots_.GetReadBuffer();
+}
+
+Simulation::State Simulation::Interpolate(const Simulation::Snapshot& snapshot, double now) const
+{
+    // The snapshot's ticks are drawn one step late, at now - time step. A
+    // simulation that falls behind holds the last tick instead of
+    // extrapolating.
+    //
+    float alpha = (float)std::min(std::max((now - snapshot.tick_time) / _time_step_, 0.0), 1.0);
+
+    Simulation::State state = snapshot.current;
+    state.position = glm::mix(snapshot.previous.position, snapshot.current.position, alpha);
+    state.time = snapshot.previous.time + (snapshot.current.time - snapshot.previous.time) * alpha;
+    return state;
+}
+
+double Simulation::GetTimeStep() const
+{
+    return _time_step_;
+}
+
+double Simulation::Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Simulation::run()
+{
+    Profiler::SetThreadName("simulation");
+
+    double next_tick = Now();
+    while (running_.load())
+    {
+        // Catch up on every tick that is due. After a long stall (window
+        // dragged, debugger) the backlog is dropped instead of running
+        // the game in fast forward.
+        //
+        input_.Update();
+        Simulation::State previous = state_;
+        double tick_time = next_tick;
+        uint32_t ticks = 0;
+        while (Now() >= next_tick && ticks < _MAX_TICKS_PER_UPDATE_)
+        {
+            previous = state_;
+            step(input_.GetReadBuffer());
+            tick_time = next_tick;
+            next_tick += _time_step_;
+            ticks++;
+        }
+        if (ticks == _MAX_TICKS_PER_UPDATE_ && Now() >= next_tick)
+        {
+            next_tick = Now() + _time_step_;
+        }
+
+        if (ticks > 0)
+        {
+            publish(previous, tick_time);
+        }
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(std::max(next_tick - Now(), 0.0)));
+    }
+}
+
+void Simulation::step(const Simulation::Input& input)
+{
+    PROFILE_SCOPE("Simulation::Step");
+
+    float velocity = input.speed * (float)_time_step_;
+    if (input.move_forward)
+    {
+        state_.position += input.front * velocity;
+    }
+    if (input.move_back)
+    {
+        state_.position -= input.front * velocity;
+    }
+    if (input.move_left)
+    {
+        state_.position -= input.right * velocity;
+    }
+    if (input.move_right)
+    {
+        state_.position += input.right * velocity;
+    }
+    state_.position.y = world_.GetGridHeight(state_.position);
+
+    state_.time += _time_step_;
+    state_.tick++;
+}
+
+void Simulation::publish(const Simulation::State& previous, double tick_time)
+{
+    Simulation::Snapshot& snapshot = snapshots_.GetWriteBuffer();
+    snapshot.previous = previous;
+    snapshot.current = state_;
+    snapshot.tick_time = tick_time;
+    snapshots_.Publish();
+}
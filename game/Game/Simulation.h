@@ -0,0 +1,87 @@
+#pragma once
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include "Buffers/TripleBuffer.h"
+#include "World/GameWorld.h"
+#include "Profiler/Profiler.h"
+
+// Player movement at a fixed time step on its own thread. The main thread
+// publishes the input it polled every frame, the simulation thread steps
+// as many ticks as are due and publishes a snapshot with the state of the
+// last two ticks. Both go through triple buffers, neither thread waits for
+// the other, so a slow frame doesn't slow the game down and a slow tick
+// doesn't hold up the frame.
+//
+// The renderer shows the state one tick in the past, interpolated between
+// the two ticks of the snapshot. The only world access from the simulation
+// thread is GameWorld::GetGridHeight.
+//
+class Simulation
+{
+public:
+    struct Input
+    {
+        glm::vec3 front;
+        glm::vec3 right;
+        float speed;
+        bool move_forward;
+        bool move_back;
+        bool move_left;
+        bool move_right;
+    };
+
+    struct State
+    {
+        glm::vec3 position;
+        double time;
+        uint64_t tick;
+    };
+
+    // The last two ticks and the time (Simulation::Now) the last one was
+    // due at.
+    //
+    struct Snapshot
+    {
+        Simulation::State previous;
+        Simulation::State current;
+        double tick_time;
+    };
+
+    Simulation(GameWorld& world, glm::vec3 start_position, double tick_rate = _TICK_RATE_);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    void Start();
+    void Stop();
+    void SetInput(const Simulation::Input& input);
+    const Simulation::Snapshot& GetSnapshot();
+    Simulation::State Interpolate(const Simulation::Snapshot& snapshot, double now) const;
+    double GetTimeStep() const;
+
+    static double Now();
+
+private:
+    GameWorld& world_;
+    const double _time_step_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    TripleBuffer<Simulation::Input> input_;
+    TripleBuffer<Simulation::Snapshot> snapshots_;
+    Simulation::State state_;
+
+    static const double _TICK_RATE_;
+    static const uint32_t _MAX_TICKS_PER_UPDATE_;
+
+    void run();
+    void step(const Simulation::Input& input);
+    void publish(const Simulation::State& previous, double tick_time);
+};
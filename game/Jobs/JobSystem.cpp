@@ -0,0 +1,288 @@
+#include "JobSystem.h"
+
+thread_local JobSystem* JobSystem::current_system_ = nullptr;
+thread_local uint32_t JobSystem::current_worker_ = 0;
+
+JobCounter::JobCounter() :
+    pending_(0)
+{
+}
+
+bool JobCounter::IsDone()
+{
+    return pending_.load() == 0;
+}
+
+uint32_t JobCounter::GetPending()
+{
+    return pending_.load();
+}
+
+JobSystem::JobSystem(uint32_t worker_count) :
+    queued_(0),
+    stop_(false)
+{
+    // Leave one hardware thread for the main (render) thread, it helps out
+    // whenever it waits for a counter anyway.
+    //
+    if (worker_count == 0)
+    {
+        uint32_t hardware_threads = std::thread::hardware_concurrency();
+        worker_count = (hardware_threads > 1) ? hardware_threads - 1 : 1;
+    }
+
+    // One queue per worker plus the shared one for outside threads, which 
+    // is the last.
+    //
+    for (uint32_t i = 0; i <= worker_count; i++)
+    {
+        queues_.push_back(std::unique_ptr<JobSystem::WorkerQueue>(new JobSystem::WorkerQueue()));
+    }
+    for (uint32_t i = 0; i < worker_count; i++)
+    {
+        workers_.push_back(std::thread(&JobSystem::workerLoop, this, i));
+    }
+    std::cout << "INFO::JOB_SYSTEM::JOB_SYSTEM::STARTED_" << worker_count << "_WORKERS" << std::endl;
+}
+
+JobSystem::~JobSystem()
+{
+    // Workers drain their queues before they exit, nothing that was Run is
+    // dropped.
+    //
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    sleep_condition_.notify_all();
+
+    for (std::size_t i = 0; i < workers_.size(); i++)
+    {
+        workers_.at(i).join();
+    }
+}
+
+void JobSystem::Run(JobFunction job, JobCounter* counter, 
+    JobCounter* dependency)
+{
+    JobEntry entry;
+    entry.function = std::move(job);
+    entry.counter = counter;
+    if (counter != nullptr)
+    {
+        counter->pending_++;
+    }
+
+    if (dependency != nullptr)
+    {
+        // Parked on the dependency until it reaches zero, finishJob queues
+        // it then. The check is under the dependency's lock, so it either
+        // sees zero or finishJob sees the parked job.
+        //
+        std::lock_guard<std::mutex> lock(dependency->mutex_);
+        if (dependency->pending_.load() != 0)
+        {
+            dependency->continuations_.push_back(std::move(entry));
+            return;
+        }
+    }
+
+    push(std::move(entry));
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    while (!counter.IsDone())
+    {
+        if (!runOne())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(counter.mutex_);
+}
+
+void JobSystem::WaitOwn(JobCounter& counter)
+{
+    // Jobs of the counter that are still queued are run here, the ones 
+    // other threads already took are waited out. Anything else in the 
+    // queues is left to the workers.
+    //
+    while (!counter.IsDone())
+    {
+        if (!runOne(&counter))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(counter.mutex_);
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grain, 
+    const std::function<void(uint32_t, uint32_t)>& body)
+{
+    // body(begin, end) is called for consecutive ranges of at most grain
+    // items. The calling thread works on the ranges too until all are done,
+    // but on nothing else, a ParallelFor inside a frame critical job doesn't
+    // get stuck behind a background job.
+    //
+    grain = std::max(grain, 1u);
+    if (count <= grain)
+    {
+        if (count > 0)
+        {
+            body(0, count);
+        }
+        return;
+    }
+
+    JobCounter counter;
+    for (uint32_t begin = 0; begin < count; begin += grain)
+    {
+        uint32_t end = std::min(begin + grain, count);
+        Run([&body, begin, end]() { body(begin, end); }, &counter);
+    }
+    WaitOwn(counter);
+}
+
+uint32_t JobSystem::GetWorkerCount()
+{
+    return (uint32_t)workers_.size();
+}
+
+void JobSystem::workerLoop(uint32_t index)
+{
+    current_system_ = this;
+    current_worker_ = index;
+    Profiler::SetThreadName("worker " + std::to_string(index));
+
+    while (true)
+    {
+        if (runOne())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_condition_.wait(lock, [this] { return stop_.load() || queued_.load() > 0; });
+        if (stop_.load() && queued_.load() == 0)
+        {
+            return;
+        }
+    }
+}
+
+void JobSystem::push(JobEntry entry)
+{
+    JobSystem::WorkerQueue& queue = *queues_.at(queueIndex());
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(entry));
+    }
+    queued_++;
+
+    // Taking the sleep lock orders this with a worker that is between its
+    // predicate check and going to sleep, otherwise the wakeup can be lost.
+    //
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_condition_.notify_one();
+}
+
+bool JobSystem::runOne(JobCounter* counter)
+{
+    // Own queue first, then steal, starting right after our own queue so 
+    // thieves spread over the victims.
+    //
+    uint32_t own = queueIndex();
+    uint32_t queue_count = (uint32_t)queues_.size();
+    JobEntry entry;
+    bool found = popJob(own, counter, entry);
+    for (uint32_t i = 1; i < queue_count && !found; i++)
+    {
+        found = popJob((own + i) % queue_count, counter, entry);
+    }
+    if (!found)
+    {
+        return false;
+    }
+
+    entry.function();
+    finishJob(entry.counter);
+    return true;
+}
+
+bool JobSystem::popJob(uint32_t index, JobCounter* counter, JobEntry& entry)
+{
+    JobSystem::WorkerQueue& queue = *queues_.at(index);
+    if (queued_.load() == 0)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    // Without a counter the first job from the back (own queue) or the 
+    // front (stolen) is taken, with one the first job of that counter.
+    //
+    bool own = index == queueIndex();
+    std::size_t count = queue.jobs.size();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        std::size_t position = own ? count - 1 - i : i;
+        if (counter == nullptr || queue.jobs.at(position).counter == counter)
+        {
+            entry = std::move(queue.jobs.at(position));
+            queue.jobs.erase(queue.jobs.begin() + position);
+            queued_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::finishJob(JobCounter* counter)
+{
+    if (counter == nullptr)
+    {
+        return;
+    }
+
+    // Only the last job of a counter takes its lock. Dropping to zero 
+    // happens under the lock and Wait takes the lock before it returns, so
+    // a waiter can't destroy the counter while it is still being touched here.
+    //
+    uint32_t pending = counter->pending_.load();
+    while (pending > 1)
+    {
+        if (counter->pending_.compare_exchange_weak(pending, pending - 1))
+        {
+            return;
+        }
+    }
+
+    std::vector<JobEntry> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex_);
+        if (--counter->pending_ != 0)
+        {
+            return;
+        }
+        continuations.swap(counter->continuations_);
+    }
+    for (std::size_t i = 0; i < continuations.size(); i++)
+    {
+        push(std::move(continuations.at(i)));
+    }
+}
+
+uint32_t JobSystem::queueIndex()
+{
+    if (current_system_ == this)
+    {
+        return current_worker_;
+    }
+    return (uint32_t)queues_.size() - 1;
+}
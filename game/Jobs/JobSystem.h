@@ -0,0 +1,101 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+
+#include "Profiler/Profiler.h"
+
+typedef std::function<void()> JobFunction;
+
+class JobCounter;
+
+struct JobEntry
+{
+    JobFunction function;
+    JobCounter* counter;
+};
+
+// Counts the unfinished jobs of a group. Every job Run with a counter bumps
+// it and drops it when done. Jobs can wait on a counter (they are queued 
+// once it reaches zero), threads can JobSystem::Wait on it. A counter must 
+// outlive the jobs that refer to it.
+//
+class JobCounter
+{
+public:
+    JobCounter();
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone();
+    uint32_t GetPending();
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> pending_;
+    std::mutex mutex_;
+    std::vector<JobEntry> continuations_;
+};
+
+// Work stealing thread pool. Every worker owns a deque, it pushes and pops
+// its own jobs at the back (most recent first, their data is still in 
+// cache) and steals from the front of the others' when it runs dry. Jobs 
+// pushed from a thread that isn't a worker go to one shared queue that 
+// everybody steals from. Waiting never blocks a worker, it runs other jobs
+// until the counter reaches zero, so jobs can spawn and wait for jobs.
+// WaitOwn only runs the jobs of the awaited counter, for waiters that can't
+// afford to pick up a chunk build or a texture bake in the meantime.
+//
+class JobSystem
+{
+public:
+    JobSystem(uint32_t worker_count = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void Run(JobFunction job, JobCounter* counter = nullptr, 
+        JobCounter* dependency = nullptr);
+    void Wait(JobCounter& counter);
+    void WaitOwn(JobCounter& counter);
+    void ParallelFor(uint32_t count, uint32_t grain, 
+        const std::function<void(uint32_t, uint32_t)>& body);
+
+    uint32_t GetWorkerCount();
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<JobEntry> jobs;
+    };
+
+    std::vector<std::unique_ptr<JobSystem::WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<uint32_t> queued_;
+    std::atomic<bool> stop_;
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_condition_;
+
+    static thread_local JobSystem* current_system_;
+    static thread_local uint32_t current_worker_;
+
+    void workerLoop(uint32_t index);
+    void push(JobEntry entry);
+    bool runOne(JobCounter* counter = nullptr);
+    bool popJob(uint32_t index, JobCounter* counter, JobEntry& entry);
+    void finishJob(JobCounter* counter);
+    uint32_t queueIndex();
+};
@@ -0,0 +1,231 @@
+#include "Jobs/StartupGraph.h"
+
+StartupGraph::StartupGraph(JobSystem& job_system) :
+    job_system_(job_system),
+    start_(std::chrono::steady_clock::now()),
+    done_count_(0)
+{
+}
+
+StartupGraph::~StartupGraph()
+{
+    // Worker tasks refer to the graph, a graph dropped before it is done
+    // still lets the running ones finish.
+    //
+    job_system_.Wait(worker_jobs_);
+}
+
+StartupGraph::TaskId StartupGraph::AddWorkerTask(const std::string _name, std::function<void()> task,
+    const std::vector<StartupGraph::TaskId>& dependencies)
+{
+    StartupGraph::TaskId id = addTask(_name, StartupGraph::Kind::WORKER, dependencies);
+    tasks_.at(id)->function = std::move(task);
+    return id;
+}
+
+StartupGraph::TaskId StartupGraph::AddMainTask(const std::string _name, std::function<void()> task,
+    const std::vector<StartupGraph::TaskId>& dependencies)
+{
+    StartupGraph::TaskId id = addTask(_name, StartupGraph::Kind::MAIN, dependencies);
+    tasks_.at(id)->function = std::move(task);
+    return id;
+}
+
+StartupGraph::TaskId StartupGraph::AddPolledTask(const std::string _name, std::function<bool()> task,
+    const std::vector<StartupGraph::TaskId>& dependencies)
+{
+    StartupGraph::TaskId id = addTask(_name, StartupGraph::Kind::POLLED, dependencies);
+    tasks_.at(id)->poll = std::move(task);
+    return id;
+}
+
+void StartupGraph::Start()
+{
+    // Collected first, a worker task that finishes right away can make a
+    // later task ready while this loop is still running.
+    //
+    start_ = std::chrono::steady_clock::now();
+    std::vector<StartupGraph::TaskId> roots;
+    for (StartupGraph::TaskId id = 0; id < (StartupGraph::TaskId)tasks_.size(); id++)
+    {
+        if (tasks_.at(id)->remaining.load() == 0)
+        {
+            roots.push_back(id);
+        }
+    }
+    for (std::size_t i = 0; i < roots.size(); i++)
+    {
+        schedule(roots.at(i));
+    }
+}
+
+bool StartupGraph::Pump(double budget_ms)
+{
+    // Runs ready main tasks until the budget is used up, at least one per
+    // call. A polled task that isn't done yet goes to the back of the queue
+    // and is called again on the next Pump.
+    //
+    double pump_start = now();
+    std::vector<StartupGraph::TaskId> polled;
+    while (true)
+    {
+        StartupGraph::TaskId id;
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            if (ready_.empty())
+            {
+                break;
+            }
+            id = ready_.front();
+            ready_.pop_front();
+        }
+
+        StartupGraph::Task& task = *tasks_.at(id);
+        if (!task.started)
+        {
+            task.started = true;
+            task.start_ms = now();
+        }
+
+        if (task.kind == StartupGraph::Kind::POLLED)
+        {
+            if (task.poll())
+            {
+                finish(id);
+            }
+            else
+            {
+                polled.push_back(id);
+            }
+        }
+        else
+        {
+            task.function();
+            finish(id);
+        }
+
+        if (now() - pump_start >= budget_ms)
+        {
+            break;
+        }
+    }
+
+    if (!polled.empty())
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex_);
+        ready_.insert(ready_.end(), polled.begin(), polled.end());
+    }
+    return IsDone();
+}
+
+bool StartupGraph::IsDone()
+{
+    return done_count_.load() == (uint32_t)tasks_.size();
+}
+
+float StartupGraph::GetProgress()
+{
+    return tasks_.empty() ? 1.0f : (float)done_count_.load() / (float)tasks_.size();
+}
+
+void StartupGraph::PrintTimeline()
+{
+    // Sorted by start, times in ms since Start. Main covers the polled
+    // tasks from their first call to the one that returned true.
+    //
+    std::vector<StartupGraph::TaskId> order;
+    for (StartupGraph::TaskId id = 0; id < (StartupGraph::TaskId)tasks_.size(); id++)
+    {
+        order.push_back(id);
+    }
+    std::sort(order.begin(), order.end(), [this](StartupGraph::TaskId a, StartupGraph::TaskId b) {
+        return tasks_.at(a)->start_ms < tasks_.at(b)->start_ms;
+    });
+
+    double end_ms = 0.0;
+    double worker_ms = 0.0;
+    double main_ms = 0.0;
+    for (std::size_t i = 0; i < tasks_.size(); i++)
+    {
+        const StartupGraph::Task& task = *tasks_.at(i);
+        end_ms = std::max(end_ms, task.end_ms);
+        (task.kind == StartupGraph::Kind::WORKER ? worker_ms : main_ms) += task.end_ms - task.start_ms;
+    }
+
+    std::cout << "INFO::STARTUP_GRAPH::PRINT_TIMELINE::" << tasks_.size() << "_TASKS_" <<
+        (int)end_ms << "_MS" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(9) << "start" << std::setw(9) << "end" << std::setw(9) << "ms" << "  thread  task" << std::endl;
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+        const StartupGraph::Task& task = *tasks_.at(order.at(i));
+        std::cout << std::setw(9) << task.start_ms << std::setw(9) << task.end_ms << std::setw(9) <<
+            task.end_ms - task.start_ms << "  " << (task.kind == StartupGraph::Kind::WORKER ? "worker" : "main  ") <<
+            "  " << task.name << std::endl;
+    }
+    std::cout << "Worker time:" << worker_ms << "ms|Main time:" << main_ms << "ms" << std::endl;
+    std::cout << std::defaultfloat;
+}
+
+StartupGraph::TaskId StartupGraph::addTask(const std::string _name, StartupGraph::Kind kind,
+    const std::vector<StartupGraph::TaskId>& dependencies)
+{
+    StartupGraph::TaskId id = (StartupGraph::TaskId)tasks_.size();
+    std::unique_ptr<StartupGraph::Task> task(new StartupGraph::Task());
+    task->name = _name;
+    task->kind = kind;
+    task->remaining.store((uint32_t)dependencies.size());
+    task->started = false;
+    task->start_ms = 0.0;
+    task->end_ms = 0.0;
+    for (std::size_t i = 0; i < dependencies.size(); i++)
+    {
+        tasks_.at(dependencies.at(i))->dependents.push_back(id);
+    }
+    tasks_.push_back(std::move(task));
+    return id;
+}
+
+void StartupGraph::schedule(StartupGraph::TaskId id)
+{
+    if (tasks_.at(id)->kind == StartupGraph::Kind::WORKER)
+    {
+        job_system_.Run([this, id]() { runWorker(id); }, &worker_jobs_);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(ready_mutex_);
+    ready_.push_back(id);
+}
+
+void StartupGraph::runWorker(StartupGraph::TaskId id)
+{
+    StartupGraph::Task& task = *tasks_.at(id);
+    task.started = true;
+    task.start_ms = now();
+    task.function();
+    finish(id);
+}
+
+void StartupGraph::finish(StartupGraph::TaskId id)
+{
+    // The last dependency to finish schedules the dependent. The decrement
+    // orders this task's writes before everything the dependent reads.
+    //
+    StartupGraph::Task& task = *tasks_.at(id);
+    task.end_ms = now();
+    for (std::size_t i = 0; i < task.dependents.size(); i++)
+    {
+        StartupGraph::TaskId dependent = task.dependents.at(i);
+        if (tasks_.at(dependent)->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            schedule(dependent);
+        }
+    }
+    done_count_.fetch_add(1, std::memory_order_release);
+}
+
+double StartupGraph::now()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+}
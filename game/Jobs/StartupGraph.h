@@ -0,0 +1,92 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <string>
+
+#include "Jobs/JobSystem.h"
+
+// A one shot graph of the work that has to happen before the first frame.
+// Worker tasks (file parsing, image decode, mesh processing) are Run on the
+// job system as soon as everything they depend on is done. Main tasks are
+// everything that touches GL, they are queued when they become ready and
+// run by Pump, which the main thread calls between loading screen frames,
+// so uploads stream in as their inputs complete. A polled main task is
+// called once per Pump until it returns true.
+//
+// Tasks are added before Start, a task can only depend on tasks added
+// before it. Every task's start and end are kept, PrintTimeline shows them
+// once the graph is done.
+//
+class StartupGraph
+{
+public:
+    typedef uint32_t TaskId;
+
+    StartupGraph(JobSystem& job_system);
+    ~StartupGraph();
+
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    StartupGraph::TaskId AddWorkerTask(const std::string _name, std::function<void()> task,
+        const std::vector<StartupGraph::TaskId>& dependencies = {});
+    StartupGraph::TaskId AddMainTask(const std::string _name, std::function<void()> task,
+        const std::vector<StartupGraph::TaskId>& dependencies = {});
+    StartupGraph::TaskId AddPolledTask(const std::string _name, std::function<bool()> task,
+        const std::vector<StartupGraph::TaskId>& dependencies = {});
+
+    void Start();
+    bool Pump(double budget_ms);
+    bool IsDone();
+    float GetProgress();
+    void PrintTimeline();
+
+private:
+    enum class Kind
+    {
+        WORKER,
+        MAIN,
+        POLLED
+    };
+
+    struct Task
+    {
+        std::string name;
+        StartupGraph::Kind kind;
+        std::function<void()> function;
+        std::function<bool()> poll;
+        std::vector<StartupGraph::TaskId> dependents;
+        std::atomic<uint32_t> remaining;
+        bool started;
+        double start_ms;
+        double end_ms;
+    };
+
+    JobSystem& job_system_;
+    std::vector<std::unique_ptr<StartupGraph::Task>> tasks_;
+    std::chrono::steady_clock::time_point start_;
+    std::atomic<uint32_t> done_count_;
+    JobCounter worker_jobs_;
+
+    // Main and polled tasks whose dependencies are done, in the order they
+    // got ready. Only Pump takes them out.
+    //
+    std::mutex ready_mutex_;
+    std::deque<StartupGraph::TaskId> ready_;
+
+    StartupGraph::TaskId addTask(const std::string _name, StartupGraph::Kind kind,
+        const std::vector<StartupGraph::TaskId>& dependencies);
+    void schedule(StartupGraph::TaskId id);
+    void runWorker(StartupGraph::TaskId id);
+    void finish(StartupGraph::TaskId id);
+    double now();
+};
@@ -1,10 +1,13 @@
 #include <iostream>
+#include <string>
+#include <memory>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "Application/Window.h"
 #include "Game/Game.h"
+#include "Profiler/Profiler.h"
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 void mouseMoveCallback(GLFWwindow* window, double xPos, double yPos);
@@ -12,25 +15,159 @@ void mouseMoveCallback(GLFWwindow* window, double xPos, double yPos);
 const uint32_t _SCR_WIDTH = 1600;
 const uint32_t _SCR_HEIGHT = 900;
 const std::string _WINDOW_NAME = "Squirrel Gold Rush";
+const uint32_t _BENCHMARK_SEED = 1337;
+const uint32_t _BENCHMARK_FRAMES = 1000;
 
-Window WINDOW(_SCR_WIDTH, _SCR_HEIGHT, _WINDOW_NAME, 4, 2, true);
-Game GAME(WINDOW);
+// Created in main once the command line is known, the GLFW callbacks reach
+// the game through this.
+//
+Game* GAME = nullptr;
 
-int main()
+// Usage:
+//   Game                       play
+//   Game --record FILE         play and save the walked path to FILE
+//   Game --benchmark           replay a path for a number of frames and 
+//                              write frame times to PREFIX.csv/.json
+//   Game --headless            same as --benchmark, offscreen without a window
+//   options: --path FILE (default built in path), --frames N (1000),
+//            --out PREFIX (frametimes), --seed N (1337 when benchmarking),
+//            --lod auto|N (auto picks the vegetation LOD by screen space 
+//            error, N draws every instance at level N), 
+//            --impostors D (distance where vegetation turns into 
+//            impostors, 60, 0 turns them off),
+//            --profile FILE (record CPU zones from startup, write them 
+//            to FILE as a Chrome trace at exit, F3 writes trace.json),
+//            --workers N (job system threads, default: hardware 
+//            threads - 1)
+//
+int main(int argc, char** argv)
 {
-	WINDOW.SetFramebufferSizeCallback(framebufferSizeCallback);
-	WINDOW.SetMouseMoveCallback(mouseMoveCallback);
+	bool benchmark = false;
+	bool headless = false;
+	std::string record_path, path_file, output_prefix = "frametimes";
+	uint32_t frame_count = _BENCHMARK_FRAMES;
+	uint32_t seed = 0;
+	int lod_mode = -1;
+	float impostor_distance = -1.0f;
+	std::string profile_path;
+	uint32_t worker_count = 0;
 
-	GAME.Start();
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (arg == "--headless")
+		{
+			headless = true;
+			benchmark = true;
+		}
+		else if (arg == "--benchmark")
+		{
+			benchmark = true;
+		}
+		else if (arg == "--record" && has_value)
+		{
+			record_path = argv[++i];
+		}
+		else if (arg == "--path" && has_value)
+		{
+			path_file = argv[++i];
+		}
+		else if (arg == "--frames" && has_value)
+		{
+			frame_count = (uint32_t)std::stoul(argv[++i]);
+		}
+		else if (arg == "--out" && has_value)
+		{
+			output_prefix = argv[++i];
+		}
+		else if (arg == "--seed" && has_value)
+		{
+			seed = (uint32_t)std::stoul(argv[++i]);
+		}
+		else if (arg == "--lod" && has_value)
+		{
+			std::string mode = argv[++i];
+			lod_mode = (mode == "auto") ? -1 : std::stoi(mode);
+		}
+		else if (arg == "--impostors" && has_value)
+		{
+			impostor_distance = std::stof(argv[++i]);
+		}
+		else if (arg == "--profile" && has_value)
+		{
+			profile_path = argv[++i];
+		}
+		else if (arg == "--workers" && has_value)
+		{
+			worker_count = (uint32_t)std::stoul(argv[++i]);
+		}
+		else
+		{
+			std::cout << "ERROR::MAIN::MAIN::UNKNOWN_ARGUMENT::" << arg << std::endl;
+			return 1;
+		}
+	}
+
+	// Benchmarks always run on the same world.
+	//
+	if (benchmark && seed == 0)
+	{
+		seed = _BENCHMARK_SEED;
+	}
+
+	// Enabled before anything is created, so the trace covers the startup.
+	//
+	if (!profile_path.empty())
+	{
+		Profiler::SetEnabled(true);
+		Profiler::SetThreadName("main");
+	}
+
+	Window window(_SCR_WIDTH, _SCR_HEIGHT, _WINDOW_NAME, 4, 2, !headless, 2, headless);
+	// The game outlives any scope here, its startup is recorded by hand.
+	//
+	uint64_t startup_ns = Profiler::Now();
+	std::unique_ptr<Game> game(new Game(window, seed, worker_count));
+	if (Profiler::IsEnabled())
+	{
+		Profiler::Record("Game::Game", startup_ns, Profiler::Now());
+	}
+	GAME = game.get();
+	GAME->SetLodMode(lod_mode);
+	if (impostor_distance >= 0.0f)
+	{
+		GAME->SetImpostorDistance(impostor_distance);
+	}
+
+	if (!headless)
+	{
+		window.SetFramebufferSizeCallback(framebufferSizeCallback);
+		window.SetMouseMoveCallback(mouseMoveCallback);
+	}
+
+	if (benchmark)
+	{
+		GAME->RunBenchmark(path_file, frame_count, output_prefix);
+	}
+	else
+	{
+		GAME->Start(record_path);
+	}
+
+	if (!profile_path.empty())
+	{
+		Profiler::WriteTrace(profile_path);
+	}
 	return 0;
 }
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-	GAME.HandleFramebuffer(window, width, height);
+	GAME->HandleFramebuffer(window, width, height);
 }
 
 void mouseMoveCallback(GLFWwindow* window, double x_pos, double y_pos)
 {
-	GAME.HandleMouse(window, x_pos, y_pos);
-}
\ No newline at end of file
+	GAME->HandleMouse(window, x_pos, y_pos);
+}
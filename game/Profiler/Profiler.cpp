@@ -0,0 +1,130 @@
+#include "Profiler/Profiler.h"
+
+std::atomic<bool> Profiler::enabled_(false);
+std::mutex Profiler::threads_mutex_;
+std::vector<std::unique_ptr<Profiler::ThreadBuffer>> Profiler::threads_;
+thread_local Profiler::ThreadBuffer* Profiler::current_thread_ = nullptr;
+const uint64_t Profiler::_START_NS_ = Profiler::Now();
+const uint32_t Profiler::_RING_CAPACITY_ = 1 << 16;
+
+void Profiler::SetEnabled(bool enabled)
+{
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::SetThreadName(const std::string _name)
+{
+    // WriteTrace reads the name under the same lock. A disabled profiler
+    // doesn't allocate a ring for it.
+    //
+    if (IsEnabled())
+    {
+        Profiler::ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        buffer.name = _name;
+    }
+}
+
+void Profiler::Record(const char* name, uint64_t start_ns, uint64_t end_ns)
+{
+    // The event is written before the head moves past it, a reader that
+    // sees the new head sees the event.
+    //
+    Profiler::ThreadBuffer& buffer = threadBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    Profiler::Event& event = buffer.events[head % _RING_CAPACITY_];
+    event.name = name;
+    event.start_ns = start_ns;
+    event.end_ns = end_ns;
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+bool Profiler::WriteTrace(const std::string _path)
+{
+    std::ofstream file(_path);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR::PROFILER::WRITE_TRACE::CANNOT_OPEN::" << _path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    std::vector<Profiler::Event> events;
+    std::size_t event_count = 0;
+    bool first = true;
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (std::size_t t = 0; t < threads_.size(); t++)
+    {
+        Profiler::ThreadBuffer& buffer = *threads_.at(t);
+        file << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" <<
+            buffer.thread_id << ",\"args\":{\"name\":\"" << escape(buffer.name) << "\"}}";
+        first = false;
+
+        // The owner keeps recording while the ring is copied, anything it
+        // may have overwritten in the meantime is left out.
+        //
+        uint64_t head = buffer.head.load(std::memory_order_acquire);
+        uint64_t begin = (head > _RING_CAPACITY_) ? head - _RING_CAPACITY_ : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++)
+        {
+            events.push_back(buffer.events[i % _RING_CAPACITY_]);
+        }
+        uint64_t overwritten = buffer.head.load(std::memory_order_acquire);
+        uint64_t valid_begin = (overwritten > _RING_CAPACITY_) ? overwritten - _RING_CAPACITY_ : 0;
+
+        for (uint64_t i = std::max(begin, valid_begin); i < head; i++)
+        {
+            const Profiler::Event& event = events.at(i - begin);
+            file << ",\n{\"name\":\"" << escape(event.name) << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" <<
+                buffer.thread_id << ",\"ts\":" << (double)(event.start_ns - _START_NS_) / 1000.0 <<
+                ",\"dur\":" << (double)(event.end_ns - event.start_ns) / 1000.0 << "}";
+            event_count++;
+        }
+    }
+    file << "\n]}\n";
+
+    if (!file.good())
+    {
+        std::cout << "ERROR::PROFILER::WRITE_TRACE::FAILED::" << _path << std::endl;
+        return false;
+    }
+    std::cout << "INFO::PROFILER::WRITE_TRACE::" << event_count << "_ZONES::" << _path << std::endl;
+    return true;
+}
+
+Profiler::ThreadBuffer& Profiler::threadBuffer()
+{
+    // Registered the first time the thread records, the lock is only taken
+    // once per thread.
+    //
+    if (current_thread_ == nullptr)
+    {
+        std::unique_ptr<Profiler::ThreadBuffer> buffer(new Profiler::ThreadBuffer());
+        buffer->events.resize(_RING_CAPACITY_);
+        buffer->head.store(0, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        buffer->thread_id = (uint32_t)threads_.size();
+        buffer->name = "thread " + std::to_string(buffer->thread_id);
+        current_thread_ = buffer.get();
+        threads_.push_back(std::move(buffer));
+    }
+    return *current_thread_;
+}
+
+std::string Profiler::escape(const std::string _text)
+{
+    std::string escaped;
+    for (std::size_t i = 0; i < _text.size(); i++)
+    {
+        if (_text[i] == '"' || _text[i] == '\\')
+        {
+            escaped += '\\';
+        }
+        escaped += _text[i];
+    }
+    return escaped;
+}
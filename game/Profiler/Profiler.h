@@ -0,0 +1,108 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+// Scoped CPU timing zones. PROFILE_SCOPE("Name") times the rest of the
+// enclosing scope. While the profiler is disabled a zone costs one relaxed
+// atomic load, defining PROFILER_DISABLED compiles the zones out entirely.
+// Zone names have to be string literals, only the pointer is stored.
+//
+// Every thread records into its own ring buffer, only that thread writes
+// it, so recording takes no lock. When a ring is full the oldest zones are
+// overwritten. WriteTrace dumps the rings of all threads as Chrome trace
+// event JSON (chrome://tracing, Perfetto), it can run any time from any
+// thread.
+//
+#ifdef PROFILER_DISABLED
+#define PROFILE_SCOPE(name)
+#else
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#endif
+
+class Profiler
+{
+public:
+    static void SetEnabled(bool enabled);
+    static void SetThreadName(const std::string _name);
+    static void Record(const char* name, uint64_t start_ns, uint64_t end_ns);
+    static bool WriteTrace(const std::string _path);
+
+    static inline bool IsEnabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    static inline uint64_t Now()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    struct Event
+    {
+        const char* name;
+        uint64_t start_ns;
+        uint64_t end_ns;
+    };
+
+    struct ThreadBuffer
+    {
+        uint32_t thread_id;
+        std::string name;
+        std::vector<Profiler::Event> events;
+        std::atomic<uint64_t> head;
+    };
+
+    // Buffers are never freed, a thread that exited still shows up in the
+    // trace.
+    //
+    static std::atomic<bool> enabled_;
+    static std::mutex threads_mutex_;
+    static std::vector<std::unique_ptr<Profiler::ThreadBuffer>> threads_;
+    static thread_local Profiler::ThreadBuffer* current_thread_;
+    static const uint64_t _START_NS_;
+    static const uint32_t _RING_CAPACITY_;
+
+    Profiler();
+
+    static Profiler::ThreadBuffer& threadBuffer();
+    static std::string escape(const std::string _text);
+};
+
+class ProfileZone
+{
+public:
+    inline ProfileZone(const char* name) :
+        name_(name),
+        active_(Profiler::IsEnabled()),
+        start_ns_(active_ ? Profiler::Now() : 0)
+    {
+    }
+
+    inline ~ProfileZone()
+    {
+        if (active_)
+        {
+            Profiler::Record(name_, start_ns_, Profiler::Now());
+        }
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name_;
+    bool active_;
+    uint64_t start_ns_;
+};
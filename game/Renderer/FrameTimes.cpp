@@ -0,0 +1,117 @@
+#include "FrameTimes.h"
+
+FrameTimes::FrameTimes()
+{
+}
+
+void FrameTimes::Add(double cpu_ms, double gpu_ms, std::size_t triangles)
+{
+    cpu_ms_.push_back(cpu_ms);
+    gpu_ms_.push_back(gpu_ms);
+    triangles_.push_back((double)triangles);
+}
+
+double FrameTimes::GetCpuPercentile(double percentile)
+{
+    return percentileOf(cpu_ms_, percentile);
+}
+
+double FrameTimes::GetGpuPercentile(double percentile)
+{
+    return percentileOf(gpu_ms_, percentile);
+}
+
+std::size_t FrameTimes::GetFrameCount()
+{
+    return cpu_ms_.size();
+}
+
+bool FrameTimes::WriteCsv(const std::string _path)
+{
+    std::ofstream file(_path);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR::FRAME_TIMES::WRITE_CSV::CANNOT_OPEN::" << _path << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "frame,cpu_ms,gpu_ms,triangles\n";
+    for (std::size_t i = 0; i < cpu_ms_.size(); i++)
+    {
+        file << i << "," << cpu_ms_.at(i) << "," << gpu_ms_.at(i) << "," << 
+            (uint64_t)triangles_.at(i) << "\n";
+    }
+    return true;
+}
+
+bool FrameTimes::WriteJson(const std::string _path)
+{
+    std::ofstream file(_path);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR::FRAME_TIMES::WRITE_JSON::CANNOT_OPEN::" << _path << std::endl;
+        return false;
+    }
+
+    const std::vector<double>* series[2] = { &cpu_ms_, &gpu_ms_ };
+    const char* names[2] = { "cpu_ms", "gpu_ms" };
+
+    file << std::fixed << std::setprecision(4);
+    file << "{\n  \"frames\": " << cpu_ms_.size();
+    for (int s = 0; s < 2; s++)
+    {
+        file << ",\n  \"" << names[s] << "\": { " << 
+            "\"mean\": " << meanOf(*series[s]) << ", " << 
+            "\"p50\": " << percentileOf(*series[s], 50.0) << ", " << 
+            "\"p95\": " << percentileOf(*series[s], 95.0) << ", " << 
+            "\"p99\": " << percentileOf(*series[s], 99.0) << ", " << 
+            "\"max\": " << percentileOf(*series[s], 100.0) << " }";
+    }
+    file << ",\n  \"triangles\": { " << 
+        "\"mean\": " << meanOf(triangles_) << ", " << 
+        "\"max\": " << percentileOf(triangles_, 100.0) << " }";
+    file << "\n}\n";
+    return true;
+}
+
+void FrameTimes::PrintSummary()
+{
+    std::cout << "INFO::FRAME_TIMES::SUMMARY::" << cpu_ms_.size() << "_FRAMES" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "CPU ms p50:" << GetCpuPercentile(50.0) << " p95:" << GetCpuPercentile(95.0) << 
+        " p99:" << GetCpuPercentile(99.0) << std::endl;
+    std::cout << "GPU ms p50:" << GetGpuPercentile(50.0) << " p95:" << GetGpuPercentile(95.0) << 
+        " p99:" << GetGpuPercentile(99.0) << std::endl;
+    std::cout << std::setprecision(0) << "Triangles mean:" << meanOf(triangles_) << 
+        " max:" << percentileOf(triangles_, 100.0) << std::endl;
+    std::cout << std::defaultfloat << std::setprecision(6);
+}
+
+double FrameTimes::percentileOf(std::vector<double> values, double percentile)
+{
+    // Nearest rank.
+    //
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    std::size_t rank = (std::size_t)std::ceil(percentile / 100.0 * (double)values.size());
+    rank = std::min(std::max(rank, (std::size_t)1), values.size());
+    return values.at(rank - 1);
+}
+
+double FrameTimes::meanOf(const std::vector<double>& values)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        sum += values.at(i);
+    }
+    return sum / (double)values.size();
+}
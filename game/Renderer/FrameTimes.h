@@ -0,0 +1,36 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Per frame CPU and GPU times of a benchmark run in milliseconds and the
+// number of instanced triangles drawn, written out as CSV (one row per 
+// frame) and a JSON summary with percentiles.
+//
+class FrameTimes
+{
+public:
+    FrameTimes();
+
+    void Add(double cpu_ms, double gpu_ms, std::size_t triangles = 0);
+    double GetCpuPercentile(double percentile);
+    double GetGpuPercentile(double percentile);
+    std::size_t GetFrameCount();
+
+    bool WriteCsv(const std::string _path);
+    bool WriteJson(const std::string _path);
+    void PrintSummary();
+
+private:
+    std::vector<double> cpu_ms_;
+    std::vector<double> gpu_ms_;
+    std::vector<double> triangles_;
+
+    static double percentileOf(std::vector<double> values, double percentile);
+    static double meanOf(const std::vector<double>& values);
+};
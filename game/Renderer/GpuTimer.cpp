@@ -0,0 +1,254 @@
+#include "Renderer/GpuTimer.h"
+
+const uint32_t GpuTimer::_HISTORY_LENGTH_ = 240;
+
+GpuTimer::GpuTimer(uint32_t history_length) :
+    history_length_(std::max(history_length, (uint32_t)1)),
+    history_offset_(0),
+    history_count_(0),
+    frame_(0),
+    dropped_frames_(0),
+    active_pass_(-1)
+{
+    history_frames_.resize(history_length_, 0);
+}
+
+GpuTimer::~GpuTimer()
+{
+    for (std::size_t i = 0; i < passes_.size(); i++)
+    {
+        glDeleteQueries(2, passes_.at(i).queries);
+    }
+}
+
+void GpuTimer::BeginFrame()
+{
+    // The set this frame is going to use was last used two frames ago.
+    //
+    frame_++;
+    collect((uint32_t)(frame_ % 2), frame_ - 2, false);
+}
+
+void GpuTimer::Begin(const std::string& name)
+{
+    if (active_pass_ != -1)
+    {
+        std::cout << "ERROR::GPU_TIMER::BEGIN::NESTED_PASS::" << name << std::endl;
+        return;
+    }
+
+    std::size_t pass = findPass(name);
+    uint32_t query_set = (uint32_t)(frame_ % 2);
+    glBeginQuery(GL_TIME_ELAPSED, passes_.at(pass).queries[query_set]);
+    passes_.at(pass).issued[query_set] = true;
+    active_pass_ = (int)pass;
+}
+
+void GpuTimer::End()
+{
+    if (active_pass_ == -1)
+    {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+    active_pass_ = -1;
+}
+
+void GpuTimer::Flush()
+{
+    // Waits for the last two frames, only meant for the end of a run.
+    //
+    collect((uint32_t)((frame_ + 1) % 2), frame_ - 1, true);
+    collect((uint32_t)(frame_ % 2), frame_, true);
+}
+
+void GpuTimer::SetHistoryLength(uint32_t history_length)
+{
+    // Starts a new recording, results still in flight are never read and
+    // the frames count from 0 again, like the rows of FrameTimes.
+    //
+    history_length_ = std::max(history_length, (uint32_t)1);
+    history_offset_ = 0;
+    history_count_ = 0;
+    dropped_frames_ = 0;
+    history_frames_.assign(history_length_, 0);
+    for (std::size_t i = 0; i < passes_.size(); i++)
+    {
+        passes_.at(i).history.assign(history_length_, 0.0f);
+        passes_.at(i).issued[0] = false;
+        passes_.at(i).issued[1] = false;
+    }
+    frame_ = 0;
+}
+
+std::size_t GpuTimer::GetPassCount() const
+{
+    return passes_.size();
+}
+
+const std::string& GpuTimer::GetPassName(std::size_t pass) const
+{
+    return passes_.at(pass).name;
+}
+
+const std::vector<float>& GpuTimer::GetPassHistory(std::size_t pass) const
+{
+    return passes_.at(pass).history;
+}
+
+float GpuTimer::GetPassAverage(std::size_t pass) const
+{
+    if (history_count_ == 0)
+    {
+        return 0.0f;
+    }
+
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < history_count_; i++)
+    {
+        sum += passes_.at(pass).history.at((history_offset_ + i) % history_length_);
+    }
+    return sum / (float)history_count_;
+}
+
+float GpuTimer::GetPassMax(std::size_t pass) const
+{
+    float max = 0.0f;
+    for (uint32_t i = 0; i < history_count_; i++)
+    {
+        max = std::max(max, passes_.at(pass).history.at((history_offset_ + i) % history_length_));
+    }
+    return max;
+}
+
+uint32_t GpuTimer::GetHistoryOffset() const
+{
+    return history_offset_;
+}
+
+uint32_t GpuTimer::GetHistoryCount() const
+{
+    return history_count_;
+}
+
+uint32_t GpuTimer::GetDroppedFrames() const
+{
+    return dropped_frames_;
+}
+
+bool GpuTimer::WriteCsv(const std::string _path)
+{
+    std::ofstream file(_path);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR::GPU_TIMER::WRITE_CSV::CANNOT_OPEN::" << _path << std::endl;
+        return false;
+    }
+
+    // Oldest frame first, the frame column is the number of the frame the
+    // times were measured in, dropped frames are missing rows.
+    //
+    file << std::fixed << std::setprecision(4);
+    file << "frame";
+    for (std::size_t p = 0; p < passes_.size(); p++)
+    {
+        file << "," << passes_.at(p).name << "_ms";
+    }
+    file << ",total_ms\n";
+    for (uint32_t i = 0; i < history_count_; i++)
+    {
+        uint32_t slot = (history_offset_ + i) % history_length_;
+        float total = 0.0f;
+        file << history_frames_.at(slot);
+        for (std::size_t p = 0; p < passes_.size(); p++)
+        {
+            file << "," << passes_.at(p).history.at(slot);
+            total += passes_.at(p).history.at(slot);
+        }
+        file << "," << total << "\n";
+    }
+
+    std::cout << "INFO::GPU_TIMER::WRITE_CSV::" << history_count_ << "_FRAMES_" << dropped_frames_ << 
+        "_DROPPED::" << _path << std::endl;
+    return true;
+}
+
+void GpuTimer::collect(uint32_t query_set, uint64_t frame, bool wait)
+{
+    bool issued = false;
+    for (std::size_t p = 0; p < passes_.size(); p++)
+    {
+        issued = issued || passes_.at(p).issued[query_set];
+    }
+    if (!issued)
+    {
+        return;
+    }
+
+    // Either every pass of the frame is read or none, so a row always adds
+    // up to the frame.
+    //
+    bool available = true;
+    for (std::size_t p = 0; p < passes_.size() && available && !wait; p++)
+    {
+        if (passes_.at(p).issued[query_set])
+        {
+            GLint ready = GL_FALSE;
+            glGetQueryObjectiv(passes_.at(p).queries[query_set], GL_QUERY_RESULT_AVAILABLE, &ready);
+            available = ready == GL_TRUE;
+        }
+    }
+
+    uint32_t slot = (history_offset_ + history_count_) % history_length_;
+    if (available)
+    {
+        if (history_count_ < history_length_)
+        {
+            history_count_++;
+        }
+        else
+        {
+            history_offset_ = (history_offset_ + 1) % history_length_;
+        }
+        history_frames_.at(slot) = frame - 1;
+    }
+    else
+    {
+        dropped_frames_++;
+    }
+
+    for (std::size_t p = 0; p < passes_.size(); p++)
+    {
+        Pass& pass = passes_.at(p);
+        if (available)
+        {
+            GLuint64 elapsed_ns = 0;
+            if (pass.issued[query_set])
+            {
+                glGetQueryObjectui64v(pass.queries[query_set], GL_QUERY_RESULT, &elapsed_ns);
+            }
+            pass.history.at(slot) = (float)((double)elapsed_ns / 1e6);
+        }
+        pass.issued[query_set] = false;
+    }
+}
+
+std::size_t GpuTimer::findPass(const std::string& name)
+{
+    std::unordered_map<std::string, std::size_t>::iterator it = pass_indices_.find(name);
+    if (it != pass_indices_.end())
+    {
+        return it->second;
+    }
+
+    Pass pass;
+    pass.name = name;
+    glGenQueries(2, pass.queries);
+    pass.issued[0] = false;
+    pass.issued[1] = false;
+    pass.history.assign(history_length_, 0.0f);
+    passes_.push_back(pass);
+    pass_indices_[name] = passes_.size() - 1;
+    return passes_.size() - 1;
+}
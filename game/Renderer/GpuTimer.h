@@ -0,0 +1,74 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// GPU time of the render passes of a frame, measured with one
+// GL_TIME_ELAPSED query pair per pass. Every pass has two queries and the
+// frames alternate between them. A frame's results are read when its
+// queries are reused two frames later, by then the GPU is done with them.
+// A result that still isn't ready drops that frame instead of waiting.
+//
+// Passes are created the first time Begin sees their name and keep a
+// rolling history of their time in milliseconds. The history is what the
+// overlay graphs and what WriteCsv exports. Passes can't nest, elapsed
+// time queries of the same target can't overlap.
+//
+class GpuTimer
+{
+public:
+    GpuTimer(uint32_t history_length = _HISTORY_LENGTH_);
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void BeginFrame();
+    void Begin(const std::string& name);
+    void End();
+    void Flush();
+    void SetHistoryLength(uint32_t history_length);
+
+    std::size_t GetPassCount() const;
+    const std::string& GetPassName(std::size_t pass) const;
+    const std::vector<float>& GetPassHistory(std::size_t pass) const;
+    float GetPassAverage(std::size_t pass) const;
+    float GetPassMax(std::size_t pass) const;
+    uint32_t GetHistoryOffset() const;
+    uint32_t GetHistoryCount() const;
+    uint32_t GetDroppedFrames() const;
+
+    bool WriteCsv(const std::string _path);
+
+private:
+    struct Pass
+    {
+        std::string name;
+        uint32_t queries[2];
+        bool issued[2];
+        std::vector<float> history;
+    };
+
+    std::vector<Pass> passes_;
+    std::unordered_map<std::string, std::size_t> pass_indices_;
+    std::vector<uint64_t> history_frames_;
+    uint32_t history_length_;
+    uint32_t history_offset_;
+    uint32_t history_count_;
+    uint64_t frame_;
+    uint32_t dropped_frames_;
+    int active_pass_;
+
+    static const uint32_t _HISTORY_LENGTH_;
+
+    void collect(uint32_t query_set, uint64_t frame, bool wait);
+    std::size_t findPass(const std::string& name);
+};
@@ -0,0 +1,246 @@
+#include "Renderer/Impostor.h"
+
+const uint32_t Impostor::_FRAMES_ = 8;
+const uint32_t Impostor::_FRAME_SIZE_ = 128;
+const int Impostor::_MAX_MIP_LEVEL_ = 4;
+
+Impostor::Impostor(std::vector<Mesh>& meshes, Shader& bake_shader,
+    uint32_t frames, uint32_t frame_size) :
+    frames_(frames),
+    frame_size_(frame_size),
+    albedo_id_(0),
+    normal_id_(0),
+    vao_(0),
+    vbo_(0),
+    radius_(0.0f)
+{
+    double time = glfwGetTime();
+
+    calculateBounds(meshes);
+    bake(meshes, bake_shader);
+    setupQuad();
+
+    std::cout << "INFO::IMPOSTOR::IMPOSTOR::BAKED_" << frames_ << "x" << frames_ << "_FRAMES" << std::endl;
+    std::cout << "Bake took:" << (glfwGetTime() - time) * 1000 << "ms" << std::endl;
+}
+
+Impostor::~Impostor()
+{
+    glDeleteTextures(1, &albedo_id_);
+    glDeleteTextures(1, &normal_id_);
+    glDeleteVertexArrays(1, &vao_);
+    glDeleteBuffers(1, &vbo_);
+}
+
+void Impostor::SetInstances(const std::vector<Instance>& instances)
+{
+    instance_buffer_.Data(instances);
+}
+
+void Impostor::DrawInstanced(Shader& shader)
+{
+    if (instance_buffer_.GetCount() == 0)
+    {
+        return;
+    }
+
+    shader.Use();
+    shader.SetInt("impostor_albedo", 0);
+    shader.SetInt("impostor_normal", 1);
+    shader.SetVec3("impostor_center", center_);
+    shader.SetFloat("impostor_radius", radius_);
+    shader.SetFloat("impostor_frames", (float)frames_);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, albedo_id_);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, normal_id_);
+
+    glBindVertexArray(vao_);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)instance_buffer_.GetCount());
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE0);
+}
+
+uint32_t Impostor::GetInstanceCount() const
+{
+    return instance_buffer_.GetCount();
+}
+
+std::size_t Impostor::GetMemoryFootprint() const
+{
+    // GPU memory of the two atlases, the mip chain adds about a third.
+    //
+    std::size_t atlas_size = (std::size_t)frames_ * frame_size_;
+    return 2 * atlas_size * atlas_size * 4 * 4 / 3;
+}
+
+void Impostor::calculateBounds(const std::vector<Mesh>& meshes)
+{
+    glm::vec3 min_corner(std::numeric_limits<float>::max());
+    glm::vec3 max_corner(std::numeric_limits<float>::lowest());
+    for (std::size_t i = 0; i < meshes.size(); i++)
+    {
+        for (std::size_t j = 0; j < meshes.at(i).vertices_.size(); j++)
+        {
+            min_corner = glm::min(min_corner, meshes.at(i).vertices_.at(j).position);
+            max_corner = glm::max(max_corner, meshes.at(i).vertices_.at(j).position);
+        }
+    }
+
+    center_ = (min_corner + max_corner) * 0.5f;
+    radius_ = std::max(glm::length(max_corner - min_corner) * 0.5f, 0.001f);
+}
+
+void Impostor::bake(std::vector<Mesh>& meshes, Shader& bake_shader)
+{
+    // Everything the bake changes is put back afterwards, it runs in the
+    // middle of the world setup.
+    //
+    GLint viewport[4];
+    GLint previous_framebuffer;
+    GLfloat clear_color[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+
+    uint32_t atlas_size = frames_ * frame_size_;
+    albedo_id_ = createAtlasTexture(GL_SRGB8_ALPHA8);
+    normal_id_ = createAtlasTexture(GL_RGBA8);
+
+    uint32_t depth_id, framebuffer_id;
+    glGenRenderbuffers(1, &depth_id);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_id);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, atlas_size, atlas_size);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer_id);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedo_id_, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normal_id_, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_id);
+    const GLenum _draw_buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, _draw_buffers);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::IMPOSTOR::BAKE::FRAMEBUFFER_INCOMPLETE" << std::endl;
+    }
+    else
+    {
+        // Coverage is the alpha channel, empty texels stay at zero.
+        //
+        glDisable(GL_BLEND);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glViewport(0, 0, atlas_size, atlas_size);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // An orthographic view of the bounding sphere from every direction,
+        // the cell axes are the camera right and up vectors that
+        // impostor.vert rebuilds from the same direction.
+        //
+        glm::mat4 projection = glm::ortho(-radius_, radius_, -radius_, radius_, 0.0f, 4.0f * radius_);
+        bake_shader.Use();
+        bake_shader.SetMat4("projection", projection);
+        bake_shader.SetMat4("model", glm::mat4(1.0f));
+        for (uint32_t y = 0; y < frames_; y++)
+        {
+            for (uint32_t x = 0; x < frames_; x++)
+            {
+                glm::vec3 direction = frameDirection(x, y, frames_);
+                glm::mat4 view = glm::lookAt(center_ + direction * 2.0f * radius_, center_, glm::vec3(0.0f, 1.0f, 0.0f));
+                bake_shader.SetMat4("view", view);
+
+                glViewport(x * frame_size_, y * frame_size_, frame_size_, frame_size_);
+                for (std::size_t i = 0; i < meshes.size(); i++)
+                {
+                    meshes.at(i).Draw(bake_shader);
+                }
+            }
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    glDeleteFramebuffers(1, &framebuffer_id);
+    glDeleteRenderbuffers(1, &depth_id);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+    if (blend)
+    {
+        glEnable(GL_BLEND);
+    }
+
+    // A few mip levels for the far field, not down to a single texel where
+    // the cells would bleed into each other.
+    //
+    const uint32_t _atlases[2] = { albedo_id_, normal_id_ };
+    for (int i = 0; i < 2; i++)
+    {
+        glBindTexture(GL_TEXTURE_2D, _atlases[i]);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Impostor::setupQuad()
+{
+    const float _corners[8] = {
+        -1.0f, -1.0f,
+         1.0f, -1.0f,
+        -1.0f,  1.0f,
+         1.0f,  1.0f
+    };
+
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(_corners), _corners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (const void*)0);
+
+    // Same instance layout as the meshes, see Mesh::SetupInstanceAttributes.
+    //
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_.GetId());
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (const void*)offsetof(Instance, position));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Instance), (const void*)offsetof(Instance, yaw));
+    glVertexAttribDivisor(3, 1);
+    glVertexAttribDivisor(4, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+uint32_t Impostor::createAtlasTexture(GLenum internal_format)
+{
+    uint32_t atlas_size = frames_ * frame_size_;
+
+    uint32_t texture_id;
+    glGenTextures(1, &texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, atlas_size, atlas_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, _MAX_MIP_LEVEL_);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return texture_id;
+}
+
+glm::vec3 Impostor::frameDirection(uint32_t x, uint32_t y, uint32_t frames)
+{
+    // Hemi-octahedral decode of the cell center, keep in sync with
+    // impostor.vert.
+    //
+    glm::vec2 octahedral = (glm::vec2((float)x, (float)y) + 0.5f) / (float)frames * 2.0f - 1.0f;
+    glm::vec3 direction((octahedral.x - octahedral.y) * 0.5f, 0.0f, (octahedral.x + octahedral.y) * 0.5f);
+    direction.y = 1.0f - std::abs(direction.x) - std::abs(direction.z);
+    return glm::normalize(direction);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <limits>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Renderer/Shader.h"
+#include "Renderer/Mesh.h"
+#include "Buffers/InstanceBuffer.h"
+#include "Types/Instance.h"
+
+// Octahedral impostor of a model: the model rendered from a hemisphere of
+// view directions into an atlas of frames x frames cells, one texture with
+// the diffuse color and coverage, one with the model space normal. The
+// directions are laid out with the hemi-octahedral mapping, so neighbouring
+// cells are neighbouring directions.
+//
+// Drawing is one camera facing quad per instance. impostor.vert picks the
+// cell closest to the direction the instance is seen from and turns the
+// quad to it, impostor.frag lights the stored normal like the mesh shader.
+//
+class Impostor
+{
+public:
+    Impostor(std::vector<Mesh>& meshes, Shader& bake_shader,
+        uint32_t frames = _FRAMES_, uint32_t frame_size = _FRAME_SIZE_);
+    ~Impostor();
+
+    Impostor(const Impostor&) = delete;
+    Impostor& operator=(const Impostor&) = delete;
+
+    void SetInstances(const std::vector<Instance>& instances);
+    void DrawInstanced(Shader& shader);
+    uint32_t GetInstanceCount() const;
+    std::size_t GetMemoryFootprint() const;
+
+private:
+    uint32_t frames_;
+    uint32_t frame_size_;
+    uint32_t albedo_id_, normal_id_;
+    uint32_t vao_, vbo_;
+    glm::vec3 center_;
+    float radius_;
+    InstanceBuffer<Instance> instance_buffer_;
+
+    static const uint32_t _FRAMES_;
+    static const uint32_t _FRAME_SIZE_;
+    static const int _MAX_MIP_LEVEL_;
+
+    void calculateBounds(const std::vector<Mesh>& meshes);
+    void bake(std::vector<Mesh>& meshes, Shader& bake_shader);
+    void setupQuad();
+    uint32_t createAtlasTexture(GLenum internal_format);
+    static glm::vec3 frameDirection(uint32_t x, uint32_t y, uint32_t frames);
+};
@@ -13,13 +13,43 @@ const std::string Mesh::_COLOR_EMISSIVE_NAME_ = "color_emissive_";
 Mesh::Mesh(std::vector<Mesh::Vertex>& vertices, 
     std::vector<uint32_t>& indices, 
     std::vector<Mesh::Texture>& textures,
-    bool embedded) :
+    bool embedded,
+    bool upload) :
     vertices_(vertices),
     indices_(indices),
     textures_(textures),
+    vao_(0),
+    vbo_(0),
+    ebo_(0),
     embedded_(embedded)
 {
-    setupMesh();
+    if (upload)
+    {
+        Upload();
+    }
+}
+
+Mesh::Mesh(const Mesh::Vertex* vertices, const std::size_t _vertex_count,
+    const uint32_t* indices, const std::size_t _index_count,
+    std::vector<Mesh::Texture>& textures,
+    bool embedded,
+    bool upload) :
+    textures_(textures),
+    vao_(0),
+    vbo_(0),
+    ebo_(0),
+    embedded_(embedded)
+{
+    // Uploads straight from the caller's memory (a mapped mesh cache file).
+    // The CPU copies are still kept, GObject builds its bounding box from the
+    // vertex positions, and a deferred upload reads them later.
+    //
+    if (upload)
+    {
+        setupMesh(vertices, _vertex_count, indices, _index_count);
+    }
+    vertices_.assign(vertices, vertices + _vertex_count);
+    indices_.assign(indices, indices + _index_count);
 }
 
 uint32_t Mesh::LoadTextureFromFile(const std::string _path, const std::string _directory,
@@ -33,28 +63,23 @@ uint32_t Mesh::LoadTextureFromFile(const std::string _path, const std::string _d
     glGenTextures(1, &texture_id);
     glBindTexture(GL_TEXTURE_2D, texture_id);
 
-    stbi_set_flip_vertically_on_load(flip_vertical);
-
-    int width, height, n_channels;
-    unsigned char* data = stbi_load(_full_path.c_str(), &width, &height, &n_channels, 0);
-    if (data)
+    // Decoded the same way as the texture loader does it, stb_image's global
+    // flip switch would affect decode jobs running at the same time. The
+    // blocks of every level come from the texture cache, or are baked into
+    // it on the first load.
+    //
+    TextureLoader::Image image = TextureLoader::Decode(_full_path, flip_vertical, TEXCOMPRESSenum::BC1);
+    if (!image.levels.empty())
     {
-        GLenum format = GL_RGB;
-        if (n_channels == 1)
+        const uint8_t* blocks = image.GetBlocks();
+        GLenum format = TextureLoader::GetCompressedFormat(image.format);
+        for (std::size_t level = 0; level < image.levels.size(); level++)
         {
-            format = GL_RED;
-        }
-        else if (n_channels == 3)
-        {
-            format = GL_RGB;
-        }
-        else if (n_channels == 4)
-        {
-            format = GL_RGBA;
+            const TextureCache::Level& data = image.levels.at(level);
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, format, (GLsizei)data.width, (GLsizei)data.height, 0,
+                (GLsizei)data.size, blocks + data.offset);
         }
-
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
 
         // Set the wrapping and filtering options (on the currently bound texture object).
         //
@@ -62,14 +87,11 @@ uint32_t Mesh::LoadTextureFromFile(const std::string _path, const std::string _d
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texture_wrapping);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmap_filtering_min);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mipmap_filtering_max);
-
-        stbi_image_free(data);
     }
     else
     {
         std::cout << "ERROR::MESH::LOAD_TEXTURE_FROM_FILE::FILE_READ_ERROR" << std::endl;
         std::cout << "Path:" << _path << std::endl;
-        stbi_image_free(data);
     }
 
     return texture_id;
@@ -95,7 +117,8 @@ void Mesh::Draw(Shader& shader)
     glActiveTexture(GL_TEXTURE0);
 }
 
-void Mesh::DrawInstanced(Shader& shader, const std::size_t _instance_size)
+void Mesh::DrawInstanced(Shader& shader, const std::size_t _instance_size, 
+    const std::size_t _base_instance)
 {
     shader.Use();
 
@@ -108,38 +131,69 @@ void Mesh::DrawInstanced(Shader& shader, const std::size_t _instance_size)
         setupTextures(shader);
     }
     
+    // The base instance offsets the per instance attributes, one instance
+    // buffer holds the instances of every LOD level back to back.
+    //
     glBindVertexArray(vao_);
+    glDrawElementsInstancedBaseInstance(
+        GL_TRIANGLES, 
+        (GLsizei)indices_.size(), 
+        GL_UNSIGNED_INT, 
+        (const void*)0, 
+        (GLsizei)_instance_size,
+        (GLuint)_base_instance
+    );
 
-    std::size_t size_of_vec4 = sizeof(glm::vec4);
+    glBindVertexArray(0);
 
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void Mesh::SetupInstanceAttributes(const uint32_t _instance_vbo)
+{
+    // The instance attributes are part of the VAO state, so they only need to
+    // be recorded once per mesh. The VAO references the buffer object, not its
+    // storage, so the instance buffer can be re-specified (orphaned, grown)
+    // later on without touching this setup again.
+    //
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, _instance_vbo);
+
+    // Position as 3 floats, yaw and scale as 2 normalized unsigned shorts 
+    // that arrive in the shader as a vec2 in [0, 1].
+    //
     glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * size_of_vec4, (const void*)0);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (const void*)offsetof(Instance, position));
     glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * size_of_vec4, (const void*)(1 * size_of_vec4));
-    glEnableVertexAttribArray(5);
-    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * size_of_vec4, (const void*)(2 * size_of_vec4));
-    glEnableVertexAttribArray(6);
-    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, 4 * size_of_vec4, (const void*)(3 * size_of_vec4));
+    glVertexAttribPointer(4, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Instance), (const void*)offsetof(Instance, yaw));
 
     glVertexAttribDivisor(3, 1);
     glVertexAttribDivisor(4, 1);
-    glVertexAttribDivisor(5, 1);
-    glVertexAttribDivisor(6, 1);
-
-    glDrawElementsInstanced(
-        GL_TRIANGLES, 
-        (GLsizei)indices_.size(), 
-        GL_UNSIGNED_INT, 
-        (const void*)0, 
-        (GLsizei)_instance_size
-    );
 
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 
-    glActiveTexture(GL_TEXTURE0);
+void Mesh::Upload()
+{
+    if (vao_ == 0)
+    {
+        setupMesh(vertices_.data(), vertices_.size(), indices_.data(), indices_.size());
+    }
+}
+
+bool Mesh::IsUploaded() const
+{
+    return vao_ != 0;
+}
+
+std::size_t Mesh::GetTriangleCount() const
+{
+    return indices_.size() / 3;
 }
 
-void Mesh::setupMesh()
+void Mesh::setupMesh(const Mesh::Vertex* vertices, const std::size_t _vertex_count,
+    const uint32_t* indices, const std::size_t _index_count)
 {
     glGenVertexArrays(1, &vao_);
     glGenBuffers(1, &vbo_);
@@ -154,13 +208,13 @@ void Mesh::setupMesh()
     // Also: prefer container.data() over &container[0]
     //
     glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Mesh::Vertex) * vertices_.size(), vertices_.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Mesh::Vertex) * _vertex_count, vertices, GL_STATIC_DRAW);
 
     // INDICES DATA
     // The indices of vertices in a mesh.
     //
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * indices_.size(), indices_.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * _index_count, indices, GL_STATIC_DRAW);
 
     // VERTEX ATTRIBUTES
     //
@@ -246,7 +300,8 @@ void Mesh::setupTextures(Shader& shader)
         }
 
         shader.SetInt((texture_name + texture_number), (int&)i);
-        glBindTexture(GL_TEXTURE_2D, textures_.at(i).id);
+        const Mesh::Texture& texture = textures_.at(i);
+        glBindTexture(GL_TEXTURE_2D, texture.handle ? texture.handle->GetId() : texture.id);
     }
 }
 
@@ -14,8 +14,14 @@
 #include <assimp/postprocess.h>
 
 #include "Renderer/Shader.h"
+#include "Assets/TextureLoader.h"
 #include "Types/ETexture.h"
+#include "Types/Instance.h"
 
+// A mesh made with upload false only holds its data on the CPU, it can be
+// built on any thread. Upload creates the GL objects on the thread that
+// owns the context before the mesh is drawn.
+//
 class Mesh
 {
 public:
@@ -28,6 +34,9 @@ public:
         glm::vec3 bi_tangent;
     };
 
+    // A texture file streamed in by the texture loader has a handle and no
+    // id, it binds as 0 until it is uploaded.
+    //
     struct Texture
     {
         uint32_t id;
@@ -35,6 +44,7 @@ public:
         std::string path;
         TEXTYPEenum type;
         TEXFORMATenum format;
+        TextureHandle handle;
     };
 
     std::vector<Mesh::Vertex> vertices_;
@@ -44,14 +54,25 @@ public:
     Mesh(std::vector<Mesh::Vertex>& vertices, 
         std::vector<uint32_t>& indices, 
         std::vector<Mesh::Texture>& textures, 
-        bool embedded = false);
+        bool embedded = false,
+        bool upload = true);
+    Mesh(const Mesh::Vertex* vertices, const std::size_t _vertex_count,
+        const uint32_t* indices, const std::size_t _index_count,
+        std::vector<Mesh::Texture>& textures,
+        bool embedded = false,
+        bool upload = true);
 
     static uint32_t LoadTextureFromFile(const std::string _path, const std::string _directory, 
         bool gamma = false, bool flip_vertical = true, 
         GLenum texture_wrapping = GL_REPEAT, GLenum mipmap_filtering_min = GL_LINEAR_MIPMAP_LINEAR, 
         GLenum mipmap_filtering_max = GL_LINEAR);
     void Draw(Shader& shader);
-    void DrawInstanced(Shader& shader, const std::size_t _instance_size);
+    void DrawInstanced(Shader& shader, const std::size_t _instance_size, 
+        const std::size_t _base_instance = 0);
+    void SetupInstanceAttributes(const uint32_t _instance_vbo);
+    void Upload();
+    bool IsUploaded() const;
+    std::size_t GetTriangleCount() const;
 
 private:
     uint32_t vao_, vbo_, ebo_;
@@ -66,7 +87,8 @@ private:
     static const std::string _COLOR_AMBIENT_NAME_;
     static const std::string _COLOR_EMISSIVE_NAME_;
 
-    void setupMesh();
+    void setupMesh(const Mesh::Vertex* vertices, const std::size_t _vertex_count,
+        const uint32_t* indices, const std::size_t _index_count);
     void setupTextures(Shader& shader);
     void setupTexturesEmbedded(Shader& shader);
 };
\ No newline at end of file
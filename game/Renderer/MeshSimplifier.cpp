@@ -0,0 +1,461 @@
+#include "Renderer/MeshSimplifier.h"
+
+const double MeshSimplifier::_BOUNDARY_WEIGHT_ = 10.0;
+const double MeshSimplifier::_MIN_NORMAL_DOT_ = 0.2;
+const std::size_t MeshSimplifier::_MIN_TRIANGLES_ = 2;
+
+std::vector<MeshSimplifier::Level> MeshSimplifier::BuildChain(const std::vector<Mesh::Vertex>& vertices,
+    const std::vector<uint32_t>& indices, const std::vector<float>& _triangle_ratios)
+{
+    MeshSimplifier::State state;
+    weld(vertices, indices, state);
+    setupQuadrics(state);
+
+    std::vector<MeshSimplifier::Level> levels;
+    std::size_t source_triangles = state.live_triangles;
+    for (std::size_t i = 0; i < _triangle_ratios.size(); i++)
+    {
+        std::size_t target = std::max((std::size_t)std::ceil(_triangle_ratios.at(i) * (float)source_triangles),
+            _MIN_TRIANGLES_);
+
+        // Stale entries (one of the vertices moved or went away since it was
+        // queued) and collapses that would fold a triangle over are dropped.
+        //
+        while (state.live_triangles > target && !state.heap.empty())
+        {
+            MeshSimplifier::Collapse candidate = state.heap.top();
+            state.heap.pop();
+            collapse(state, candidate);
+        }
+        // Sampled at the source vertices, a later level can come out a bit
+        // lower than the one before, the chain has to stay monotonic.
+        //
+        levels.push_back(extract(state));
+        if (levels.size() > 1)
+        {
+            levels.back().error = std::max(levels.back().error, levels.at(levels.size() - 2).error);
+        }
+    }
+
+    return levels;
+}
+
+void MeshSimplifier::weld(const std::vector<Mesh::Vertex>& vertices, const std::vector<uint32_t>& indices,
+    MeshSimplifier::State& state)
+{
+    // Flat shaded meshes repeat every corner once per face normal, the
+    // simplification works on the surface, so those become one vertex.
+    //
+    std::map<std::tuple<float, float, float>, uint32_t> welded;
+    std::vector<uint32_t> remap(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); i++)
+    {
+        const glm::vec3& position = vertices.at(i).position;
+        std::tuple<float, float, float> key(position.x, position.y, position.z);
+        std::map<std::tuple<float, float, float>, uint32_t>::iterator found = welded.find(key);
+        if (found != welded.end())
+        {
+            remap.at(i) = found->second;
+            continue;
+        }
+
+        uint32_t id = (uint32_t)state.positions.size();
+        welded.emplace(key, id);
+        remap.at(i) = id;
+        state.positions.push_back(glm::dvec3(position));
+        state.source_positions.push_back(glm::dvec3(position));
+        state.texture_coords.push_back(vertices.at(i).texture_coords);
+    }
+
+    state.vertex_triangles.resize(state.positions.size());
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        uint32_t a = remap.at(indices.at(i));
+        uint32_t b = remap.at(indices.at(i + 1));
+        uint32_t c = remap.at(indices.at(i + 2));
+        if (a == b || b == c || a == c)
+        {
+            continue;
+        }
+
+        uint32_t triangle = (uint32_t)(state.triangles.size() / 3);
+        state.triangles.insert(state.triangles.end(), { a, b, c });
+        state.vertex_triangles.at(a).push_back(triangle);
+        state.vertex_triangles.at(b).push_back(triangle);
+        state.vertex_triangles.at(c).push_back(triangle);
+    }
+
+    state.triangle_alive.assign(state.triangles.size() / 3, true);
+    state.live_triangles = state.triangles.size() / 3;
+    state.quadrics.assign(state.positions.size(), MeshSimplifier::Quadric());
+    state.stamps.assign(state.positions.size(), 0);
+    state.removed.assign(state.positions.size(), false);
+}
+
+void MeshSimplifier::setupQuadrics(MeshSimplifier::State& state)
+{
+    // Every edge with the triangles that use it, an edge with a single
+    // triangle is on the border.
+    //
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>> edges;
+    for (uint32_t t = 0; t < (uint32_t)state.triangle_alive.size(); t++)
+    {
+        const uint32_t* corners = &state.triangles.at(t * 3);
+        glm::dvec3 normal = glm::cross(state.positions.at(corners[1]) - state.positions.at(corners[0]),
+            state.positions.at(corners[2]) - state.positions.at(corners[0]));
+        double length = glm::length(normal);
+        if (length > 0.0)
+        {
+            normal /= length;
+            MeshSimplifier::Quadric plane = planeQuadric(normal, -glm::dot(normal, state.positions.at(corners[0])), 1.0);
+            for (int k = 0; k < 3; k++)
+            {
+                addQuadric(state.quadrics.at(corners[k]), plane);
+            }
+        }
+
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t a = corners[k];
+            uint32_t b = corners[(k + 1) % 3];
+            edges[std::make_pair(std::min(a, b), std::max(a, b))].push_back(t);
+        }
+    }
+
+    for (std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>>::iterator it = edges.begin();
+        it != edges.end(); it++)
+    {
+        uint32_t a = it->first.first;
+        uint32_t b = it->first.second;
+        if (it->second.size() == 1)
+        {
+            const uint32_t* corners = &state.triangles.at(it->second.at(0) * 3);
+            glm::dvec3 face_normal = glm::cross(state.positions.at(corners[1]) - state.positions.at(corners[0]),
+                state.positions.at(corners[2]) - state.positions.at(corners[0]));
+            glm::dvec3 border_normal = glm::cross(state.positions.at(b) - state.positions.at(a), face_normal);
+            double length = glm::length(border_normal);
+            if (length > 0.0)
+            {
+                border_normal /= length;
+                MeshSimplifier::Quadric plane = planeQuadric(border_normal,
+                    -glm::dot(border_normal, state.positions.at(a)), _BOUNDARY_WEIGHT_);
+                addQuadric(state.quadrics.at(a), plane);
+                addQuadric(state.quadrics.at(b), plane);
+            }
+        }
+    }
+
+    for (std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>>::iterator it = edges.begin();
+        it != edges.end(); it++)
+    {
+        pushCollapse(state, it->first.first, it->first.second);
+    }
+}
+
+void MeshSimplifier::pushCollapse(MeshSimplifier::State& state, uint32_t a, uint32_t b)
+{
+    // The optimal position minimizes the combined quadric, when it can't be
+    // solved (flat or straight neighbourhoods) the best of the end points
+    // and the midpoint is taken.
+    //
+    MeshSimplifier::Quadric combined = state.quadrics.at(a);
+    addQuadric(combined, state.quadrics.at(b));
+
+    glm::dvec3 candidates[4] = { state.positions.at(a), state.positions.at(b),
+        (state.positions.at(a) + state.positions.at(b)) * 0.5, glm::dvec3(0.0) };
+    int candidate_count = optimalPosition(combined, candidates[3]) ? 4 : 3;
+
+    MeshSimplifier::Collapse collapse;
+    collapse.cost = std::numeric_limits<double>::max();
+    for (int i = 0; i < candidate_count; i++)
+    {
+        double cost = std::max(evaluate(combined, candidates[i]), 0.0);
+        if (cost < collapse.cost)
+        {
+            collapse.cost = cost;
+            collapse.target = candidates[i];
+        }
+    }
+
+    collapse.keep = a;
+    collapse.remove = b;
+    collapse.keep_stamp = state.stamps.at(a);
+    collapse.remove_stamp = state.stamps.at(b);
+    state.heap.push(collapse);
+}
+
+bool MeshSimplifier::collapse(MeshSimplifier::State& state, const MeshSimplifier::Collapse& candidate)
+{
+    uint32_t keep = candidate.keep;
+    uint32_t remove = candidate.remove;
+    if (state.removed.at(keep) || state.removed.at(remove) ||
+        state.stamps.at(keep) != candidate.keep_stamp || state.stamps.at(remove) != candidate.remove_stamp)
+    {
+        return false;
+    }
+
+    if (flips(state, keep, remove, candidate.target) || flips(state, remove, keep, candidate.target))
+    {
+        return false;
+    }
+
+    // Triangles on the collapsed edge disappear, the others around the
+    // removed vertex move over to the kept one.
+    //
+    state.positions.at(keep) = candidate.target;
+    addQuadric(state.quadrics.at(keep), state.quadrics.at(remove));
+    state.removed.at(remove) = true;
+    for (std::size_t i = 0; i < state.vertex_triangles.at(remove).size(); i++)
+    {
+        uint32_t t = state.vertex_triangles.at(remove).at(i);
+        if (!state.triangle_alive.at(t))
+        {
+            continue;
+        }
+
+        uint32_t* corners = &state.triangles.at(t * 3);
+        if (corners[0] == keep || corners[1] == keep || corners[2] == keep)
+        {
+            state.triangle_alive.at(t) = false;
+            state.live_triangles--;
+            continue;
+        }
+
+        for (int k = 0; k < 3; k++)
+        {
+            corners[k] = (corners[k] == remove) ? keep : corners[k];
+        }
+        state.vertex_triangles.at(keep).push_back(t);
+    }
+    state.vertex_triangles.at(remove).clear();
+
+    std::vector<uint32_t>& keep_triangles = state.vertex_triangles.at(keep);
+    keep_triangles.erase(std::remove_if(keep_triangles.begin(), keep_triangles.end(),
+        [&state](uint32_t t) { return !state.triangle_alive.at(t); }), keep_triangles.end());
+    state.stamps.at(keep)++;
+
+    // Every edge of the kept vertex changed cost, queue them again.
+    //
+    std::vector<uint32_t> neighbours;
+    for (std::size_t i = 0; i < keep_triangles.size(); i++)
+    {
+        const uint32_t* corners = &state.triangles.at(keep_triangles.at(i) * 3);
+        for (int k = 0; k < 3; k++)
+        {
+            if (corners[k] != keep && std::find(neighbours.begin(), neighbours.end(), corners[k]) == neighbours.end())
+            {
+                neighbours.push_back(corners[k]);
+            }
+        }
+    }
+    for (std::size_t i = 0; i < neighbours.size(); i++)
+    {
+        pushCollapse(state, keep, neighbours.at(i));
+    }
+
+    return true;
+}
+
+bool MeshSimplifier::flips(const MeshSimplifier::State& state, uint32_t vertex, uint32_t other,
+    const glm::dvec3& target)
+{
+    // Moving the vertex must not turn any of its remaining triangles over or
+    // squash it to nothing.
+    //
+    const std::vector<uint32_t>& triangles = state.vertex_triangles.at(vertex);
+    for (std::size_t i = 0; i < triangles.size(); i++)
+    {
+        uint32_t t = triangles.at(i);
+        const uint32_t* corners = &state.triangles.at(t * 3);
+        if (!state.triangle_alive.at(t) || corners[0] == other || corners[1] == other || corners[2] == other)
+        {
+            continue;
+        }
+
+        glm::dvec3 before[3], after[3];
+        for (int k = 0; k < 3; k++)
+        {
+            before[k] = state.positions.at(corners[k]);
+            after[k] = (corners[k] == vertex) ? target : before[k];
+        }
+
+        glm::dvec3 normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+        glm::dvec3 normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+        double length_before = glm::length(normal_before);
+        double length_after = glm::length(normal_after);
+        if (length_after <= 1e-12 * std::max(length_before, 1.0))
+        {
+            return true;
+        }
+        if (length_before > 0.0 &&
+            glm::dot(normal_before, normal_after) / (length_before * length_after) < _MIN_NORMAL_DOT_)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+MeshSimplifier::Level MeshSimplifier::extract(const MeshSimplifier::State& state)
+{
+    // The quadric costs overestimate the error (they add up the squared
+    // distances to every plane a vertex collected), the level error is
+    // measured against the simplified surface instead. The meshes are a few
+    // hundred triangles, brute force is fine at load time.
+    //
+    MeshSimplifier::Level level;
+    level.error = 0.0f;
+    for (std::size_t i = 0; i < state.source_positions.size(); i++)
+    {
+        level.error = std::max(level.error, (float)surfaceDistance(state, state.source_positions.at(i)));
+    }
+
+    level.vertices.reserve(state.live_triangles * 3);
+    level.indices.reserve(state.live_triangles * 3);
+
+    for (std::size_t t = 0; t < state.triangle_alive.size(); t++)
+    {
+        if (!state.triangle_alive.at(t))
+        {
+            continue;
+        }
+
+        const uint32_t* corners = &state.triangles.at(t * 3);
+        glm::vec3 positions[3] = { glm::vec3(state.positions.at(corners[0])),
+            glm::vec3(state.positions.at(corners[1])), glm::vec3(state.positions.at(corners[2])) };
+        glm::vec3 normal = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+        float length = glm::length(normal);
+        if (length <= 0.0f)
+        {
+            continue;
+        }
+
+        for (int k = 0; k < 3; k++)
+        {
+            Mesh::Vertex vertex = {};
+            vertex.position = positions[k];
+            vertex.normal = normal / length;
+            vertex.texture_coords = state.texture_coords.at(corners[k]);
+            level.indices.push_back((uint32_t)level.vertices.size());
+            level.vertices.push_back(vertex);
+        }
+    }
+
+    return level;
+}
+
+double MeshSimplifier::surfaceDistance(const MeshSimplifier::State& state, const glm::dvec3& point)
+{
+    double distance = std::numeric_limits<double>::max();
+    for (std::size_t t = 0; t < state.triangle_alive.size(); t++)
+    {
+        if (!state.triangle_alive.at(t))
+        {
+            continue;
+        }
+
+        const uint32_t* corners = &state.triangles.at(t * 3);
+        glm::dvec3 closest = closestOnTriangle(point, state.positions.at(corners[0]),
+            state.positions.at(corners[1]), state.positions.at(corners[2]));
+        distance = std::min(distance, glm::length(point - closest));
+    }
+
+    return (distance == std::numeric_limits<double>::max()) ? 0.0 : distance;
+}
+
+glm::dvec3 MeshSimplifier::closestOnTriangle(const glm::dvec3& p, const glm::dvec3& a,
+    const glm::dvec3& b, const glm::dvec3& c)
+{
+    // Voronoi regions of the corners and edges, then the face (Ericson,
+    // Real-Time Collision Detection 5.1.5).
+    //
+    glm::dvec3 ab = b - a, ac = c - a, ap = p - a;
+    double d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0)
+    {
+        return a;
+    }
+
+    glm::dvec3 bp = p - b;
+    double d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3)
+    {
+        return b;
+    }
+
+    double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+    {
+        return a + ab * (d1 / (d1 - d3));
+    }
+
+    glm::dvec3 cp = p - c;
+    double d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6)
+    {
+        return c;
+    }
+
+    double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+    {
+        return a + ac * (d2 / (d2 - d6));
+    }
+
+    double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+    {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    double denominator = va + vb + vc;
+    if (denominator == 0.0)
+    {
+        return a;
+    }
+    return a + ab * (vb / denominator) + ac * (vc / denominator);
+}
+
+MeshSimplifier::Quadric MeshSimplifier::planeQuadric(const glm::dvec3& normal, double distance, double weight)
+{
+    double a = normal.x, b = normal.y, c = normal.z, d = distance;
+    MeshSimplifier::Quadric q = { {
+        a * a * weight, a * b * weight, a * c * weight, a * d * weight,
+        b * b * weight, b * c * weight, b * d * weight,
+        c * c * weight, c * d * weight,
+        d * d * weight
+    } };
+    return q;
+}
+
+void MeshSimplifier::addQuadric(MeshSimplifier::Quadric& to, const MeshSimplifier::Quadric& from)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        to.m[i] += from.m[i];
+    }
+}
+
+double MeshSimplifier::evaluate(const MeshSimplifier::Quadric& q, const glm::dvec3& p)
+{
+    return q.m[0] * p.x * p.x + 2.0 * q.m[1] * p.x * p.y + 2.0 * q.m[2] * p.x * p.z + 2.0 * q.m[3] * p.x +
+        q.m[4] * p.y * p.y + 2.0 * q.m[5] * p.y * p.z + 2.0 * q.m[6] * p.y +
+        q.m[7] * p.z * p.z + 2.0 * q.m[8] * p.z +
+        q.m[9];
+}
+
+bool MeshSimplifier::optimalPosition(const MeshSimplifier::Quadric& q, glm::dvec3& position)
+{
+    glm::dmat3 a(q.m[0], q.m[1], q.m[2],
+        q.m[1], q.m[4], q.m[5],
+        q.m[2], q.m[5], q.m[7]);
+    double determinant = glm::determinant(a);
+    if (std::abs(determinant) < 1e-10)
+    {
+        return false;
+    }
+
+    position = glm::inverse(a) * -glm::dvec3(q.m[3], q.m[6], q.m[8]);
+    return true;
+}
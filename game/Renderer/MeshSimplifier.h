@@ -0,0 +1,102 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+#include "Renderer/Mesh.h"
+
+// Quadric error mesh simplification (Garland and Heckbert). Vertices are
+// welded by position, every vertex accumulates the planes of the triangles
+// around it and the cheapest edge is collapsed until the triangle count
+// reaches the target. Open borders get an extra plane perpendicular to the
+// border triangle so the outline doesn't shrink.
+//
+// One pass produces the whole chain, the mesh is copied out every time it
+// reaches the next triangle ratio, so every level is a simplification of
+// the previous one. The error of a level is the largest distance from a
+// source vertex to the simplified surface, in model units. The models are
+// flat shaded, so the levels are written out with one face normal per
+// triangle.
+//
+class MeshSimplifier
+{
+public:
+    struct Level
+    {
+        std::vector<Mesh::Vertex> vertices;
+        std::vector<uint32_t> indices;
+        float error;
+    };
+
+    static std::vector<MeshSimplifier::Level> BuildChain(const std::vector<Mesh::Vertex>& vertices,
+        const std::vector<uint32_t>& indices, const std::vector<float>& _triangle_ratios);
+
+private:
+    // Symmetric 4x4 matrix, upper triangle row by row.
+    //
+    struct Quadric
+    {
+        double m[10];
+    };
+
+    struct Collapse
+    {
+        double cost;
+        uint32_t keep;
+        uint32_t remove;
+        uint32_t keep_stamp;
+        uint32_t remove_stamp;
+        glm::dvec3 target;
+
+        bool operator>(const Collapse& other) const
+        {
+            return cost > other.cost;
+        }
+    };
+
+    struct State
+    {
+        std::vector<glm::dvec3> positions;
+        std::vector<glm::dvec3> source_positions;
+        std::vector<glm::vec2> texture_coords;
+        std::vector<Quadric> quadrics;
+        std::vector<uint32_t> stamps;
+        std::vector<bool> removed;
+        std::vector<std::vector<uint32_t>> vertex_triangles;
+        std::vector<uint32_t> triangles;
+        std::vector<bool> triangle_alive;
+        std::size_t live_triangles;
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+    };
+
+    static const double _BOUNDARY_WEIGHT_;
+    static const double _MIN_NORMAL_DOT_;
+    static const std::size_t _MIN_TRIANGLES_;
+
+    MeshSimplifier();
+
+    static void weld(const std::vector<Mesh::Vertex>& vertices, const std::vector<uint32_t>& indices,
+        MeshSimplifier::State& state);
+    static void setupQuadrics(MeshSimplifier::State& state);
+    static void pushCollapse(MeshSimplifier::State& state, uint32_t a, uint32_t b);
+    static bool collapse(MeshSimplifier::State& state, const MeshSimplifier::Collapse& candidate);
+    static bool flips(const MeshSimplifier::State& state, uint32_t vertex, uint32_t other,
+        const glm::dvec3& target);
+    static MeshSimplifier::Level extract(const MeshSimplifier::State& state);
+    static double surfaceDistance(const MeshSimplifier::State& state, const glm::dvec3& point);
+    static glm::dvec3 closestOnTriangle(const glm::dvec3& p, const glm::dvec3& a,
+        const glm::dvec3& b, const glm::dvec3& c);
+
+    static MeshSimplifier::Quadric planeQuadric(const glm::dvec3& normal, double distance, double weight);
+    static void addQuadric(MeshSimplifier::Quadric& to, const MeshSimplifier::Quadric& from);
+    static double evaluate(const MeshSimplifier::Quadric& q, const glm::dvec3& p);
+    static bool optimalPosition(const MeshSimplifier::Quadric& q, glm::dvec3& position);
+};
@@ -1,22 +1,46 @@
 #include "Renderer/Model.h"
 
+const std::string Model::_CACHE_DIRECTORY_ = "Cache/Models/";
+const std::vector<float> Model::_LOD_TRIANGLE_RATIOS_ = { 0.5f, 0.25f, 0.125f };
+std::mutex Model::logger_mutex_;
+uint32_t Model::logger_users_ = 0;
+
 Model::Model(const std::string _path,
 	bool embedded,
-	bool gamma) :
+	bool gamma,
+	bool upload,
+	TextureLoader* texture_loader) :
 	textures_embedded_(embedded),
-	gamma_correction_(gamma)
+	gamma_correction_(gamma),
+	texture_loader_(texture_loader),
+	lods_generated_(false),
+	uploaded_(upload)
 {
 	double time = glfwGetTime();
-	std::cout << "INFO::MODEL::MODEL::BEGIN_LOAD" << std::endl;
-	std::cout << "INFO::MODEL::LOAD_MODEL::ASSIMP_LOG" << std::endl;
-	
-	// Create logger and attach it to the default output stream.
+	std::cout << "INFO::MODEL::MODEL::BEGIN_LOAD::" << _path << std::endl;
+
+	// Warm start: the baked meshes of an unchanged source are mapped and 
+	// uploaded without going through Assimp. Only models with embedded
+	// material colors are baked, texture files still go through stb_image.
 	//
-	Assimp::DefaultLogger::create(NULL, Assimp::Logger::VERBOSE, aiDefaultLogStream_STDOUT);
-	
-	loadModel(_path);
+	uint64_t source_hash = textures_embedded_ ? MeshCache::SourceHash(_path) : 0;
+	bool warm = (source_hash != 0) && loadCache(_path, source_hash);
+	if (!warm)
+	{
+		// Only warnings and errors, the verbose log of every import step
+		// cost more than some of the imports.
+		//
+		acquireLogger();
+		loadModel(_path);
+		releaseLogger();
 
-	std::cout << "INFO::MODEL::MODEL::END_LOAD" << std::endl;
+		if (source_hash != 0 && !meshes_.empty())
+		{
+			writeCache(_path, source_hash);
+		}
+	}
+
+	std::cout << "INFO::MODEL::MODEL::END_LOAD::" << (warm ? "WARM" : "COLD") << std::endl;
 	std::cout << "Load took:" << (glfwGetTime() - time) * 1000 << "ms" << std::endl;
 }
 
@@ -28,48 +52,384 @@ void Model::Draw(Shader& shader)
 	}
 }
 
-void Model::DrawInstanced(Shader& shader, std::vector<glm::mat4>& instance_mod_mats)
+void Model::DrawInstanced(Shader& shader)
 {
-	std::size_t instance_size = instance_mod_mats.size();
+	if (!instance_buffer_ || instance_buffer_->GetCount() == 0)
+	{
+		return;
+	}
 
-	uint32_t mat_vbo_id;
-	glGenBuffers(1, &mat_vbo_id);
-	glBindBuffer(GL_ARRAY_BUFFER, mat_vbo_id);
-	glBufferData(GL_ARRAY_BUFFER, instance_size * sizeof(glm::mat4), &instance_mod_mats[0], GL_STATIC_DRAW);
+	if (lod_counts_.empty())
+	{
+		for (std::size_t i = 0; i < meshes_.size(); i++)
+		{
+			meshes_[i].DrawInstanced(shader, instance_buffer_->GetCount());
+		}
+		return;
+	}
 
-	for (std::size_t i = 0; i < meshes_.size(); i++)
+	// One draw per mesh and level, each level reads its own range of the
+	// instance buffer.
+	//
+	uint32_t base_instance = 0;
+	for (uint32_t lod = 0; lod < (uint32_t)lod_counts_.size(); lod++)
+	{
+		uint32_t count = std::min(lod_counts_.at(lod), instance_buffer_->GetCount() - base_instance);
+		if (count > 0)
+		{
+			std::vector<Mesh>& meshes = getLodMeshes(lod);
+			for (std::size_t i = 0; i < meshes.size(); i++)
+			{
+				meshes[i].DrawInstanced(shader, count, base_instance);
+			}
+		}
+		base_instance += count;
+	}
+}
+
+void Model::Upload()
+{
+	// The LOD levels generated so far go up with the full model, later ones
+	// are created uploaded.
+	//
+	if (uploaded_)
 	{
-		meshes_[i].DrawInstanced(shader, instance_size);
+		return;
 	}
+	uploaded_ = true;
+
+	for (uint32_t lod = 0; lod < GetLodCount(); lod++)
+	{
+		std::vector<Mesh>& meshes = getLodMeshes(lod);
+		for (std::size_t i = 0; i < meshes.size(); i++)
+		{
+			meshes[i].Upload();
+		}
+	}
+}
+
+bool Model::IsUploaded() const
+{
+	return uploaded_;
+}
+
+void Model::SetInstances(const std::vector<Instance>& instances)
+{
+	setupInstanceBuffer();
+	instance_buffer_->Data(instances);
+	lod_counts_.clear();
+}
+
+void Model::SetInstances(const std::vector<Instance>& instances, 
+	const std::vector<uint32_t>& lod_counts)
+{
+	// instances holds the instances of LOD 0 first, then LOD 1 and so on, 
+	// lod_counts tells how many each level has.
+	//
+	setupInstanceBuffer();
+	instance_buffer_->Data(instances);
+	lod_counts_.assign(lod_counts.begin(), lod_counts.begin() + std::min(lod_counts.size(), (std::size_t)GetLodCount()));
+}
+
+void Model::UpdateInstances(const std::vector<Instance>& instances, 
+	uint32_t dirty_start)
+{
+	setupInstanceBuffer();
+	instance_buffer_->SubData(instances, dirty_start);
+}
+
+void Model::SetInstance(const Instance& instance, uint32_t index)
+{
+	setupInstanceBuffer();
+	instance_buffer_->SubData(instance, index);
+}
 
-	// This is important to avoid infinite memory allocation!
+void Model::SetInstanceCount(uint32_t count)
+{
+	// The level ranges no longer match the buffer, draw it at LOD 0.
 	//
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glDeleteBuffers(1, &mat_vbo_id);
+	setupInstanceBuffer();
+	instance_buffer_->SetCount(count);
+	lod_counts_.clear();
 }
 
-void Model::DrawInstanced(Shader& shader, std::shared_ptr<std::vector<glm::mat4>> instance_mod_mats)
+uint32_t Model::GetInstanceCount() const
 {
-	std::size_t instance_size = instance_mod_mats->size();
+	return instance_buffer_ ? instance_buffer_->GetCount() : 0;
+}
 
-	uint32_t mat_vbo_id;
-	glGenBuffers(1, &mat_vbo_id);
-	glBindBuffer(GL_ARRAY_BUFFER, mat_vbo_id);
-	glBufferData(GL_ARRAY_BUFFER, instance_size * sizeof(glm::mat4), instance_mod_mats->data(), GL_STATIC_DRAW);
+void Model::GenerateLods()
+{
+	PROFILE_SCOPE("Model::GenerateLods");
+	if (lods_generated_)
+	{
+		return;
+	}
+	lods_generated_ = true;
 
+	double time = glfwGetTime();
+	std::vector<std::vector<MeshSimplifier::Level>> chains;
 	for (std::size_t i = 0; i < meshes_.size(); i++)
 	{
-		meshes_[i].DrawInstanced(shader, instance_size);
+		chains.push_back(MeshSimplifier::BuildChain(meshes_.at(i).vertices_, meshes_.at(i).indices_, 
+			_LOD_TRIANGLE_RATIOS_));
+	}
+
+	// A level of the model is the same level of every mesh. Levels that 
+	// didn't get below the previous triangle count (the meshes are already
+	// as coarse as they go) are dropped.
+	//
+	std::size_t previous_triangles = GetTriangleCount(0);
+	for (std::size_t level = 0; level < _LOD_TRIANGLE_RATIOS_.size(); level++)
+	{
+		Model::Lod lod;
+		lod.error = 0.0f;
+		std::size_t triangles = 0;
+		for (std::size_t i = 0; i < chains.size(); i++)
+		{
+			triangles += chains.at(i).at(level).indices.size() / 3;
+		}
+		if (triangles >= previous_triangles)
+		{
+			break;
+		}
+
+		for (std::size_t i = 0; i < chains.size(); i++)
+		{
+			MeshSimplifier::Level& simplified = chains.at(i).at(level);
+			lod.meshes.push_back(Mesh(simplified.vertices, simplified.indices, meshes_.at(i).textures_, 
+				textures_embedded_, uploaded_));
+			lod.error = std::max(lod.error, simplified.error);
+			if (instance_buffer_)
+			{
+				lod.meshes.back().SetupInstanceAttributes(instance_buffer_->GetId());
+			}
+		}
+		lods_.push_back(lod);
+		previous_triangles = triangles;
+	}
+
+	std::cout << "INFO::MODEL::GENERATE_LODS::" << GetLodCount() << "_LEVELS" << std::endl;
+	for (uint32_t lod = 0; lod < GetLodCount(); lod++)
+	{
+		std::cout << "LOD " << lod << " triangles:" << GetTriangleCount(lod) << " error:" << GetLodError(lod) << std::endl;
+	}
+	std::cout << "Generation took:" << (glfwGetTime() - time) * 1000 << "ms" << std::endl;
+}
+
+uint32_t Model::GetLodCount() const
+{
+	return (uint32_t)lods_.size() + 1;
+}
+
+float Model::GetLodError(uint32_t lod) const
+{
+	return (lod == 0 || lod > lods_.size()) ? 0.0f : lods_.at(lod - 1).error;
+}
+
+std::size_t Model::GetTriangleCount(uint32_t lod) const
+{
+	const std::vector<Mesh>& meshes = (lod == 0 || lod > lods_.size()) ? meshes_ : lods_.at(lod - 1).meshes;
+	std::size_t triangles = 0;
+	for (std::size_t i = 0; i < meshes.size(); i++)
+	{
+		triangles += meshes.at(i).GetTriangleCount();
+	}
+	return triangles;
+}
+
+std::size_t Model::GetDrawnTriangleCount() const
+{
+	// An impostor is two triangles.
+	//
+	std::size_t triangles = impostor_ ? impostor_->GetInstanceCount() * 2 : 0;
+	uint32_t instances = GetInstanceCount();
+	if (lod_counts_.empty())
+	{
+		return triangles + instances * GetTriangleCount(0);
+	}
+
+	for (uint32_t lod = 0; lod < (uint32_t)lod_counts_.size() && instances > 0; lod++)
+	{
+		uint32_t count = std::min(lod_counts_.at(lod), instances);
+		triangles += count * GetTriangleCount(lod);
+		instances -= count;
+	}
+	return triangles;
+}
+
+void Model::GenerateImpostor(Shader& bake_shader)
+{
+	if (impostor_ || meshes_.empty())
+	{
+		return;
+	}
+
+	impostor_ = std::make_shared<Impostor>(meshes_, bake_shader);
+}
+
+bool Model::HasImpostor() const
+{
+	return impostor_ != nullptr;
+}
+
+void Model::SetImpostorInstances(const std::vector<Instance>& instances)
+{
+	if (impostor_)
+	{
+		impostor_->SetInstances(instances);
+	}
+}
+
+void Model::DrawImpostors(Shader& shader)
+{
+	if (impostor_)
+	{
+		impostor_->DrawInstanced(shader);
 	}
+}
 
-	// This is important to avoid infinite memory allocation!
+std::size_t Model::GetMemoryFootprint() const
+{
+	// CPU side copies of the mesh data, every copy of a Model holds its own.
 	//
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glDeleteBuffers(1, &mat_vbo_id);
+	std::size_t bytes = sizeof(Model);
+	for (const Mesh& mesh : meshes_)
+	{
+		bytes += sizeof(Mesh);
+		bytes += mesh.vertices_.size() * sizeof(Mesh::Vertex);
+		bytes += mesh.indices_.size() * sizeof(uint32_t);
+		bytes += mesh.textures_.size() * sizeof(Mesh::Texture);
+	}
+	for (const Model::Lod& lod : lods_)
+	{
+		for (const Mesh& mesh : lod.meshes)
+		{
+			bytes += sizeof(Mesh);
+			bytes += mesh.vertices_.size() * sizeof(Mesh::Vertex);
+			bytes += mesh.indices_.size() * sizeof(uint32_t);
+		}
+	}
+
+	return bytes;
+}
+
+void Model::setupInstanceBuffer()
+{
+	if (instance_buffer_)
+	{
+		return;
+	}
+
+	// The instance buffer is shared between copies of the model (entities hold 
+	// copies), and deleted once the last copy goes away.
+	//
+	instance_buffer_ = std::make_shared<InstanceBuffer<Instance>>();
+	for (uint32_t lod = 0; lod < GetLodCount(); lod++)
+	{
+		std::vector<Mesh>& meshes = getLodMeshes(lod);
+		for (std::size_t i = 0; i < meshes.size(); i++)
+		{
+			meshes[i].SetupInstanceAttributes(instance_buffer_->GetId());
+		}
+	}
+}
+
+void Model::acquireLogger()
+{
+	std::lock_guard<std::mutex> lock(logger_mutex_);
+	if (logger_users_++ == 0)
+	{
+		Assimp::DefaultLogger::create(NULL, Assimp::Logger::NORMAL, aiDefaultLogStream_STDOUT);
+	}
+}
+
+void Model::releaseLogger()
+{
+	std::lock_guard<std::mutex> lock(logger_mutex_);
+	if (--logger_users_ == 0)
+	{
+		Assimp::DefaultLogger::kill();
+	}
+}
+
+std::vector<Mesh>& Model::getLodMeshes(uint32_t lod)
+{
+	return (lod == 0 || lod > lods_.size()) ? meshes_ : lods_.at(lod - 1).meshes;
+}
+
+bool Model::loadCache(const std::string _path, const uint64_t _source_hash)
+{
+	PROFILE_SCOPE("Model::loadCache");
+	std::string cache_path = MeshCache::CachePath(_CACHE_DIRECTORY_, _path);
+	std::shared_ptr<MappedFile> file = MeshCache::Open(cache_path, _source_hash, sizeof(Mesh::Vertex));
+	if (!file)
+	{
+		return false;
+	}
+
+	std::vector<MeshCache::MeshData> meshes = MeshCache::GetMeshes(*file);
+	for (std::size_t i = 0; i < meshes.size(); i++)
+	{
+		const MeshCache::MeshData& mesh = meshes.at(i);
+
+		std::vector<Mesh::Texture> textures;
+		for (std::size_t j = 0; j < mesh.material_count; j++)
+		{
+			Mesh::Texture texture;
+			texture.id = 0;
+			texture.color = mesh.materials[j].color;
+			texture.type = (TEXTYPEenum)mesh.materials[j].type;
+			texture.format = (TEXFORMATenum)mesh.materials[j].format;
+			textures.push_back(texture);
+		}
+
+		// The mapping is handed to glBufferData as it is and closed when
+		// this returns.
+		//
+		meshes_.push_back(Mesh((const Mesh::Vertex*)mesh.vertices, (std::size_t)mesh.vertex_count,
+			mesh.indices, (std::size_t)mesh.index_count, textures, textures_embedded_, uploaded_));
+	}
+
+	directory_ = _path.substr(0, _path.find_last_of('/') + 1);
+	return true;
+}
+
+void Model::writeCache(const std::string _path, const uint64_t _source_hash)
+{
+	std::vector<std::vector<MeshCache::Material>> materials(meshes_.size());
+	std::vector<MeshCache::MeshData> meshes(meshes_.size());
+	for (std::size_t i = 0; i < meshes_.size(); i++)
+	{
+		const Mesh& mesh = meshes_.at(i);
+		for (std::size_t j = 0; j < mesh.textures_.size(); j++)
+		{
+			MeshCache::Material material = {};
+			material.color = mesh.textures_.at(j).color;
+			material.type = (uint32_t)mesh.textures_.at(j).type;
+			material.format = (uint32_t)mesh.textures_.at(j).format;
+			materials.at(i).push_back(material);
+		}
+
+		meshes.at(i).vertices = mesh.vertices_.data();
+		meshes.at(i).vertex_count = mesh.vertices_.size();
+		meshes.at(i).indices = mesh.indices_.data();
+		meshes.at(i).index_count = mesh.indices_.size();
+		meshes.at(i).materials = materials.at(i).data();
+		meshes.at(i).material_count = materials.at(i).size();
+	}
+
+	std::string cache_path = MeshCache::CachePath(_CACHE_DIRECTORY_, _path);
+	if (!MeshCache::Write(cache_path, _source_hash, sizeof(Mesh::Vertex), meshes))
+	{
+		std::cout << "ERROR::MODEL::WRITE_CACHE::FAILED::" << cache_path << std::endl;
+	}
 }
 
 void Model::loadModel(const std::string _path)
 {
+	PROFILE_SCOPE("Model::loadModel");
+
 	// Create the importer.
 	//
 	Assimp::Importer importer;
@@ -252,7 +612,7 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* _scene)
 		}
 	}
 
-	return Mesh(vertices, indices, textures, textures_embedded_);
+	return Mesh(vertices, indices, textures, textures_embedded_, uploaded_);
 }
 
 std::vector<Mesh::Texture> Model::loadMaterialTextures(aiMaterial* material, aiTextureType ai_type,
@@ -282,7 +642,15 @@ std::vector<Mesh::Texture> Model::loadMaterialTextures(aiMaterial* material, aiT
 		if (!already_loaded)
 		{
 			Mesh::Texture texture;
-			texture.id = Mesh::LoadTextureFromFile(std::string(path.C_Str()), directory_, gamma_correction_);
+			if (texture_loader_ != nullptr)
+			{
+				texture.id = 0;
+				texture.handle = texture_loader_->LoadTexture(directory_ + "/" + path.C_Str());
+			}
+			else
+			{
+				texture.id = Mesh::LoadTextureFromFile(std::string(path.C_Str()), directory_, gamma_correction_);
+			}
 			texture.type = tx_type;
 			texture.path = path.C_Str();
 			textures.push_back(texture);
@@ -6,6 +6,7 @@
 #include <map>
 #include <fstream>
 #include <sstream>
+#include <mutex>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -19,7 +20,23 @@
 
 #include "Renderer/Shader.h"
 #include "Renderer/Mesh.h"
+#include "Renderer/MeshSimplifier.h"
+#include "Renderer/Impostor.h"
+#include "Buffers/InstanceBuffer.h"
+#include "Cache/MeshCache.h"
+#include "Profiler/Profiler.h"
 
+// meshes_ is the full resolution model (LOD 0). GenerateLods adds coarser
+// levels next to it, instanced draws then take the instances of every level
+// from consecutive ranges of the one instance buffer (see SetInstances).
+// GenerateImpostor bakes a far field impostor with its own instance set.
+//
+// A model loaded with upload false is parsed (and can generate its LODs)
+// on any thread without touching GL, Upload then creates the GL objects of
+// every level on the context thread. Texture files need a texture loader
+// for that, without one they are loaded through GL while parsing, so only
+// models with embedded material colors could defer the upload.
+//
 class Model
 {
 public:
@@ -27,18 +44,71 @@ public:
     
     Model(const std::string _path, 
         bool embedded = false, 
-        bool gamma = false);
+        bool gamma = false,
+        bool upload = true,
+        TextureLoader* texture_loader = nullptr);
 
     void Draw(Shader& shader);
-    void DrawInstanced(Shader& shader, std::vector<glm::mat4>& instance_mod_mats);
-    void DrawInstanced(Shader& shader, std::shared_ptr<std::vector<glm::mat4>> instance_mod_mats);
+    void DrawInstanced(Shader& shader);
+    void Upload();
+    bool IsUploaded() const;
+    void SetInstances(const std::vector<Instance>& instances);
+    void SetInstances(const std::vector<Instance>& instances, 
+        const std::vector<uint32_t>& lod_counts);
+    void UpdateInstances(const std::vector<Instance>& instances, 
+        uint32_t dirty_start);
+    void SetInstance(const Instance& instance, uint32_t index);
+    void SetInstanceCount(uint32_t count);
+    uint32_t GetInstanceCount() const;
+    void GenerateLods();
+    uint32_t GetLodCount() const;
+    float GetLodError(uint32_t lod) const;
+    std::size_t GetTriangleCount(uint32_t lod) const;
+    std::size_t GetDrawnTriangleCount() const;
+    void GenerateImpostor(Shader& bake_shader);
+    bool HasImpostor() const;
+    void SetImpostorInstances(const std::vector<Instance>& instances);
+    void DrawImpostors(Shader& shader);
+    std::size_t GetMemoryFootprint() const;
 
 private:
+    struct Lod
+    {
+        std::vector<Mesh> meshes;
+        float error;
+    };
+
     std::string directory_;
     bool gamma_correction_;
     bool textures_embedded_;
     std::vector<Mesh::Texture> textures_loaded_;
+    TextureLoader* texture_loader_;
+    std::shared_ptr<InstanceBuffer<Instance>> instance_buffer_;
+    std::vector<Model::Lod> lods_;
+    bool lods_generated_;
+    bool uploaded_;
+    std::shared_ptr<Impostor> impostor_;
+
+    // Instances per LOD level, in instance buffer order. Empty when the 
+    // whole buffer is drawn at LOD 0.
+    //
+    std::vector<uint32_t> lod_counts_;
+
+    static const std::string _CACHE_DIRECTORY_;
+    static const std::vector<float> _LOD_TRIANGLE_RATIOS_;
+
+    // Assimp's logger is global, imports running in parallel share it.
+    //
+    static std::mutex logger_mutex_;
+    static uint32_t logger_users_;
+
+    static void acquireLogger();
+    static void releaseLogger();
 
+    void setupInstanceBuffer();
+    std::vector<Mesh>& getLodMeshes(uint32_t lod);
+    bool loadCache(const std::string _path, const uint64_t _source_hash);
+    void writeCache(const std::string _path, const uint64_t _source_hash);
     void loadModel(const std::string _path);
     void processNode(aiNode* node, const aiScene* _scene);
     Mesh processMesh(aiMesh* mesh, const aiScene* _scene);
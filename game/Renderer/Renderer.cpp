@@ -1,81 +1,175 @@
 #include "Renderer/Renderer.h"
 
+const double Renderer::_BENCHMARK_TIME_STEP_ = 1.0 / 60.0;
+const std::string Renderer::_PASS_TIMES_PATH_ = "gpu_passes.csv";
+const std::string Renderer::_TRACE_PATH_ = "trace.json";
+const float Renderer::_PICKUP_STEP_ = 0.25f;
+
 Renderer::Renderer(Window& window) :
     window_(window),
     delta_time_(0.0),
     last_frame_(0.0),
     first_mouse_(true),
     last_x_((float)window.GetWidth() / 2.0f),
-    last_y_((float)window.GetHeight() / 2.0f)
+    last_y_((float)window.GetHeight() / 2.0f),
+    ubo_matrices_(3, 0),
+    ubo_camera_(1, 1),
+    ubo_light_(1, 2),
+    export_key_down_(false),
+    trace_key_down_(false)
 {
 	setupInput(GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 	setupGlobalEnables();
 }
 
-void Renderer::Render(Camera& camera, Player& player, GameWorld& world)
+void Renderer::Render(Camera& camera, Player& player, GameWorld& world, 
+	CameraPath* recording)
 {
-	UniformBuffer<glm::mat4> ubo_matrices(3, 0);
-	UniformBuffer<glm::vec3> ubo_camera(1, 1);
-	UniformBuffer<glm::vec3> ubo_light(1, 2);
-
+	// With a recording path every frame's player pose is appended to it, 
+	// it can be replayed by RenderBenchmark.
+	//
+	// Movement, pickups and the round timer follow the simulation's fixed 
+	// time step, a frame only hands it the input and shows its state.
+	//
 	ImGui::StyleColorsDark();
-	ImGuiWindowFlags imgui_flags = ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoTitleBar | 
-		ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoResize;
-
 	ProcessMouse(camera, player, window_.GetWindow(), last_x_, last_y_);
 	player.UpdateBoundingBox();
 	player.SetTimeLimit(300.0);
 
+	Simulation simulation(world, player.position_);
+	Simulation::State last_tick = simulation.GetSnapshot().current;
+	simulation.Start();
+
+	double start_time = glfwGetTime();
+	bool first_frame = true;
 	while (!window_.GetWindowShouldClose())
 	{
+		PROFILE_SCOPE("Renderer::Frame");
 		clearFramebuffers();
 		processFrametime();
-		processKeyboard(camera, player, world);
-		world.RemoveCollectibles(world.quad_tree_.Query(player.GetBoundingBox()), player);
-		player.UpdateTimeRemaining(delta_time_);
+		{
+			PROFILE_SCOPE("Renderer::Input");
+			processKeyboard(player, simulation);
+		}
+		applySimulation(camera, player, world, simulation, last_tick);
+		if (recording != nullptr)
+		{
+			recording->AddKeyframe((float)(glfwGetTime() - start_time), player.position_, camera.yaw_);
+		}
+		renderFrame(camera, player, world);
 
-		ImGui_ImplOpenGL3_NewFrame();
-		ImGui_ImplGlfw_NewFrame();
-		ImGui::NewFrame();
+		PROFILE_SCOPE("Renderer::Swap");
+		glfwSwapBuffers(window_.GetWindow());
+		glfwPollEvents();
 
-		glm::mat4 view = camera.GetViewMatrix();
-		glm::mat4 view_3 = camera.GetViewMatrix3();
-		glm::mat4 projection = camera.GetProjectionMatrix();
+		// Time to the first interactive frame, counted from glfwInit (the 
+		// window is the first thing main creates).
+		//
+		if (first_frame)
+		{
+			std::cout << "INFO::RENDERER::RENDER::FIRST_FRAME::" << (int)(start_time * 1000.0) << "_MS_TO_START_" << 
+				(int)(glfwGetTime() * 1000.0) << "_MS_TO_FIRST_FRAME" << std::endl;
+			first_frame = false;
+		}
+	}
 
-		ubo_matrices.Data(projection, 0);
-		ubo_matrices.Data(view, 1);
-		ubo_matrices.Data(view_3, 2);
-		ubo_camera.Data(camera.position_, 0);
-		ubo_light.Data(world.GetSunPosition(), 0);
-
-		ImGui::Begin("Score", 0, imgui_flags);
-		ImGui::Text(player.GetScorePretty().c_str());
-		ImGui::Text(player.GetTimeRemainingPretty().c_str());
-		ImGui::SetWindowPos(ImVec2(0.f, 0.f));
-		ImGui::SetWindowSize(ImVec2(200.f, 75.f));
-		ImGui::End();
-
-		ImGui::Begin("Stats", 0, imgui_flags);
-		ImGui::SetWindowFontScale(0.5f);
-		ImGui::Text(getFps().c_str());
-		ImGui::Text(getFrametime().c_str());
-		ImGui::SetWindowPos(ImVec2(window_.GetWidth() - 200.f, window_.GetHeight() - 75.f));
-		ImGui::SetWindowSize(ImVec2(200.f, 75.f));
-		ImGui::End();
-		ImGui::Render();
-
-		world.Draw();
-		player.Draw();
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	simulation.Stop();
+	shutdown();
+}
 
-		glfwSwapBuffers(window_.GetWindow());
+void Renderer::RenderBenchmark(Camera& camera, Player& player, GameWorld& world, 
+	CameraPath& path, uint32_t frame_count, const std::string _output_prefix)
+{
+	// Replays the path with a fixed time step, so frame N always shows the 
+	// same view. Frames go to an offscreen framebuffer. CPU time is the 
+	// frame's update and draw submission, GPU time comes from a pair of 
+	// timestamp queries around the same frame, read back after the run so 
+	// the queries never stall the pipeline. Timestamps because the passes 
+	// inside the frame are timed with elapsed time queries, which can't 
+	// nest, they go to PREFIX_passes.csv.
+	//
+	ImGui::StyleColorsDark();
+	FrameBuffer frame_buffer(window_.GetWidth(), window_.GetHeight());
+	if (!frame_buffer.IsComplete())
+	{
+		std::cout << "ERROR::RENDERER::RENDER_BENCHMARK::FRAMEBUFFER_INCOMPLETE" << std::endl;
+		shutdown();
+		return;
+	}
+
+	std::vector<uint32_t> queries(2 * frame_count);
+	std::vector<double> cpu_ms(frame_count);
+	std::vector<std::size_t> triangles(frame_count);
+	glGenQueries((GLsizei)queries.size(), queries.data());
+	gpu_timer_.SetHistoryLength(frame_count);
+	player.SetTimeLimit(300.0);
+	delta_time_ = _BENCHMARK_TIME_STEP_;
+
+	std::cout << "INFO::RENDERER::RENDER_BENCHMARK::START_" << frame_count << "_FRAMES" << std::endl;
+	for (uint32_t frame = 0; frame < frame_count; frame++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		PROFILE_SCOPE("Renderer::Frame");
+		glQueryCounter(queries.at(2 * frame), GL_TIMESTAMP);
+
+		frame_buffer.Bind();
+		clearFramebuffers();
+		float duration = std::max(path.GetDuration(), (float)_BENCHMARK_TIME_STEP_);
+		applyPathPose(camera, player, world, path.Sample(std::fmod((float)(frame * _BENCHMARK_TIME_STEP_), duration)));
+		world.RemoveCollectibles(world.QueryCollectibles(player.GetBoundingBox()), player);
+		player.UpdateTimeRemaining(delta_time_);
+		renderFrame(camera, player, world);
+
+		glQueryCounter(queries.at(2 * frame + 1), GL_TIMESTAMP);
+		cpu_ms.at(frame) = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		triangles.at(frame) = world.GetDrawnTriangleCount();
 		glfwPollEvents();
 	}
+	frame_buffer.Unbind();
+	gpu_timer_.Flush();
 
-	ImGui_ImplOpenGL3_Shutdown();
-	ImGui_ImplGlfw_Shutdown();
-	ImGui::DestroyContext();
-	glfwTerminate();
+	FrameTimes frame_times;
+	for (uint32_t frame = 0; frame < frame_count; frame++)
+	{
+		GLuint64 start_ns = 0, end_ns = 0;
+		glGetQueryObjectui64v(queries.at(2 * frame), GL_QUERY_RESULT, &start_ns);
+		glGetQueryObjectui64v(queries.at(2 * frame + 1), GL_QUERY_RESULT, &end_ns);
+		frame_times.Add(cpu_ms.at(frame), (double)(end_ns - start_ns) / 1e6, triangles.at(frame));
+	}
+	glDeleteQueries((GLsizei)queries.size(), queries.data());
+
+	frame_times.PrintSummary();
+	frame_times.WriteCsv(_output_prefix + ".csv");
+	frame_times.WriteJson(_output_prefix + ".json");
+	gpu_timer_.WriteCsv(_output_prefix + "_passes.csv");
+	shutdown();
+}
+
+void Renderer::RenderLoadingScreen(float progress)
+{
+	// Shown while the startup graph runs, between its main thread tasks. 
+	// Only ImGui, nothing of the world exists yet.
+	//
+	ImGuiWindowFlags imgui_flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar | 
+		ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove;
+
+	clearFramebuffers();
+	ImGui::StyleColorsDark();
+	ImGui_ImplOpenGL3_NewFrame();
+	ImGui_ImplGlfw_NewFrame();
+	ImGui::NewFrame();
+
+	ImGui::Begin("Loading", 0, imgui_flags);
+	ImGui::Text("Loading");
+	ImGui::ProgressBar(progress, ImVec2(-1.0f, 0.0f));
+	ImGui::SetWindowPos(ImVec2(window_.GetWidth() / 2.f - 150.f, window_.GetHeight() / 2.f - 35.f));
+	ImGui::SetWindowSize(ImVec2(300.f, 70.f));
+	ImGui::End();
+	ImGui::Render();
+	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+	glfwSwapBuffers(window_.GetWindow());
+	glfwPollEvents();
 }
 
 void Renderer::ProcessFramebuffer(GLFWwindow* window, int width,
@@ -107,46 +201,180 @@ void Renderer::ProcessMouse(Camera& camera, Player& player, GLFWwindow* window,
 	camera.HandleMouse(x_offset, y_offset);
 }
 
-void Renderer::processKeyboard(Camera& camera, Player& player, GameWorld& world)
+void Renderer::renderFrame(Camera& camera, Player& player, GameWorld& world)
 {
-	if (glfwGetKey(window_.GetWindow(), GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	updateFrame(camera, player, world);
+	drawFrame(player, world);
+}
+
+void Renderer::updateFrame(Camera& camera, Player& player, GameWorld& world)
+{
+	ImGuiWindowFlags imgui_flags = ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoTitleBar | 
+		ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoResize;
+
+	gpu_timer_.BeginFrame();
 	{
-		window_.SetWindowShouldClose(true);
+		PROFILE_SCOPE("GameWorld::Update");
+		world.Update(player.position_);
+	}
+	{
+		// Pixels per unit at distance one, the LOD selection turns the error of
+		// a level into a distance with it. The draw lists are built by jobs 
+		// while the rest of the frame goes on, the world's Draw picks them up.
+		// Nothing may change the world between here and there.
+		//
+		PROFILE_SCOPE("GameWorld::BuildDrawLists");
+		float projection_scale = (float)window_.GetHeight() / (2.0f * std::tan(glm::radians(camera.fov_) / 2.0f));
+		world.BuildDrawLists(camera.GetProjectionViewMatrix(), camera.position_, projection_scale);
+	}
+	{
+		PROFILE_SCOPE("Renderer::UboUpdate");
+		glm::mat4 view = camera.GetViewMatrix();
+		glm::mat4 view_3 = camera.GetViewMatrix3();
+		glm::mat4 projection = camera.GetProjectionMatrix();
+
+		ubo_matrices_.Data(projection, 0);
+		ubo_matrices_.Data(view, 1);
+		ubo_matrices_.Data(view_3, 2);
+		ubo_camera_.Data(camera.position_, 0);
+		ubo_light_.Data(world.GetSunPosition(), 0);
 	}
 
-	float velocity = player.movement_speed_ * (float)delta_time_;
-	if (glfwGetKey(window_.GetWindow(), GLFW_KEY_W) == GLFW_PRESS)
+	PROFILE_SCOPE("Renderer::ImGuiBuild");
+	ImGui_ImplOpenGL3_NewFrame();
+	ImGui_ImplGlfw_NewFrame();
+	ImGui::NewFrame();
+
+	ImGui::Begin("Score", 0, imgui_flags);
+	ImGui::Text(player.GetScorePretty().c_str());
+	ImGui::Text(player.GetTimeRemainingPretty().c_str());
+	ImGui::SetWindowPos(ImVec2(0.f, 0.f));
+	ImGui::SetWindowSize(ImVec2(200.f, 75.f));
+	ImGui::End();
+
+	ImGui::Begin("Stats", 0, imgui_flags);
+	ImGui::SetWindowFontScale(0.5f);
+	ImGui::Text(getFps().c_str());
+	ImGui::Text(getFrametime().c_str());
+	ImGui::Text(getInstanceStats(world).c_str());
+	ImGui::SetWindowPos(ImVec2(window_.GetWidth() - 200.f, window_.GetHeight() - 100.f));
+	ImGui::SetWindowSize(ImVec2(200.f, 100.f));
+	ImGui::End();
+	drawPassTimes();
+	ImGui::Render();
+}
+
+void Renderer::drawFrame(Player& player, GameWorld& world)
+{
 	{
-		player.position_ += player.front_ * velocity;
-		player.position_.y = world.GetGridHeight(player.position_);
-		player.UpdateBoundingBox();
-		camera.SetPlayerPosition(player.position_);
-		camera.FollowPlayer();
+		PROFILE_SCOPE("GameWorld::Draw");
+		world.Draw(gpu_timer_);
 	}
-	if (glfwGetKey(window_.GetWindow(), GLFW_KEY_S) == GLFW_PRESS)
 	{
-		player.position_ -= player.front_ * velocity;
-		player.position_.y = world.GetGridHeight(player.position_);
-		player.UpdateBoundingBox();
-		camera.SetPlayerPosition(player.position_);
-		camera.FollowPlayer();
+		PROFILE_SCOPE("Player::Draw");
+		gpu_timer_.Begin("player");
+		player.Draw();
+		gpu_timer_.End();
 	}
-	if (glfwGetKey(window_.GetWindow(), GLFW_KEY_A) == GLFW_PRESS)
 	{
-		player.position_ -= player.right_ * velocity;
-		player.position_.y = world.GetGridHeight(player.position_);
-		player.UpdateBoundingBox();
-		camera.SetPlayerPosition(player.position_);
-		camera.FollowPlayer();
+		PROFILE_SCOPE("Renderer::ImGuiRender");
+		gpu_timer_.Begin("imgui");
+		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		gpu_timer_.End();
 	}
-	if (glfwGetKey(window_.GetWindow(), GLFW_KEY_D) == GLFW_PRESS)
+}
+
+void Renderer::applySimulation(Camera& camera, Player& player, GameWorld& world, 
+	Simulation& simulation, Simulation::State& last_tick)
+{
+	PROFILE_SCOPE("Renderer::ApplySimulation");
+	const Simulation::Snapshot& snapshot = simulation.GetSnapshot();
+	Simulation::State state = simulation.Interpolate(snapshot, Simulation::Now());
+	player.position_ = state.position;
+	camera.SetPlayerPosition(player.position_);
+	camera.FollowPlayer();
+
+	// Hazelnuts are picked up along the way from the last tick seen to the
+	// newest one, a slow frame may have skipped the ticks in between.
+	//
+	if (snapshot.current.tick != last_tick.tick)
 	{
-		player.position_ += player.right_ * velocity;
-		player.position_.y = world.GetGridHeight(player.position_);
-		player.UpdateBoundingBox();
-		camera.SetPlayerPosition(player.position_);
-		camera.FollowPlayer();
+		PROFILE_SCOPE("GameWorld::RemoveCollectibles");
+		glm::vec3 from = last_tick.position;
+		glm::vec3 to = snapshot.current.position;
+		uint32_t steps = std::max((uint32_t)std::ceil(glm::length(to - from) / _PICKUP_STEP_), (uint32_t)1);
+		for (uint32_t i = 1; i <= steps; i++)
+		{
+			player.SetCenter(glm::mix(from, to, (float)i / (float)steps));
+			world.RemoveCollectibles(world.QueryCollectibles(player.GetBoundingBox()), player);
+		}
+		player.UpdateTimeRemaining(snapshot.current.time - last_tick.time);
+		last_tick = snapshot.current;
 	}
+	player.UpdateBoundingBox();
+}
+
+void Renderer::applyPathPose(Camera& camera, Player& player, GameWorld& world, 
+	const CameraPath::Keyframe& pose)
+{
+	// Same state the mouse and keyboard handlers leave behind, the height 
+	// comes from the terrain like when walking.
+	//
+	player.position_ = pose.position;
+	player.position_.y = world.GetGridHeight(player.position_);
+	player.UpdateBoundingBox();
+	camera.yaw_ = pose.yaw;
+	camera.SetPlayerPosition(player.position_);
+	camera.FollowPlayer();
+	camera.HandleMouse(0.0f, 0.0f);
+	player.HandleMouse(camera, 0.0f, 0.0f);
+}
+
+void Renderer::shutdown()
+{
+	ImGui_ImplOpenGL3_Shutdown();
+	ImGui_ImplGlfw_Shutdown();
+	ImGui::DestroyContext();
+	glfwTerminate();
+}
+
+void Renderer::processKeyboard(Player& player, Simulation& simulation)
+{
+	if (glfwGetKey(window_.GetWindow(), GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	{
+		window_.SetWindowShouldClose(true);
+	}
+
+	// The keys only say where to go, the simulation thread moves the 
+	// player. The directions follow the camera, which the mouse turns.
+	//
+	Simulation::Input input;
+	input.front = player.front_;
+	input.right = player.right_;
+	input.speed = player.movement_speed_;
+	input.move_forward = glfwGetKey(window_.GetWindow(), GLFW_KEY_W) == GLFW_PRESS;
+	input.move_back = glfwGetKey(window_.GetWindow(), GLFW_KEY_S) == GLFW_PRESS;
+	input.move_left = glfwGetKey(window_.GetWindow(), GLFW_KEY_A) == GLFW_PRESS;
+	input.move_right = glfwGetKey(window_.GetWindow(), GLFW_KEY_D) == GLFW_PRESS;
+	simulation.SetInput(input);
+
+	// F2 writes the pass time history, once per press.
+	//
+	bool export_key_down = glfwGetKey(window_.GetWindow(), GLFW_KEY_F2) == GLFW_PRESS;
+	if (export_key_down && !export_key_down_)
+	{
+		gpu_timer_.WriteCsv(_PASS_TIMES_PATH_);
+	}
+	export_key_down_ = export_key_down;
+
+	// F3 writes the zones the profiler has recorded so far, if it runs.
+	//
+	bool trace_key_down = glfwGetKey(window_.GetWindow(), GLFW_KEY_F3) == GLFW_PRESS;
+	if (trace_key_down && !trace_key_down_ && Profiler::IsEnabled())
+	{
+		Profiler::WriteTrace(_TRACE_PATH_);
+	}
+	trace_key_down_ = trace_key_down;
 }
 
 void Renderer::setupInput(int mode, int value)
@@ -193,4 +421,63 @@ std::string Renderer::getFrametime()
 {
 	//return "FT:" + std::to_string(delta_time_ * 1000.0);
 	return "FT:" + std::to_string(ImGui::GetIO().DeltaTime * 1000.0);
+}
+
+std::string Renderer::getInstanceStats(GameWorld& world)
+{
+	return "INST:" + std::to_string(world.GetVisibleInstanceCount()) + "/" + 
+		std::to_string(world.GetTotalInstanceCount()) + "\nCULL:" + std::to_string(world.GetCullTime()) + 
+		"\nTRI:" + std::to_string(world.GetDrawnTriangleCount());
+}
+
+void Renderer::drawPassTimes()
+{
+	// GPU time per pass over the last frames, the table shows average and
+	// max and every row a graph of the whole history. The results are two 
+	// frames old, see GpuTimer.
+	//
+	ImGuiWindowFlags imgui_flags = ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoTitleBar | 
+		ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoResize;
+
+	ImGui::Begin("Passes", 0, imgui_flags);
+	ImGui::SetWindowFontScale(0.5f);
+	if (ImGui::BeginTable("PassTable", 4))
+	{
+		ImGui::TableSetupColumn("PASS");
+		ImGui::TableSetupColumn("AVG");
+		ImGui::TableSetupColumn("MAX");
+		ImGui::TableSetupColumn("MS", ImGuiTableColumnFlags_WidthFixed, 90.f);
+		ImGui::TableHeadersRow();
+
+		float total = 0.0f;
+		for (std::size_t i = 0; i < gpu_timer_.GetPassCount(); i++)
+		{
+			float average = gpu_timer_.GetPassAverage(i);
+			total += average;
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(gpu_timer_.GetPassName(i).c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", average);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", gpu_timer_.GetPassMax(i));
+			ImGui::TableNextColumn();
+			ImGui::PushID((int)i);
+			ImGui::PlotLines("", gpu_timer_.GetPassHistory(i).data(), (int)gpu_timer_.GetPassHistory(i).size(), 
+				(int)gpu_timer_.GetHistoryOffset(), NULL, 0.0f, FLT_MAX, ImVec2(90.f, 12.f));
+			ImGui::PopID();
+		}
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+		ImGui::Text("TOTAL");
+		ImGui::TableNextColumn();
+		ImGui::Text("%.3f", total);
+		ImGui::EndTable();
+	}
+	ImGui::Text("F2:%s", _PASS_TIMES_PATH_.c_str());
+	ImGui::SetWindowPos(ImVec2(window_.GetWidth() - 300.f, window_.GetHeight() - 330.f));
+	ImGui::SetWindowSize(ImVec2(300.f, 230.f));
+	ImGui::End();
 }
\ No newline at end of file
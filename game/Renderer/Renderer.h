@@ -1,6 +1,10 @@
 #pragma once
 
 #include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -20,13 +24,23 @@
 #include "World/GameWorld.h"
 #include "Game/Player.h"
 #include "World/TerrainElement.h"
+#include "Buffers/FrameBuffer.h"
+#include "Renderer/FrameTimes.h"
+#include "Renderer/GpuTimer.h"
+#include "Profiler/Profiler.h"
+#include "Game/CameraPath.h"
+#include "Game/Simulation.h"
 
 class Renderer
 {
 public:
     Renderer(Window& window);
 
-    void Render(Camera& camera, Player& player, GameWorld& world);
+    void Render(Camera& camera, Player& player, GameWorld& world, 
+        CameraPath* recording = nullptr);
+    void RenderBenchmark(Camera& camera, Player& player, GameWorld& world, 
+        CameraPath& path, uint32_t frame_count, const std::string _output_prefix);
+    void RenderLoadingScreen(float progress);
 
     void ProcessFramebuffer(GLFWwindow* window, int width, 
         int height);
@@ -40,12 +54,34 @@ private:
     bool first_mouse_;
     float last_x_;
     float last_y_;
+    UniformBuffer<glm::mat4> ubo_matrices_;
+    UniformBuffer<glm::vec3> ubo_camera_;
+    UniformBuffer<glm::vec3> ubo_light_;
+    GpuTimer gpu_timer_;
+    bool export_key_down_;
+    bool trace_key_down_;
 
-    void processKeyboard(Camera& camera, Player& player, GameWorld& world);
+    static const double _BENCHMARK_TIME_STEP_;
+    static const std::string _PASS_TIMES_PATH_;
+    static const std::string _TRACE_PATH_;
+    static const float _PICKUP_STEP_;
+
+    void renderFrame(Camera& camera, Player& player, GameWorld& world);
+    void updateFrame(Camera& camera, Player& player, GameWorld& world);
+    void drawFrame(Player& player, GameWorld& world);
+    void applySimulation(Camera& camera, Player& player, GameWorld& world, 
+        Simulation& simulation, Simulation::State& last_tick);
+    void applyPathPose(Camera& camera, Player& player, GameWorld& world, 
+        const CameraPath::Keyframe& pose);
+    void shutdown();
+
+    void processKeyboard(Player& player, Simulation& simulation);
     void setupInput(int mode, int value);
     void setupGlobalEnables();
     void processFrametime();
     void clearFramebuffers();
     std::string getFps();
     std::string getFrametime();
+    std::string getInstanceStats(GameWorld& world);
+    void drawPassTimes();
 };
\ No newline at end of file
@@ -1,5 +1,11 @@
 #include "Renderer/Shader.h"
 
+const std::string Shader::_CACHE_DIRECTORY_ = "Cache/Shaders/";
+uint32_t Shader::cache_hit_count_ = 0;
+uint32_t Shader::compile_count_ = 0;
+double Shader::cache_hit_ms_ = 0.0;
+double Shader::compile_ms_ = 0.0;
+
 Shader::Shader(const std::string _vertex_path,
 	const std::string _fragment_path)
 {
@@ -34,6 +40,15 @@ Shader::Shader(const std::string _vertex_path,
 		std::cout << "Error:" << e.what() << std::endl;
 	}
 
+	std::vector<std::string> paths = { _vertex_path, _fragment_path };
+	std::vector<std::string> sources = { vertex_source, fragment_source };
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (loadBinary(paths, sources))
+	{
+		finishLoad(paths, true, start);
+		return;
+	}
+
 	const char* v_shader_source = vertex_source.c_str();
 	const char* f_shader_source = fragment_source.c_str();
 
@@ -56,6 +71,7 @@ Shader::Shader(const std::string _vertex_path,
 	id_ = glCreateProgram();
 	glAttachShader(id_, vertex_shader);
 	glAttachShader(id_, fragment_shader);
+	glProgramParameteri(id_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(id_);
 	CheckCompile(id_, SHTYPEenum::PROGRAM);
 
@@ -63,6 +79,9 @@ Shader::Shader(const std::string _vertex_path,
 	//
 	glDeleteShader(vertex_shader);
 	glDeleteShader(fragment_shader);
+
+	saveBinary(paths, sources);
+	finishLoad(paths, false, start);
 }
 
 Shader::Shader(const std::string _vertex_path,
@@ -105,6 +124,15 @@ Shader::Shader(const std::string _vertex_path,
 		std::cout << "Error:" << e.what() << std::endl;
 	}
 
+	std::vector<std::string> paths = { _vertex_path, _geometry_path, _fragment_path };
+	std::vector<std::string> sources = { vertex_source, geometry_source, fragment_source };
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (loadBinary(paths, sources))
+	{
+		finishLoad(paths, true, start);
+		return;
+	}
+
 	const char* v_shader_source = vertex_source.c_str();
 	const char* g_shader_source = geometry_source.c_str();
 	const char* f_shader_source = fragment_source.c_str();
@@ -134,6 +162,7 @@ Shader::Shader(const std::string _vertex_path,
 	glAttachShader(id_, vertex_shader);
 	glAttachShader(id_, geometry_shader);
 	glAttachShader(id_, fragment_shader);
+	glProgramParameteri(id_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(id_);
 	CheckCompile(id_, SHTYPEenum::PROGRAM);
 
@@ -142,6 +171,9 @@ Shader::Shader(const std::string _vertex_path,
 	glDeleteShader(vertex_shader);
 	glDeleteShader(geometry_shader);
 	glDeleteShader(fragment_shader);
+
+	saveBinary(paths, sources);
+	finishLoad(paths, false, start);
 }
 
 void Shader::Use() const
@@ -232,3 +264,99 @@ void Shader::SetVec4(const std::string _name, const glm::vec4& _value) const
 {
 	glUniform4fv(GetUniformLocation(_name), 1, glm::value_ptr(_value));
 }
+
+void Shader::PrintCacheStats()
+{
+	std::cout << "INFO::SHADER::PRINT_CACHE_STATS" << std::endl;
+	std::cout << "Cache hits:" << cache_hit_count_ << " in " << cache_hit_ms_ << "ms|Compiled:" << 
+		compile_count_ << " in " << compile_ms_ << "ms" << std::endl;
+}
+
+bool Shader::loadBinary(const std::vector<std::string>& _paths, const std::vector<std::string>& _sources)
+{
+	// Drivers without a binary format can't use the cache at all.
+	//
+	GLint format_count = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+	if (format_count <= 0)
+	{
+		return false;
+	}
+
+	std::shared_ptr<MappedFile> file = ShaderCache::Open(ShaderCache::CachePath(_CACHE_DIRECTORY_, _paths),
+		ShaderCache::Hash(_sources), driverHash());
+	if (!file)
+	{
+		return false;
+	}
+
+	// The driver can still refuse a binary with matching strings, that is
+	// reported as a failed link.
+	//
+	ShaderCache::Binary binary = ShaderCache::GetBinary(*file);
+	id_ = glCreateProgram();
+	glProgramBinary(id_, (GLenum)binary.format, binary.data, (GLsizei)binary.size);
+
+	GLint success = 0;
+	glGetProgramiv(id_, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		std::cout << "INFO::SHADER::LOAD_BINARY::REJECTED::" << _paths.front() << std::endl;
+		glDeleteProgram(id_);
+		id_ = 0;
+		return false;
+	}
+	return true;
+}
+
+void Shader::saveBinary(const std::vector<std::string>& _paths, const std::vector<std::string>& _sources)
+{
+	GLint success = 0, length = 0, format_count = 0;
+	glGetProgramiv(id_, GL_LINK_STATUS, &success);
+	glGetProgramiv(id_, GL_PROGRAM_BINARY_LENGTH, &length);
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+	if (!success || length <= 0 || format_count <= 0)
+	{
+		return;
+	}
+
+	std::vector<uint8_t> data((std::size_t)length);
+	GLsizei written = 0;
+	GLenum format = 0;
+	glGetProgramBinary(id_, length, &written, &format, data.data());
+	if (written <= 0)
+	{
+		return;
+	}
+
+	ShaderCache::Binary binary;
+	binary.format = (uint32_t)format;
+	binary.data = data.data();
+	binary.size = (uint64_t)written;
+	ShaderCache::Write(ShaderCache::CachePath(_CACHE_DIRECTORY_, _paths), ShaderCache::Hash(_sources), 
+		driverHash(), binary);
+}
+
+void Shader::finishLoad(const std::vector<std::string>& _paths, bool cache_hit,
+	std::chrono::steady_clock::time_point start)
+{
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	(cache_hit ? cache_hit_count_ : compile_count_)++;
+	(cache_hit ? cache_hit_ms_ : compile_ms_) += ms;
+	std::cout << "INFO::SHADER::SHADER::" << (cache_hit ? "CACHE_HIT::" : "COMPILED::") << _paths.front() << 
+		"::" << ms << "_MS" << std::endl;
+}
+
+uint64_t Shader::driverHash()
+{
+	// A binary only loads on the driver that wrote it.
+	//
+	const GLenum names[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	std::vector<std::string> strings;
+	for (int i = 0; i < 3; i++)
+	{
+		const GLubyte* string = glGetString(names[i]);
+		strings.push_back(string != nullptr ? (const char*)string : "");
+	}
+	return ShaderCache::Hash(strings);
+}
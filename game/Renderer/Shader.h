@@ -1,17 +1,25 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <chrono>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "Cache/ShaderCache.h"
 #include "Types/EShader.h"
 
+// Linked programs go through the shader cache: a program whose sources and
+// driver match a cached binary is loaded with glProgramBinary instead of
+// being compiled, anything else (no file, stale file, binary rejected by the
+// driver) compiles as usual and refreshes the cache.
+//
 class Shader
 {
 public:
@@ -38,4 +46,20 @@ public:
 	void SetVec2(const std::string _name, const glm::vec2& _value) const;
 	void SetVec3(const std::string _name, const glm::vec3& _value) const;
 	void SetVec4(const std::string _name, const glm::vec4& _value) const;
+
+	static void PrintCacheStats();
+
+private:
+	static const std::string _CACHE_DIRECTORY_;
+	static uint32_t cache_hit_count_;
+	static uint32_t compile_count_;
+	static double cache_hit_ms_;
+	static double compile_ms_;
+
+	bool loadBinary(const std::vector<std::string>& _paths, const std::vector<std::string>& _sources);
+	void saveBinary(const std::vector<std::string>& _paths, const std::vector<std::string>& _sources);
+	void finishLoad(const std::vector<std::string>& _paths, bool cache_hit, 
+		std::chrono::steady_clock::time_point start);
+
+	static uint64_t driverHash();
 };
\ No newline at end of file
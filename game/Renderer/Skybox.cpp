@@ -1,41 +1,23 @@
 #include "Skybox.h"
 
-Skybox::Skybox(const std::string _directory,
-	const SKYBFORMATenum _format) :
-	directory_(_directory),
-	format_(_format)
+Skybox::Skybox(TextureHandle cubemap) :
+	cubemap_(cubemap)
 {
-	std::string file_format;
-	if (format_ == SKYBFORMATenum::JPG)
-	{
-		file_format = ".jpg";
-	}
-	else if (format_ == SKYBFORMATenum::PNG)
-	{
-		file_format = ".png";
-	}
-
-	std::vector<std::string> files
-	{
-		directory_ + "right" + file_format,
-		directory_ + "left" + file_format,
-		directory_ + "top" + file_format,
-		directory_ + "bottom" + file_format,
-		directory_ + "front" + file_format,
-		directory_ + "back" + file_format
-	};
-
-	loadCubemap(files);
 	setup();
 }
 
 void Skybox::Draw(Shader& shader)
 {
+	if (!IsReady())
+	{
+		return;
+	}
+
 	shader.Use();
 
 	glDepthFunc(GL_LEQUAL);
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, id_);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap_->GetId());
 
 	glBindVertexArray(vao_);
 	glDrawArrays(GL_TRIANGLES, 0, 36);
@@ -45,57 +27,33 @@ void Skybox::Draw(Shader& shader)
 	glDepthFunc(GL_LESS);
 }
 
-void Skybox::loadCubemap(const std::vector<std::string> _files)
+bool Skybox::IsReady() const
 {
-	uint32_t texture_id;
-	glGenTextures(1, &texture_id);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, texture_id);
+	return cubemap_ && cubemap_->IsReady();
+}
 
-	int width, height, n_comp;
-	unsigned char* data;
-	for (std::size_t i = 0; i < _files.size(); i++)
+std::vector<std::string> Skybox::GetFacePaths(const std::string _directory, 
+	const SKYBFORMATenum _format)
+{
+	std::string file_format;
+	if (_format == SKYBFORMATenum::JPG)
 	{
-		data = stbi_load(_files[i].c_str(), &width, &height, &n_comp, 0);
-		if (data)
-		{
-			GLenum format = GL_RGB;
-			if (n_comp == 1)
-			{
-				format = GL_RED;
-			}
-			else if (n_comp == 3)
-			{
-				format = GL_RGB;
-			}
-			else if (n_comp == 4)
-			{
-				format = GL_RGBA;
-			}
-
-			glTexImage2D(
-				GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-				0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data
-			);
-
-			stbi_image_free(data);
-		}
-		else
-		{
-			std::cout << "ERROR::MAIN::LOAD_CUBEMAP::CUBEMAP_LOAD_ERROR" << std::endl;
-			std::cout << "Cubemap load failed at path:" << _files[i] << std::endl;
-			stbi_image_free(data);
-		}
+		file_format = ".jpg";
+	}
+	else if (_format == SKYBFORMATenum::PNG)
+	{
+		file_format = ".png";
 	}
 
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-
-	id_ = texture_id;
+	return std::vector<std::string>
+	{
+		_directory + "right" + file_format,
+		_directory + "left" + file_format,
+		_directory + "top" + file_format,
+		_directory + "bottom" + file_format,
+		_directory + "front" + file_format,
+		_directory + "back" + file_format
+	};
 }
 
 void Skybox::setup()
@@ -2,29 +2,34 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <string>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <stb/stb_image.h>
 
+#include "Assets/TextureLoader.h"
 #include "Renderer/Shader.h"
 #include "Types/ESkybox.h"
 
+// The cube map comes from the texture loader (see GetFacePaths for the face
+// files), the skybox isn't drawn until all six faces are uploaded.
+//
 class Skybox
 {
 public:
-    Skybox(const std::string _directory, 
-        const SKYBFORMATenum _format);
+    Skybox(TextureHandle cubemap);
 	
     void Draw(Shader& shader);
+    bool IsReady() const;
+
+    static std::vector<std::string> GetFacePaths(const std::string _directory, 
+        const SKYBFORMATenum _format);
 
 private:
-    uint32_t id_;
+    TextureHandle cubemap_;
     uint32_t vao_, vbo_;
-    SKYBFORMATenum format_;
-    std::string directory_;
 
-    void loadCubemap(const std::vector<std::string> _files);
     void setup();
 };
 
@@ -0,0 +1,42 @@
+#version 420 core
+
+layout (std140, binding = 2) uniform WorldLight
+{
+	vec3 direction;
+};
+
+uniform sampler2D impostor_albedo;
+uniform sampler2D impostor_normal;
+
+in VS_OUT
+{
+    vec2 atlasCoords;
+    float fade;
+    flat mat3 rotation;
+} fs_in;
+
+// Same dither as lowPolyModel.frag, the impostor keeps exactly the pixels
+// the mesh drops while the two crossfade.
+float Dither(vec2 fragCoord);
+
+void main()
+{
+	vec4 albedo = texture(impostor_albedo, fs_in.atlasCoords);
+	if (albedo.a < 0.5 || Dither(gl_FragCoord.xy) >= fs_in.fade)
+	{
+		discard;
+	}
+
+	// Lit like lowPolyModel.frag, the ambient material color of the models
+	// is white.
+	vec3 N = normalize(fs_in.rotation * (texture(impostor_normal, fs_in.atlasCoords).xyz * 2.0 - 1.0));
+	vec3 L = normalize(-direction);
+	vec3 fragColor = vec3(0.1) + max(dot(L, N), 0.0) * albedo.rgb;
+    gl_FragColor = vec4(fragColor, 1.0);
+}
+
+float Dither(vec2 fragCoord)
+{
+	// Interleaved gradient noise.
+	return fract(52.9829189 * fract(dot(fragCoord, vec2(0.06711056, 0.00583715))));
+}
@@ -0,0 +1,71 @@
+#version 420 core
+
+layout (location = 0) in vec2 aCorner;
+layout (location = 3) in vec3 aInstancePosition;
+layout (location = 4) in vec2 aInstanceYawScale;
+
+layout (std140, binding = 0) uniform Matrices
+{
+    mat4 projection;
+    mat4 view;
+};
+
+layout (std140, binding = 1) uniform Camera
+{
+	vec3 cameraPos;
+};
+
+out VS_OUT
+{
+    vec2 atlasCoords;
+    float fade;
+    flat mat3 rotation;
+} vs_out;
+
+uniform vec3 impostor_center;
+uniform float impostor_radius;
+uniform float impostor_frames;
+uniform float fade_start;
+uniform float fade_width;
+
+// Keep in sync with Instance::_MAX_SCALE_.
+const float TWO_PI = 6.28318530718;
+const float MAX_INSTANCE_SCALE = 4.0;
+const vec3 UP = vec3(0.0, 1.0, 0.0);
+
+void main()
+{
+    float yaw = aInstanceYawScale.x * TWO_PI;
+    float scale = aInstanceYawScale.y * MAX_INSTANCE_SCALE;
+    float c = cos(yaw);
+    float s = sin(yaw);
+    mat3 rotation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
+
+    // Direction to the camera in model space, clamped to the upper 
+    // hemisphere the atlas covers.
+    vec3 center = rotation * (impostor_center * scale) + aInstancePosition;
+    vec3 toCamera = cameraPos - center;
+    vec3 direction = transpose(rotation) * toCamera;
+    direction.y = max(direction.y, 0.0);
+    direction = normalize(direction + vec3(0.0, 1e-4, 0.0));
+
+    // Hemi-octahedral encode, the nearest cell and the direction it was 
+    // baked from (Impostor::frameDirection).
+    vec3 octahedral = direction / (abs(direction.x) + abs(direction.y) + abs(direction.z));
+    vec2 cellCoords = vec2(octahedral.x + octahedral.z, octahedral.z - octahedral.x) * 0.5 + 0.5;
+    vec2 cell = clamp(floor(cellCoords * impostor_frames), vec2(0.0), vec2(impostor_frames - 1.0));
+    vec2 cellCenter = (cell + 0.5) / impostor_frames * 2.0 - 1.0;
+    vec3 frameDirection = vec3((cellCenter.x - cellCenter.y) * 0.5, 0.0, (cellCenter.x + cellCenter.y) * 0.5);
+    frameDirection.y = 1.0 - abs(frameDirection.x) - abs(frameDirection.z);
+    frameDirection = normalize(frameDirection);
+
+    // The quad faces the baked direction with the bake camera's axes.
+    vec3 right = normalize(cross(UP, frameDirection));
+    vec3 up = cross(frameDirection, right);
+    vec3 world = center + rotation * (right * aCorner.x + up * aCorner.y) * impostor_radius * scale;
+
+    vs_out.atlasCoords = (cell + aCorner * 0.5 + 0.5) / impostor_frames;
+    vs_out.fade = clamp((length(cameraPos - aInstancePosition) - fade_start) / fade_width, 0.0, 1.0);
+    vs_out.rotation = rotation;
+	gl_Position = projection * view * vec4(world, 1.0);
+}
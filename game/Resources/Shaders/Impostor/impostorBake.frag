@@ -0,0 +1,19 @@
+#version 420 core
+
+layout (location = 0) out vec4 outAlbedo;
+layout (location = 1) out vec4 outNormal;
+
+uniform vec4 color_diffuse_1;
+
+in VS_OUT
+{
+    vec3 fragNormal;
+} fs_in;
+
+void main()
+{
+	// Unlit, impostor.frag does the lighting with the stored model space 
+	// normal.
+	outAlbedo = vec4(vec3(color_diffuse_1), 1.0);
+	outNormal = vec4(normalize(fs_in.fragNormal) * 0.5 + 0.5, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 420 core
+
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+
+out VS_OUT
+{
+    vec3 fragNormal;
+} vs_out;
+
+// Set by Impostor::bake, the world matrices aren't used.
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	vs_out.fragNormal = mat3(model) * aNormal;
+	gl_Position = projection * view * model * vec4(aPosition, 1.0);
+}
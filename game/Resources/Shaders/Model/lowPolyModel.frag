@@ -35,16 +35,25 @@ in VS_OUT
 {
 	vec3 fragPos;
     vec3 fragNormal;
+    float fade;
 } fs_in;
 
 vec3 CalculateDirectionalPhong(DirectionalLight light, vec3 fragPos, vec3 fragNormal, vec3 cameraPos);
 vec3 CalculateDirectionalBlinnPhong();
+float Dither(vec2 fragCoord);
 
 DirectionalLight light_1;
 const float SHININESS = 8.0;
 
 void main()
 {
+	// Past the impostor distance the mesh drops a growing share of its 
+	// pixels, impostor.frag draws exactly those.
+	if (Dither(gl_FragCoord.xy) < fs_in.fade)
+	{
+		discard;
+	}
+
 	light_1.direction = direction;
 	light_1.ambient = vec3(0.1, 0.1, 0.1);
 	light_1.diffuse = vec3(1.0, 1.0, 1.0);
@@ -70,4 +79,10 @@ vec3 CalculateDirectionalPhong(DirectionalLight light, vec3 fragPos, vec3 fragNo
 //	vec3 specularC = kS * pow(max(dot(R, V), 0.0), 1) * vec3(color_specular_1);
 
 	return ambientC + diffuseC;
+}
+
+float Dither(vec2 fragCoord)
+{
+	// Interleaved gradient noise.
+	return fract(52.9829189 * fract(dot(fragCoord, vec2(0.06711056, 0.00583715))));
 }
\ No newline at end of file
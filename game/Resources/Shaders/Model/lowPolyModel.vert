@@ -2,7 +2,8 @@
 
 layout (location = 0) in vec3 aPosition;
 layout (location = 1) in vec3 aNormal;
-layout (location = 3) in mat4 aModel;
+layout (location = 3) in vec3 aInstancePosition;
+layout (location = 4) in vec2 aInstanceYawScale;
 
 layout (std140, binding = 0) uniform Matrices
 {
@@ -10,15 +11,37 @@ layout (std140, binding = 0) uniform Matrices
     mat4 view;
 };
 
+layout (std140, binding = 1) uniform Camera
+{
+	vec3 cameraPos;
+};
+
 out VS_OUT
 {
     vec3 fragPos;
     vec3 fragNormal;
+    float fade;
 } vs_out;
 
+// Crossfade to the impostor, see impostor.vert.
+uniform float fade_start;
+uniform float fade_width;
+
+// Keep in sync with Instance::_MAX_SCALE_.
+const float TWO_PI = 6.28318530718;
+const float MAX_INSTANCE_SCALE = 4.0;
+
 void main()
 {
-	vs_out.fragNormal = aNormal;
-    vs_out.fragPos = vec3(aModel * vec4(aPosition, 1.0));
-	gl_Position = projection * view * aModel * vec4(aPosition, 1.0);
+    float yaw = aInstanceYawScale.x * TWO_PI;
+    float scale = aInstanceYawScale.y * MAX_INSTANCE_SCALE;
+    float c = cos(yaw);
+    float s = sin(yaw);
+    mat3 rotation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
+
+    vec3 world = rotation * (aPosition * scale) + aInstancePosition;
+	vs_out.fragNormal = rotation * aNormal;
+    vs_out.fragPos = world;
+    vs_out.fade = clamp((length(cameraPos - aInstancePosition) - fade_start) / fade_width, 0.0, 1.0);
+	gl_Position = projection * view * vec4(world, 1.0);
 }
\ No newline at end of file
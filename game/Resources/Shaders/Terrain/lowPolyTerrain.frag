@@ -30,7 +30,6 @@ layout (std140, binding = 2) uniform WorldLight
 in VS_OUT
 {
 	vec3 fragPos;
-    vec3 fragNormal;
     vec3 fragColor;
 } fs_in;
 
@@ -47,7 +46,15 @@ void main()
 	light_1.diffuse = vec3(1.0, 1.0, 1.0);
 	light_1.specular = vec3(0.0, 0.0, 0.0);
 
-	vec3 fragColor = CalculateDirectionalPhong(light_1, fs_in.fragPos, fs_in.fragNormal, fs_in.fragColor, cameraPos);
+	/*
+	* Face normal from the screen-space derivatives of the fragment position.
+	* Both derivatives lie in the triangle's plane, so every fragment of a
+	* triangle gets the same normal (flat shading), whether the terrain is
+	* drawn from shared, indexed vertices or from per-face vertices.
+	*/
+	vec3 fragNormal = normalize(cross(dFdx(fs_in.fragPos), dFdy(fs_in.fragPos)));
+
+	vec3 fragColor = CalculateDirectionalPhong(light_1, fs_in.fragPos, fragNormal, fs_in.fragColor, cameraPos);
     gl_FragColor = vec4(fragColor, 1.0);
 }
 
@@ -1,75 +1,577 @@
 #include "Terrain/NoiseGenerator.h"
 
+const std::size_t NoiseGenerator::_MIN_SAMPLES_PER_THREAD_ = 64 * 1024;
+
 std::shared_ptr<float[]> NoiseGenerator::PerlinNoise2D(const int _width, const int _height,
-    const int _octaves, const float _bias)
+    const int _octaves, const float _bias, 
+    const uint32_t _seed, const int _pitch,
+    const int _offset_x, const int _offset_y,
+    uint32_t thread_count)
 {
-    std::mt19937 rnd_eng(std::random_device{}());
-    std::uniform_real_distribution<float> dist(0, 1);
+    // The random values at the lattice points come from a hash of the lattice
+    // coordinates instead of a width * height seed array, so any window of the
+    // (unbounded) noise field can be evaluated on its own, and two windows that
+    // share an edge agree on it. This is what lets the terrain be generated in
+    // independent chunks.
+    // The pitch is the period of the first octave in samples, it defaults to
+    // the width of the window like the original single-map version.
+    //
+    const int base_pitch = (_pitch > 0) ? _pitch : _width;
+    std::shared_ptr<float[]> height_map(new float[(std::size_t)_width * _height]);
 
-    std::shared_ptr<float[]> seed(generateSeed(_width, _height, rnd_eng, dist));
-    std::shared_ptr<float[]> height_map(new float[_width * _height]);
+    // Everything that only depends on the column is the same for every row,
+    // so the lattice cell and the blend factor of each column are computed
+    // once per octave.
+    //
+    NoiseGenerator::OctaveColumns columns;
+    columns.cell.resize((std::size_t)_octaves * _width);
+    columns.blend.resize((std::size_t)_octaves * _width);
+    columns.first_cell.resize(_octaves);
+    columns.cell_count.resize(_octaves);
+    columns.pitch.resize(_octaves);
+    columns.scale.resize(_octaves);
 
-    for (int x = 0; x < _width; x++)
+    float scale = 1.0f;
+    float scale_acc = 0.0f;
+    for (int o = 0; o < _octaves; o++)
     {
-        for (int y = 0; y < _height; y++)
+        int pitch = std::max(base_pitch >> o, 1);
+        int first_cell = floorDiv(_offset_x, pitch);
+        int last_cell = floorDiv(_offset_x + _width - 1, pitch);
+
+        columns.pitch.at(o) = pitch;
+        columns.first_cell.at(o) = first_cell;
+        columns.cell_count.at(o) = last_cell - first_cell + 2;
+        columns.scale.at(o) = scale;
+        for (int x = 0; x < _width; x++)
         {
-            float noise = 0.0f;
-            float scale_acc = 0.0f;
-            float scale = 1.0f;
+            int world_x = _offset_x + x;
+            int sample_x1 = floorDiv(world_x, pitch) * pitch;
+            columns.cell.at((std::size_t)o * _width + x) = floorDiv(world_x, pitch) - first_cell;
+            columns.blend.at((std::size_t)o * _width + x) = (float)(world_x - sample_x1) / (float)pitch;
+        }
+
+        scale_acc += scale;
+        scale = scale / _bias;
+    }
+    columns.scale_acc = scale_acc;
+
+    runRows(_width, _height, thread_count, [&](int row_start, int row_end) {
+        noiseRows(height_map.get(), _width, row_start, row_end, _octaves, _seed, _offset_y, columns);
+    });
+
+    return height_map;
+}
+
+std::shared_ptr<float[]> NoiseGenerator::FractalNoise2D(const NOISETYPEenum _type, const int _width,
+    const int _height, const int _octaves,
+    const float _bias, const uint32_t _seed,
+    const int _pitch, const int _offset_x,
+    const int _offset_y, uint32_t thread_count)
+{
+    if (_type == NOISETYPEenum::VALUE)
+    {
+        return PerlinNoise2D(_width, _height, _octaves, _bias, _seed, _pitch, _offset_x, _offset_y, 
+            thread_count);
+    }
+
+    // Same octave layout and weights as the value noise, so either can feed
+    // the terrain. Coordinates are built from integer world coordinates, so
+    // neighbouring windows evaluate their shared edge at the same points.
+    // Every octave gets its own seed, otherwise all octaves would share the
+    // lattice point at the origin.
+    //
+    const int base_pitch = (_pitch > 0) ? _pitch : _width;
+    std::shared_ptr<float[]> height_map(new float[(std::size_t)_width * _height]);
+
+    std::vector<float> scales(_octaves);
+    float scale = 1.0f;
+    float scale_acc = 0.0f;
+    for (int o = 0; o < _octaves; o++)
+    {
+        scales.at(o) = scale;
+        scale_acc += scale;
+        scale = scale / _bias;
+    }
 
+    runRows(_width, _height, thread_count, [&](int row_start, int row_end) {
+        std::vector<float> x(_width), y(_width), values(_width), noise(_width);
+        for (int row = row_start; row < row_end; row++)
+        {
+            std::fill(noise.begin(), noise.end(), 0.0f);
             for (int o = 0; o < _octaves; o++)
             {
-                int pitch = _width >> o;
-                int sample_x1 = (x / pitch) * pitch;
-                int sample_y1 = (y / pitch) * pitch;
+                float pitch = (float)std::max(base_pitch >> o, 1);
+                for (int col = 0; col < _width; col++)
+                {
+                    x.at(col) = (float)(_offset_x + col) / pitch;
+                }
+                std::fill(y.begin(), y.end(), (float)(_offset_y + row) / pitch);
+
+                Evaluate2D(_type, x.data(), y.data(), values.data(), (std::size_t)_width, _seed + (uint32_t)o);
+                for (int col = 0; col < _width; col++)
+                {
+                    noise.at(col) += (values.at(col) * 0.5f + 0.5f) * scales.at(o);
+                }
+            }
 
-                int sample_x2 = (sample_x1 + pitch) % _width;
-                int sample_y2 = (sample_y1 + pitch) % _width;
+            float* height_row = height_map.get() + (std::size_t)row * _width;
+            for (int col = 0; col < _width; col++)
+            {
+                height_row[col] = std::min(std::max(noise.at(col) / scale_acc, 0.0f), 1.0f);
+            }
+        }
+    });
 
-                float blend_x = (float)(x - sample_x1) / (float)pitch;
-                float blend_y = (float)(y - sample_y1) / (float)pitch;
+    return height_map;
+}
 
-                float sample_t = (1.0f - blend_x) * seed[sample_y1 * _width + sample_x1] + blend_x * seed[sample_y1 * _width + sample_x2];
-                float sample_b = (1.0f - blend_x) * seed[sample_y2 * _width + sample_x1] + blend_x * seed[sample_y2 * _width + sample_x2];
+float NoiseGenerator::Perlin2D(const float _x, const float _y,
+    const uint32_t _seed)
+{
+    int x0 = fastFloor(_x);
+    int y0 = fastFloor(_y);
+    float fx = _x - (float)x0;
+    float fy = _y - (float)y0;
+    float u = fade(fx);
+    float v = fade(fy);
 
-                scale_acc += scale;
-                noise += (blend_y * (sample_b - sample_t) + sample_t) * scale;
-                scale = scale / _bias;
-            }
+    float n00 = grad(Hash(_seed, x0, y0), fx, fy, 0.0f);
+    float n10 = grad(Hash(_seed, x0 + 1, y0), fx - 1.0f, fy, 0.0f);
+    float n01 = grad(Hash(_seed, x0, y0 + 1), fx, fy - 1.0f, 0.0f);
+    float n11 = grad(Hash(_seed, x0 + 1, y0 + 1), fx - 1.0f, fy - 1.0f, 0.0f);
 
-            height_map[y * _width + x] = noise / scale_acc;
+    return lerp(lerp(n00, n10, u), lerp(n01, n11, u), v);
+}
+
+float NoiseGenerator::Perlin3D(const float _x, const float _y,
+    const float _z, const uint32_t _seed)
+{
+    int x0 = fastFloor(_x);
+    int y0 = fastFloor(_y);
+    int z0 = fastFloor(_z);
+    float fx = _x - (float)x0;
+    float fy = _y - (float)y0;
+    float fz = _z - (float)z0;
+    float u = fade(fx);
+    float v = fade(fy);
+    float w = fade(fz);
+
+    float n000 = grad(Hash(_seed, x0, y0, z0), fx, fy, fz);
+    float n100 = grad(Hash(_seed, x0 + 1, y0, z0), fx - 1.0f, fy, fz);
+    float n010 = grad(Hash(_seed, x0, y0 + 1, z0), fx, fy - 1.0f, fz);
+    float n110 = grad(Hash(_seed, x0 + 1, y0 + 1, z0), fx - 1.0f, fy - 1.0f, fz);
+    float n001 = grad(Hash(_seed, x0, y0, z0 + 1), fx, fy, fz - 1.0f);
+    float n101 = grad(Hash(_seed, x0 + 1, y0, z0 + 1), fx - 1.0f, fy, fz - 1.0f);
+    float n011 = grad(Hash(_seed, x0, y0 + 1, z0 + 1), fx, fy - 1.0f, fz - 1.0f);
+    float n111 = grad(Hash(_seed, x0 + 1, y0 + 1, z0 + 1), fx - 1.0f, fy - 1.0f, fz - 1.0f);
+
+    float nx00 = lerp(n000, n100, u);
+    float nx10 = lerp(n010, n110, u);
+    float nx01 = lerp(n001, n101, u);
+    float nx11 = lerp(n011, n111, u);
+
+    return lerp(lerp(nx00, nx10, v), lerp(nx01, nx11, v), w);
+}
+
+float NoiseGenerator::Simplex2D(const float _x, const float _y,
+    const uint32_t _seed)
+{
+    // Skew the input space to find the simplex (triangle) we're in, then sum
+    // the radially attenuated contributions of its three corners.
+    //
+    const float F2 = 0.366025403f; // (sqrt(3) - 1) / 2
+    const float G2 = 0.211324865f; // (3 - sqrt(3)) / 6
+
+    float s = (_x + _y) * F2;
+    int i = fastFloor(_x + s);
+    int j = fastFloor(_y + s);
+    float t = (float)(i + j) * G2;
+    float x0 = _x - ((float)i - t);
+    float y0 = _y - ((float)j - t);
+
+    int i1 = (x0 > y0) ? 1 : 0;
+    int j1 = (x0 > y0) ? 0 : 1;
+
+    float x1 = x0 - (float)i1 + G2;
+    float y1 = y0 - (float)j1 + G2;
+    float x2 = x0 - 1.0f + 2.0f * G2;
+    float y2 = y0 - 1.0f + 2.0f * G2;
+
+    float n = 0.0f;
+    float t0 = 0.5f - x0 * x0 - y0 * y0;
+    if (t0 > 0.0f)
+    {
+        t0 *= t0;
+        n += t0 * t0 * grad(Hash(_seed, i, j), x0, y0, 0.0f);
+    }
+    float t1 = 0.5f - x1 * x1 - y1 * y1;
+    if (t1 > 0.0f)
+    {
+        t1 *= t1;
+        n += t1 * t1 * grad(Hash(_seed, i + i1, j + j1), x1, y1, 0.0f);
+    }
+    float t2 = 0.5f - x2 * x2 - y2 * y2;
+    if (t2 > 0.0f)
+    {
+        t2 *= t2;
+        n += t2 * t2 * grad(Hash(_seed, i + 1, j + 1), x2, y2, 0.0f);
+    }
+
+    return 70.0f * n;
+}
+
+float NoiseGenerator::Simplex3D(const float _x, const float _y,
+    const float _z, const uint32_t _seed)
+{
+    const float F3 = 1.0f / 3.0f;
+    const float G3 = 1.0f / 6.0f;
+
+    float s = (_x + _y + _z) * F3;
+    int i = fastFloor(_x + s);
+    int j = fastFloor(_y + s);
+    int k = fastFloor(_z + s);
+    float t = (float)(i + j + k) * G3;
+    float x0 = _x - ((float)i - t);
+    float y0 = _y - ((float)j - t);
+    float z0 = _z - ((float)k - t);
+
+    // Find which of the six tetrahedra of the skewed cube we're in.
+    //
+    int i1, j1, k1, i2, j2, k2;
+    if (x0 >= y0)
+    {
+        if (y0 >= z0)      { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+        else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+        else               { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+    }
+    else
+    {
+        if (y0 < z0)       { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+        else if (x0 < z0)  { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+        else               { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+    }
+
+    float corners[4][3] = {
+        { x0, y0, z0 },
+        { x0 - (float)i1 + G3, y0 - (float)j1 + G3, z0 - (float)k1 + G3 },
+        { x0 - (float)i2 + 2.0f * G3, y0 - (float)j2 + 2.0f * G3, z0 - (float)k2 + 2.0f * G3 },
+        { x0 - 1.0f + 3.0f * G3, y0 - 1.0f + 3.0f * G3, z0 - 1.0f + 3.0f * G3 }
+    };
+    uint32_t hashes[4] = {
+        Hash(_seed, i, j, k),
+        Hash(_seed, i + i1, j + j1, k + k1),
+        Hash(_seed, i + i2, j + j2, k + k2),
+        Hash(_seed, i + 1, j + 1, k + 1)
+    };
+
+    float n = 0.0f;
+    for (int c = 0; c < 4; c++)
+    {
+        float tc = 0.6f - corners[c][0] * corners[c][0] - corners[c][1] * corners[c][1] - 
+            corners[c][2] * corners[c][2];
+        if (tc > 0.0f)
+        {
+            tc *= tc;
+            n += tc * tc * grad(hashes[c], corners[c][0], corners[c][1], corners[c][2]);
         }
     }
 
-    return height_map;
+    return 32.0f * n;
+}
+
+void NoiseGenerator::Evaluate2D(const NOISETYPEenum _type, const float* x,
+    const float* y, float* values,
+    const std::size_t _count, const uint32_t _seed)
+{
+    // The switch is hoisted out of the loops, so each loop is a straight run
+    // over the arrays the compiler can unroll/vectorize.
+    //
+    switch (_type)
+    {
+    case NOISETYPEenum::PERLIN:
+        for (std::size_t i = 0; i < _count; i++)
+        {
+            values[i] = Perlin2D(x[i], y[i], _seed);
+        }
+        break;
+    case NOISETYPEenum::SIMPLEX:
+        for (std::size_t i = 0; i < _count; i++)
+        {
+            values[i] = Simplex2D(x[i], y[i], _seed);
+        }
+        break;
+    default:
+        // Value noise mapped to [-1, 1] like the gradient noises.
+        //
+        for (std::size_t i = 0; i < _count; i++)
+        {
+            int x0 = fastFloor(x[i]);
+            int y0 = fastFloor(y[i]);
+            float fx = x[i] - (float)x0;
+            float fy = y[i] - (float)y0;
+            float top = lerp(latticeValue(_seed, x0, y0), latticeValue(_seed, x0 + 1, y0), fx);
+            float bottom = lerp(latticeValue(_seed, x0, y0 + 1), latticeValue(_seed, x0 + 1, y0 + 1), fx);
+            values[i] = lerp(top, bottom, fy) * 2.0f - 1.0f;
+        }
+        break;
+    }
 }
 
-std::shared_ptr<float[]> NoiseGenerator::generateSeed(const int _width, const int _height,
-    std::mt19937& rnd_eng, std::uniform_real_distribution<float>& dist)
+void NoiseGenerator::Evaluate3D(const NOISETYPEenum _type, const float* x,
+    const float* y, const float* z,
+    float* values, const std::size_t _count,
+    const uint32_t _seed)
 {
-    std::shared_ptr<float[]> sp_seed(new float[_width * _height]);
+    // There is no 3D value noise, everything but simplex is Perlin.
+    //
+    if (_type == NOISETYPEenum::SIMPLEX)
+    {
+        for (std::size_t i = 0; i < _count; i++)
+        {
+            values[i] = Simplex3D(x[i], y[i], z[i], _seed);
+        }
+        return;
+    }
 
-    for (int i = 0; i < _width * _height; i++)
+    for (std::size_t i = 0; i < _count; i++)
     {
-        sp_seed[i] = dist(rnd_eng);
+        values[i] = Perlin3D(x[i], y[i], z[i], _seed);
     }
+}
 
-    return sp_seed;
+const char* NoiseGenerator::GetSimdPath()
+{
+#if defined(NOISE_SIMD_AVX2)
+    return "AVX2";
+#elif defined(NOISE_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "SCALAR";
+#endif
 }
 
-double NoiseGenerator::fade(const double& _t)
+void NoiseGenerator::runRows(const int _width, const int _height,
+    uint32_t thread_count, const std::function<void(int, int)>& rows)
+{
+    // Rows don't depend on each other, every thread gets a contiguous block
+    // of rows. Each sample is computed by the same code with the same 
+    // operation order no matter which thread runs it, so the output is bit
+    // identical for any thread count.
+    //
+    if (thread_count == 0)
+    {
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    std::size_t samples = (std::size_t)_width * _height;
+    std::size_t max_threads = std::max(samples / _MIN_SAMPLES_PER_THREAD_, (std::size_t)1);
+    thread_count = (uint32_t)std::min({ (std::size_t)thread_count, max_threads, (std::size_t)_height });
+
+    if (thread_count <= 1)
+    {
+        rows(0, _height);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    int rows_per_thread = (_height + (int)thread_count - 1) / (int)thread_count;
+    for (int row_start = 0; row_start < _height; row_start += rows_per_thread)
+    {
+        threads.push_back(std::thread(rows, row_start, std::min(row_start + rows_per_thread, _height)));
+    }
+    for (std::size_t i = 0; i < threads.size(); i++)
+    {
+        threads.at(i).join();
+    }
+}
+
+void NoiseGenerator::noiseRows(float* height_map, const int _width,
+    const int _row_start, const int _row_end,
+    const int _octaves, const uint32_t _seed, const int _offset_y,
+    const NoiseGenerator::OctaveColumns& columns)
+{
+    std::vector<float> lattice_top, lattice_bottom, noise(_width);
+
+    for (int y = _row_start; y < _row_end; y++)
+    {
+        std::fill(noise.begin(), noise.end(), 0.0f);
+        int world_y = _offset_y + y;
+
+        for (int o = 0; o < _octaves; o++)
+        {
+            // The two lattice rows around this row, hashed once per row 
+            // instead of four times per sample.
+            //
+            int pitch = columns.pitch.at(o);
+            int cell_count = columns.cell_count.at(o);
+            int sample_y1 = floorDiv(world_y, pitch) * pitch;
+            int sample_y2 = sample_y1 + pitch;
+            float blend_y = (float)(world_y - sample_y1) / (float)pitch;
+
+            lattice_top.resize(cell_count);
+            lattice_bottom.resize(cell_count);
+            for (int c = 0; c < cell_count; c++)
+            {
+                int sample_x = (columns.first_cell.at(o) + c) * pitch;
+                lattice_top.at(c) = latticeValue(_seed, sample_x, sample_y1);
+                lattice_bottom.at(c) = latticeValue(_seed, sample_x, sample_y2);
+            }
+
+            noiseOctaveRow(noise.data(), _width, 
+                columns.cell.data() + (std::size_t)o * _width, 
+                columns.blend.data() + (std::size_t)o * _width,
+                lattice_top.data(), lattice_bottom.data(), blend_y, columns.scale.at(o));
+        }
+
+        float* row = height_map + (std::size_t)y * _width;
+        for (int x = 0; x < _width; x++)
+        {
+            row[x] = noise[x] / columns.scale_acc;
+        }
+    }
+}
+
+void NoiseGenerator::noiseOctaveRow(float* noise, const int _width,
+    const int* cell, const float* blend,
+    const float* lattice_top, const float* lattice_bottom,
+    const float _blend_y, const float _scale)
+{
+    // noise += (blend_y * (bottom - top) + top) * scale, where top and bottom
+    // are the lattice values interpolated along x. The vector paths do the
+    // exact same operations in the same order as the scalar tail, and no
+    // fused multiply-add, so every path gives the same bits.
+    //
+    int x = 0;
+
+#if defined(NOISE_SIMD_AVX2)
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 blend_y = _mm256_set1_ps(_blend_y);
+    const __m256 scale = _mm256_set1_ps(_scale);
+    for (; x + 8 <= _width; x += 8)
+    {
+        __m256i c0 = _mm256_loadu_si256((const __m256i*)(cell + x));
+        __m256i c1 = _mm256_add_epi32(c0, _mm256_set1_epi32(1));
+        __m256 bx = _mm256_loadu_ps(blend + x);
+        __m256 ibx = _mm256_sub_ps(one, bx);
+
+        __m256 t0 = _mm256_i32gather_ps(lattice_top, c0, 4);
+        __m256 t1 = _mm256_i32gather_ps(lattice_top, c1, 4);
+        __m256 b0 = _mm256_i32gather_ps(lattice_bottom, c0, 4);
+        __m256 b1 = _mm256_i32gather_ps(lattice_bottom, c1, 4);
+
+        __m256 sample_t = _mm256_add_ps(_mm256_mul_ps(ibx, t0), _mm256_mul_ps(bx, t1));
+        __m256 sample_b = _mm256_add_ps(_mm256_mul_ps(ibx, b0), _mm256_mul_ps(bx, b1));
+        __m256 value = _mm256_add_ps(_mm256_mul_ps(blend_y, _mm256_sub_ps(sample_b, sample_t)), sample_t);
+
+        __m256 acc = _mm256_loadu_ps(noise + x);
+        _mm256_storeu_ps(noise + x, _mm256_add_ps(acc, _mm256_mul_ps(value, scale)));
+    }
+#elif defined(NOISE_SIMD_SSE2)
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 blend_y = _mm_set1_ps(_blend_y);
+    const __m128 scale = _mm_set1_ps(_scale);
+    for (; x + 4 <= _width; x += 4)
+    {
+        // No gather before AVX2, the lookups are plain loads.
+        //
+        const int* c = cell + x;
+        __m128 t0 = _mm_setr_ps(lattice_top[c[0]], lattice_top[c[1]], lattice_top[c[2]], lattice_top[c[3]]);
+        __m128 t1 = _mm_setr_ps(lattice_top[c[0] + 1], lattice_top[c[1] + 1], lattice_top[c[2] + 1], lattice_top[c[3] + 1]);
+        __m128 b0 = _mm_setr_ps(lattice_bottom[c[0]], lattice_bottom[c[1]], lattice_bottom[c[2]], lattice_bottom[c[3]]);
+        __m128 b1 = _mm_setr_ps(lattice_bottom[c[0] + 1], lattice_bottom[c[1] + 1], lattice_bottom[c[2] + 1], lattice_bottom[c[3] + 1]);
+        __m128 bx = _mm_loadu_ps(blend + x);
+        __m128 ibx = _mm_sub_ps(one, bx);
+
+        __m128 sample_t = _mm_add_ps(_mm_mul_ps(ibx, t0), _mm_mul_ps(bx, t1));
+        __m128 sample_b = _mm_add_ps(_mm_mul_ps(ibx, b0), _mm_mul_ps(bx, b1));
+        __m128 value = _mm_add_ps(_mm_mul_ps(blend_y, _mm_sub_ps(sample_b, sample_t)), sample_t);
+
+        __m128 acc = _mm_loadu_ps(noise + x);
+        _mm_storeu_ps(noise + x, _mm_add_ps(acc, _mm_mul_ps(value, scale)));
+    }
+#endif
+
+    for (; x < _width; x++)
+    {
+        int c = cell[x];
+        float bx = blend[x];
+        float ibx = 1.0f - bx;
+
+        float t0 = ibx * lattice_top[c];
+        float t1 = bx * lattice_top[c + 1];
+        float b0 = ibx * lattice_bottom[c];
+        float b1 = bx * lattice_bottom[c + 1];
+        float sample_t = t0 + t1;
+        float sample_b = b0 + b1;
+
+        float value = _blend_y * (sample_b - sample_t);
+        value = value + sample_t;
+        value = value * _scale;
+        noise[x] = noise[x] + value;
+    }
+}
+
+int NoiseGenerator::floorDiv(const int _a, const int _b)
+{
+    // Integer division rounding towards negative infinity, so lattice cells
+    // stay the same size on both sides of zero.
+    //
+    int q = _a / _b;
+    return (_a % _b != 0 && ((_a < 0) != (_b < 0))) ? q - 1 : q;
+}
+
+int NoiseGenerator::fastFloor(const float _x)
+{
+    int i = (int)_x;
+    return (_x < (float)i) ? i - 1 : i;
+}
+
+uint32_t NoiseGenerator::Hash(const uint32_t _seed, const int _x,
+    const int _y)
+{
+    // Integer hash of a 2D lattice point (murmur3 style finalizer).
+    //
+    uint32_t h = _seed;
+    h ^= (uint32_t)_x * 0x8da6b343u;
+    h ^= (uint32_t)_y * 0xd8163841u;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+uint32_t NoiseGenerator::Hash(const uint32_t _seed, const int _x,
+    const int _y, const int _z)
+{
+    uint32_t h = Hash(_seed, _x, _y);
+    h ^= (uint32_t)_z * 0xcb1ab31fu;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+float NoiseGenerator::latticeValue(const uint32_t _seed, const int _x,
+    const int _y)
+{
+    // Top 24 bits of the hash mapped to [0, 1).
+    //
+    return (float)(Hash(_seed, _x, _y) >> 8) * (1.0f / 16777216.0f);
+}
+
+float NoiseGenerator::fade(const float _t)
 {
-    // THIS IS UNUSED.
     // The equation proposed by Ken Perlin to replace the smoothstep function in 2002.
     // The equation is the following: 6 * t ** 5 - 15 * t ** 4 + 10 * t ** 3
     //
-    return 6 * pow(_t, 5) - 15 * pow(_t, 4) + 10 * pow(_t, 3);
+    return _t * _t * _t * (_t * (_t * 6.0f - 15.0f) + 10.0f);
 }
 
-double NoiseGenerator::lerp(const double& _lo, const double& _hi,
-    const double& _t)
+float NoiseGenerator::lerp(const float _lo, const float _hi,
+    const float _t)
 {
-    // THIS IS UNUSED.
     // Linear interpolate but there is a difference from the ordinary linear interpolation funciton.
     // The normal equation is: t * p1 + (1 - t) * p2, but here we need a value that is between the low and high value,
     // so we can get a smooth transition, hence the equation adds t * the diffenece to the min.
@@ -78,11 +580,14 @@ double NoiseGenerator::lerp(const double& _lo, const double& _hi,
     return _lo + _t * (_hi - _lo);
 }
 
-double NoiseGenerator::grad(const int _hash, const double _x,
-    const double _y, const double _z)
+float NoiseGenerator::grad(const uint32_t _hash, const float _x,
+    const float _y, const float _z)
 {
-    int h = _hash & 15;
-    double u = h < 8 ? _x : _y;
-    double v = h < 4 ? _y : h == 12 || h == 14 ? _x : _z;
+    // One of the 12 cube edge gradients (plus 4 repeats), from the low bits 
+    // of the hash. For 2D noise z is 0 and the gradients fold onto the plane.
+    //
+    uint32_t h = _hash & 15;
+    float u = h < 8 ? _x : _y;
+    float v = h < 4 ? _y : h == 12 || h == 14 ? _x : _z;
     return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
-}
\ No newline at end of file
+}
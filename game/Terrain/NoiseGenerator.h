@@ -6,22 +6,103 @@
 #include <map>
 #include <random>
 #include <cmath>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <functional>
+
+#include "Types/ENoise.h"
+
+// Vector width of the noise kernel, picked at compile time. MSVC defines
+// __AVX2__ with /arch:AVX2, x64 always has SSE2.
+//
+#if defined(__AVX2__)
+#define NOISE_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOISE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
 
 class NoiseGenerator
 {
 public:
     static std::shared_ptr<float[]> PerlinNoise2D(const int _width, const int _height, 
-        const int _octaves = 1, const float _bias = 0.2f);
+        const int _octaves = 1, const float _bias = 0.2f, 
+        const uint32_t _seed = 0, const int _pitch = 0,
+        const int _offset_x = 0, const int _offset_y = 0,
+        uint32_t thread_count = 0);
+    static std::shared_ptr<float[]> FractalNoise2D(const NOISETYPEenum _type, const int _width, 
+        const int _height, const int _octaves = 1, 
+        const float _bias = 0.2f, const uint32_t _seed = 0, 
+        const int _pitch = 0, const int _offset_x = 0, 
+        const int _offset_y = 0, uint32_t thread_count = 0);
+
+    // Gradient noise, stateless. The gradient of a lattice point is picked by
+    // hashing its coordinates with the seed, so there is no permutation table
+    // or seed buffer to build. Output is roughly in [-1, 1].
+    //
+    static float Perlin2D(const float _x, const float _y, 
+        const uint32_t _seed);
+    static float Perlin3D(const float _x, const float _y, 
+        const float _z, const uint32_t _seed);
+    static float Simplex2D(const float _x, const float _y, 
+        const uint32_t _seed);
+    static float Simplex3D(const float _x, const float _y, 
+        const float _z, const uint32_t _seed);
+
+    // Batched versions, values[i] = noise(x[i], y[i](, z[i])). The inputs are
+    // plain arrays so callers can lay out coordinates for a whole row at once.
+    //
+    static void Evaluate2D(const NOISETYPEenum _type, const float* x, 
+        const float* y, float* values, 
+        const std::size_t _count, const uint32_t _seed);
+    static void Evaluate3D(const NOISETYPEenum _type, const float* x, 
+        const float* y, const float* z, 
+        float* values, const std::size_t _count, 
+        const uint32_t _seed);
+
+    static uint32_t Hash(const uint32_t _seed, const int _x, 
+        const int _y);
+    static uint32_t Hash(const uint32_t _seed, const int _x, 
+        const int _y, const int _z);
+    static const char* GetSimdPath();
 
 private:
+    struct OctaveColumns
+    {
+        std::vector<int> cell;
+        std::vector<float> blend;
+        std::vector<int> first_cell;
+        std::vector<int> cell_count;
+        std::vector<int> pitch;
+        std::vector<float> scale;
+        float scale_acc;
+    };
+
+    static const std::size_t _MIN_SAMPLES_PER_THREAD_;
+
     NoiseGenerator();
 
-    static std::shared_ptr<float[]> generateSeed(const int _width, const int _height,
-        std::mt19937& rnd_eng, std::uniform_real_distribution<float>& dist);
+    static void runRows(const int _width, const int _height, 
+        uint32_t thread_count, const std::function<void(int, int)>& rows);
+    static void noiseRows(float* height_map, const int _width,
+        const int _row_start, const int _row_end,
+        const int _octaves, const uint32_t _seed, const int _offset_y,
+        const NoiseGenerator::OctaveColumns& columns);
+    static void noiseOctaveRow(float* noise, const int _width,
+        const int* cell, const float* blend,
+        const float* lattice_top, const float* lattice_bottom,
+        const float _blend_y, const float _scale);
+    static int floorDiv(const int _a, const int _b);
+    static int fastFloor(const float _x);
+
+    static float latticeValue(const uint32_t _seed, const int _x, 
+        const int _y);
 
-    static double fade(const double& _t);
-    static double lerp(const double& _lo, const double& _hi, 
-        const double& _t);
-    static double grad(const int _hash, const double _x, 
-        const double _y, const double _z);
+    static float fade(const float _t);
+    static float lerp(const float _lo, const float _hi, 
+        const float _t);
+    static float grad(const uint32_t _hash, const float _x, 
+        const float _y, const float _z);
 };
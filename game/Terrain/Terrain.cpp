@@ -1,71 +1,204 @@
 #include "Terrain.h"
 
-Terrain::Terrain(const uint32_t _grid_size, const float _height_scale) :
+const float Terrain::_VEGETATION_SCALE_VARIATION_ = 0.2f;
+
+Terrain::Terrain(const uint32_t _grid_size, 
+    const float _height_scale,
+    const TERRMESHenum _mesh_type,
+    const uint32_t _seed,
+    const glm::ivec2 _chunk,
+    const uint32_t _chunk_size,
+    const std::string _cache_directory) :
     _grid_size_(_grid_size),
-    _height_scale_(_height_scale)
+    _height_scale_(_height_scale),
+    _mesh_type_(_mesh_type),
+    _chunk_(_chunk),
+    samples_((_chunk_size == 0) ? _grid_size : _chunk_size + 1),
+    vao_(0),
+    vbo_(0),
+    ebo_(0),
+    uploaded_(false),
+    from_cache_(false),
+    vertex_data_(nullptr),
+    index_data_(nullptr),
+    vertex_count_(0),
+    index_count_(0)
 {
-    TerrainGenerator tg(_grid_size_);
+    // Everything in here is CPU work, so a terrain (chunk) can be built on a 
+    // worker thread. The GL objects are created later by Terrain::Upload,
+    // on the thread that owns the context.
+    // With a cache directory the chunk is loaded from the world cache if it
+    // was generated before with the same key, otherwise it is generated and 
+    // written to the cache.
+    //
+    WorldCache::ChunkKey cache_key = { _seed, _grid_size_, _chunk_size, _chunk_, _mesh_type_, 
+        _height_scale_, TerrainGenerator::GetParameterHash() };
+    std::string cache_path = _cache_directory.empty() ? "" : WorldCache::ChunkPath(_cache_directory, cache_key);
+    if (!cache_path.empty() && loadCache(cache_path, cache_key))
+    {
+        return;
+    }
+
+    TerrainGenerator tg(_grid_size_, _mesh_type_, _seed, _chunk_, _chunk_size);
     grid_ = tg.GetGrid();
-    setupVertices(tg.GetPositions(), tg.GetNormals(), tg.GetColors());
+    if (_mesh_type_ == TERRMESHenum::INDEXED)
+    {
+        setupIndexedVertices(tg.GetPositions(), tg.GetColors(), tg.GetIndices());
+    }
+    else
+    {
+        setupVertices(tg.GetPositions(), tg.GetNormals(), tg.GetColors());
+    }
     setupVegetation(tg.GetTrees(), tg.GetBushes(), tg.GetRocks(), tg.GetGrass());
     setupCollectibles(tg.GetHazelnuts());
-    setupTerrain();
     scaleGridHeight();
+    setupMeshData();
+
+    if (!cache_path.empty())
+    {
+        writeCache(cache_path, cache_key);
+    }
+}
+
+Terrain::~Terrain()
+{
+    if (uploaded_)
+    {
+        glDeleteVertexArrays(1, &vao_);
+        glDeleteBuffers(1, &vbo_);
+        if (_mesh_type_ == TERRMESHenum::INDEXED)
+        {
+            glDeleteBuffers(1, &ebo_);
+        }
+    }
+}
+
+void Terrain::Upload()
+{
+    if (uploaded_)
+    {
+        return;
+    }
+
+    if (_mesh_type_ == TERRMESHenum::INDEXED)
+    {
+        setupTerrainIndexed();
+    }
+    else
+    {
+        setupTerrain();
+    }
+    uploaded_ = true;
+
+    // The GPU has its copy, the mapping isn't needed anymore.
+    //
+    if (from_cache_)
+    {
+        vertex_data_ = nullptr;
+        index_data_ = nullptr;
+        cache_file_.reset();
+    }
 }
 
 void Terrain::Draw(Shader& shader)
 {
+    if (!uploaded_)
+    {
+        return;
+    }
+
     shader.Use();
     shader.SetMat4("model", glm::mat4(1.0f));
 
     glBindVertexArray(vao_);
-    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices_.size());
+    if (_mesh_type_ == TERRMESHenum::INDEXED)
+    {
+        glDrawElements(GL_TRIANGLES, (GLsizei)index_count_, GL_UNSIGNED_INT, (const void*)0);
+    }
+    else
+    {
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertex_count_);
+    }
     glBindVertexArray(0);
 }
 
+bool Terrain::IsUploaded()
+{
+    return uploaded_;
+}
+
+bool Terrain::IsFromCache()
+{
+    return from_cache_;
+}
+
 std::shared_ptr<std::vector<glm::vec3>> Terrain::GetGrid()
 {
     return grid_;
 }
 
+uint32_t Terrain::GetSamplesPerSide()
+{
+    return samples_;
+}
+
+glm::ivec2 Terrain::GetChunk()
+{
+    return _chunk_;
+}
+
 float Terrain::GetHalfDimension()
 {
     return (float)_grid_size_;
 }
 
-std::shared_ptr<std::vector<glm::mat4>> Terrain::GetTree1ModelMats()
+std::size_t Terrain::GetMemoryFootprint()
+{
+    std::size_t instances = tree_1_instances_->size() + tree_2_instances_->size() + 
+        tree_3_instances_->size() + bush_instances_->size() + rock_instances_->size() + 
+        grass_instances_->size() + hazelnut_instances_->size();
+
+    return vertices_.size() * sizeof(Terrain::Vertex) +
+        indexed_vertices_.size() * sizeof(Terrain::IndexedVertex) +
+        indices_.size() * sizeof(uint32_t) +
+        grid_->size() * sizeof(glm::vec3) +
+        instances * sizeof(Instance) +
+        (cache_file_ ? cache_file_->GetSize() : 0);
+}
+
+std::shared_ptr<std::vector<Instance>> Terrain::GetTree1Instances()
 {
-    return tree_1_model_mats_;
+    return tree_1_instances_;
 }
 
-std::shared_ptr<std::vector<glm::mat4>> Terrain::GetTree2ModelMats()
+std::shared_ptr<std::vector<Instance>> Terrain::GetTree2Instances()
 {
-    return tree_2_model_mats_;
+    return tree_2_instances_;
 }
 
-std::shared_ptr<std::vector<glm::mat4>> Terrain::GetTree3ModelMats()
+std::shared_ptr<std::vector<Instance>> Terrain::GetTree3Instances()
 {
-    return tree_3_model_mats_;
+    return tree_3_instances_;
 }
 
-std::shared_ptr<std::vector<glm::mat4>> Terrain::GetBushModelMats()
+std::shared_ptr<std::vector<Instance>> Terrain::GetBushInstances()
 {
-    return bush_model_mats_;
+    return bush_instances_;
 }
 
-std::shared_ptr<std::vector<glm::mat4>> Terrain::GetRockModelMats()
+std::shared_ptr<std::vector<Instance>> Terrain::GetRockInstances()
 {
-    return rock_model_mats_;
+    return rock_instances_;
 }
 
-std::shared_ptr<std::vector<glm::mat4>> Terrain::GetGrassModelMats()
+std::shared_ptr<std::vector<Instance>> Terrain::GetGrassInstances()
 {
-    return grass_model_mats_;
+    return grass_instances_;
 }
 
-std::shared_ptr<std::vector<glm::mat4>> Terrain::GetHazelnutMats()
+std::shared_ptr<std::vector<Instance>> Terrain::GetHazelnutInstances()
 {
-    return hazelnut_model_mats_;
+    return hazelnut_instances_;
 }
 
 void Terrain::setupVertices(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, 
@@ -84,10 +217,25 @@ void Terrain::setupVertices(std::vector<glm::vec3>& positions, std::vector<glm::
     }
 }
 
+void Terrain::setupIndexedVertices(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& colors,
+    std::vector<uint32_t>& indices)
+{
+    glm::mat4 mod_p_transform = getPositionTransform();
+    indexed_vertices_.reserve(positions.size());
+    for (std::size_t i = 0; i < positions.size(); i++)
+    {
+        Terrain::IndexedVertex vertex;
+        vertex.position = glm::vec3(mod_p_transform * glm::vec4(positions.at(i), 1.0f));
+        vertex.color = colors.at(i);
+        indexed_vertices_.push_back(vertex);
+    }
+    indices_ = indices;
+}
+
 void Terrain::setupVegetation(std::vector<glm::vec3>& trees, std::vector<glm::vec3>& bushes, 
     std::vector<glm::vec3>& rocks, std::vector<glm::vec3>& grass)
 {
-    std::vector<glm::mat4> tree_1_mod_mats, tree_2_mod_mats, tree_3_mod_mats, bush_mod_mats, rock_mod_mats, grass_mod_mats;
+    std::vector<Instance> tree_1_instances, tree_2_instances, tree_3_instances, bush_instances, rock_instances, grass_instances;
     glm::mat4 mod_transform = getPositionTransform();
 
     for (std::size_t i = 0; i < trees.size(); i++)
@@ -98,53 +246,159 @@ void Terrain::setupVegetation(std::vector<glm::vec3>& trees, std::vector<glm::ve
         //
         if (i < trees.size() / 5)
         {
-            tree_1_mod_mats.push_back(glm::translate(glm::mat4(1.0f), trees.at(i)));
+            tree_1_instances.push_back(randomInstance(trees.at(i), 0, _VEGETATION_SCALE_VARIATION_));
         }
         else if (i < (trees.size() / 5) * 3)
         {
-            tree_2_mod_mats.push_back(glm::translate(glm::mat4(1.0f), trees.at(i)));
+            tree_2_instances.push_back(randomInstance(trees.at(i), 1, _VEGETATION_SCALE_VARIATION_));
         }
         else if (i < trees.size())
         {
-            tree_3_mod_mats.push_back(glm::translate(glm::mat4(1.0f), trees.at(i)));
+            tree_3_instances.push_back(randomInstance(trees.at(i), 2, _VEGETATION_SCALE_VARIATION_));
         }
     }
     for (std::size_t i = 0; i < bushes.size(); i++)
     {
         bushes.at(i) = glm::vec3(mod_transform * glm::vec4(bushes.at(i), 1.0f));
-        bush_mod_mats.push_back(glm::translate(glm::mat4(1.0f), bushes.at(i)));
+        bush_instances.push_back(randomInstance(bushes.at(i), 3, _VEGETATION_SCALE_VARIATION_));
     }
     for (std::size_t i = 0; i < rocks.size(); i++)
     {
         rocks.at(i) = glm::vec3(mod_transform * glm::vec4(rocks.at(i), 1.0f));
-        rock_mod_mats.push_back(glm::translate(glm::mat4(1.0f), rocks.at(i)));
+        rock_instances.push_back(randomInstance(rocks.at(i), 4, _VEGETATION_SCALE_VARIATION_));
     }
     for (std::size_t i = 0; i < grass.size(); i++)
     {
         grass.at(i) = glm::vec3(mod_transform * glm::vec4(grass.at(i), 1.0f));
-        grass_mod_mats.push_back(glm::translate(glm::mat4(1.0f), grass.at(i)));
+        grass_instances.push_back(randomInstance(grass.at(i), 5, _VEGETATION_SCALE_VARIATION_));
     }
 
-    tree_1_model_mats_ = std::make_shared<std::vector<glm::mat4>>(tree_1_mod_mats);
-    tree_2_model_mats_ = std::make_shared<std::vector<glm::mat4>>(tree_2_mod_mats);
-    tree_3_model_mats_ = std::make_shared<std::vector<glm::mat4>>(tree_3_mod_mats);
-    bush_model_mats_ = std::make_shared<std::vector<glm::mat4>>(bush_mod_mats);
-    rock_model_mats_ = std::make_shared<std::vector<glm::mat4>>(rock_mod_mats);
-    grass_model_mats_ = std::make_shared<std::vector<glm::mat4>>(grass_mod_mats);
+    tree_1_instances_ = std::make_shared<std::vector<Instance>>(tree_1_instances);
+    tree_2_instances_ = std::make_shared<std::vector<Instance>>(tree_2_instances);
+    tree_3_instances_ = std::make_shared<std::vector<Instance>>(tree_3_instances);
+    bush_instances_ = std::make_shared<std::vector<Instance>>(bush_instances);
+    rock_instances_ = std::make_shared<std::vector<Instance>>(rock_instances);
+    grass_instances_ = std::make_shared<std::vector<Instance>>(grass_instances);
 }
 
 void Terrain::setupCollectibles(std::vector<glm::vec3>& hazelnuts)
 {
-    std::vector<glm::mat4> hz_mats;
+    std::vector<Instance> hz_instances;
     glm::mat4 mod_transform = getPositionTransform();
 
+    // Hazelnuts only get a random rotation, they all stay the same size.
+    //
     for (std::size_t i = 0; i < hazelnuts.size(); i++)
     {
         hazelnuts.at(i) = glm::vec3(mod_transform * glm::vec4(hazelnuts.at(i), 1.0f));
-        hz_mats.push_back(glm::translate(glm::mat4(1.0f), hazelnuts.at(i)));
+        hz_instances.push_back(randomInstance(hazelnuts.at(i), 6, 0.0f));
     }
 
-    hazelnut_model_mats_ = std::make_shared<std::vector<glm::mat4>>(hz_mats);
+    hazelnut_instances_ = std::make_shared<std::vector<Instance>>(hz_instances);
+}
+
+Instance Terrain::randomInstance(glm::vec3 position, const uint32_t _type, const float _scale_variation)
+{
+    // Rotation and scale are hashed from the world position, so a chunk that
+    // is generated again gets exactly the same instances.
+    //
+    uint32_t hash = NoiseGenerator::Hash(_type, (int)std::floor(position.x * 16.0f), (int)std::floor(position.z * 16.0f));
+    float yaw = (float)(hash & 0xffff) / 65535.0f * glm::two_pi<float>();
+    float scale = 1.0f + _scale_variation * ((float)(hash >> 16) / 65535.0f * 2.0f - 1.0f);
+    return Instance::Pack(position, yaw, scale);
+}
+
+void Terrain::setupMeshData()
+{
+    if (_mesh_type_ == TERRMESHenum::INDEXED)
+    {
+        vertex_data_ = indexed_vertices_.data();
+        vertex_count_ = indexed_vertices_.size();
+        index_data_ = indices_.data();
+        index_count_ = indices_.size();
+    }
+    else
+    {
+        vertex_data_ = vertices_.data();
+        vertex_count_ = vertices_.size();
+    }
+}
+
+bool Terrain::loadCache(const std::string _path, const WorldCache::ChunkKey& key)
+{
+    std::shared_ptr<MappedFile> file = WorldCache::Open(_path, key);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::size_t vertex_size = (_mesh_type_ == TERRMESHenum::INDEXED) ? sizeof(Terrain::IndexedVertex) : sizeof(Terrain::Vertex);
+    WorldCache::Section grid = WorldCache::GetSection(*file, WCSECTIONenum::GRID);
+    WorldCache::Section vertices = WorldCache::GetSection(*file, WCSECTIONenum::VERTICES);
+    WorldCache::Section indices = WorldCache::GetSection(*file, WCSECTIONenum::INDICES);
+    if (grid.element_size != sizeof(glm::vec3) || grid.count != (uint64_t)samples_ * samples_ ||
+        vertices.element_size != vertex_size || indices.element_size != sizeof(uint32_t))
+    {
+        std::cout << "ERROR::TERRAIN::LOAD_CACHE::LAYOUT_MISMATCH::" << _path << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<std::vector<Instance>>* instances[] = { 
+        &tree_1_instances_, &tree_2_instances_, &tree_3_instances_, &bush_instances_, 
+        &rock_instances_, &grass_instances_, &hazelnut_instances_ 
+    };
+    for (int i = 0; i < 7; i++)
+    {
+        WorldCache::Section section = WorldCache::GetSection(*file, (WCSECTIONenum)((int)WCSECTIONenum::TREE_1 + i));
+        if (section.element_size != sizeof(Instance))
+        {
+            std::cout << "ERROR::TERRAIN::LOAD_CACHE::LAYOUT_MISMATCH::" << _path << std::endl;
+            return false;
+        }
+    }
+
+    // The grid and instances are read and modified later (height 
+    // queries, collected hazelnuts), so they get one bulk copy each. The mesh
+    // data stays in the mapping until Upload.
+    //
+    const glm::vec3* grid_data = (const glm::vec3*)grid.data;
+    grid_ = std::make_shared<std::vector<glm::vec3>>(grid_data, grid_data + grid.count);
+    for (int i = 0; i < 7; i++)
+    {
+        WorldCache::Section section = WorldCache::GetSection(*file, (WCSECTIONenum)((int)WCSECTIONenum::TREE_1 + i));
+        const Instance* instance_data = (const Instance*)section.data;
+        *instances[i] = std::make_shared<std::vector<Instance>>(instance_data, instance_data + section.count);
+    }
+
+    vertex_data_ = vertices.data;
+    vertex_count_ = (std::size_t)vertices.count;
+    index_data_ = (const uint32_t*)indices.data;
+    index_count_ = (std::size_t)indices.count;
+    cache_file_ = file;
+    from_cache_ = true;
+    return true;
+}
+
+void Terrain::writeCache(const std::string _path, const WorldCache::ChunkKey& key)
+{
+    std::size_t vertex_size = (_mesh_type_ == TERRMESHenum::INDEXED) ? sizeof(Terrain::IndexedVertex) : sizeof(Terrain::Vertex);
+    std::vector<WorldCache::Section> sections = {
+        { grid_->data(), grid_->size(), sizeof(glm::vec3) },
+        { vertex_data_, vertex_count_, vertex_size },
+        { index_data_, index_count_, sizeof(uint32_t) },
+        { tree_1_instances_->data(), tree_1_instances_->size(), sizeof(Instance) },
+        { tree_2_instances_->data(), tree_2_instances_->size(), sizeof(Instance) },
+        { tree_3_instances_->data(), tree_3_instances_->size(), sizeof(Instance) },
+        { bush_instances_->data(), bush_instances_->size(), sizeof(Instance) },
+        { rock_instances_->data(), rock_instances_->size(), sizeof(Instance) },
+        { grass_instances_->data(), grass_instances_->size(), sizeof(Instance) },
+        { hazelnut_instances_->data(), hazelnut_instances_->size(), sizeof(Instance) }
+    };
+
+    if (!WorldCache::Write(_path, key, sections))
+    {
+        std::cout << "ERROR::TERRAIN::WRITE_CACHE::FAILED::" << _path << std::endl;
+    }
 }
 
 void Terrain::setupTerrain()
@@ -155,7 +409,7 @@ void Terrain::setupTerrain()
     glBindVertexArray(vao_);
 
     glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Terrain::Vertex) * vertices_.size(), vertices_.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Terrain::Vertex) * vertex_count_, vertex_data_, GL_STATIC_DRAW);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(
@@ -188,6 +442,75 @@ void Terrain::setupTerrain()
     glBindVertexArray(0);
 }
 
+void Terrain::setupTerrainIndexed()
+{
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glGenBuffers(1, &ebo_);
+
+    glBindVertexArray(vao_);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Terrain::IndexedVertex) * vertex_count_, vertex_data_, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * index_count_, index_data_, GL_STATIC_DRAW);
+
+    // No normal attribute (location 1), lowPolyTerrain.frag computes the face 
+    // normal itself.
+    //
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(
+        0,
+        3,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(Terrain::IndexedVertex),
+        (const void*)offsetof(Terrain::IndexedVertex, Terrain::IndexedVertex::position)
+    );
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(
+        2,
+        3,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(Terrain::IndexedVertex),
+        (const void*)offsetof(Terrain::IndexedVertex, Terrain::IndexedVertex::color)
+    );
+
+    glBindVertexArray(0);
+}
+
+void Terrain::PrintMeshStats()
+{
+    // The flat array layout stores 6 vertices per grid quad, this is what it would
+    // cost for the same grid, so both paths can be compared from the startup log.
+    //
+    std::size_t quads = (std::size_t)(samples_ - 1) * (samples_ - 1);
+    std::size_t flat_vertex_count = quads * 6;
+    std::size_t flat_bytes = flat_vertex_count * sizeof(Terrain::Vertex);
+
+    std::size_t vertex_count, bytes;
+    if (_mesh_type_ == TERRMESHenum::INDEXED)
+    {
+        vertex_count = vertex_count_;
+        bytes = vertex_count_ * sizeof(Terrain::IndexedVertex) + index_count_ * sizeof(uint32_t);
+    }
+    else
+    {
+        vertex_count = vertex_count_;
+        bytes = vertex_count_ * sizeof(Terrain::Vertex);
+    }
+
+    std::cout << "INFO::TERRAIN::PRINT_MESH_STATS" << std::endl;
+    std::cout << "Chunk:" << _chunk_.x << "," << _chunk_.y << "|Samples per side:" << samples_ << std::endl;
+    std::cout << "Mesh type:" << ((_mesh_type_ == TERRMESHenum::INDEXED) ? "INDEXED" : "FLAT_ARRAYS") << std::endl;
+    std::cout << "Vertices:" << vertex_count << "|Indices:" << index_count_ << "|From cache:" << from_cache_ << std::endl;
+    std::cout << "Mesh data:" << bytes / 1024 << "KB" << std::endl;
+    std::cout << "Flat arrays would be:" << flat_vertex_count << " vertices, " 
+        << flat_bytes / 1024 << "KB" << std::endl;
+}
+
 glm::mat4 Terrain::getPositionTransform()
 {
     glm::mat4 mod_position = glm::mat4(1.0f);
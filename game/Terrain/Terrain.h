@@ -11,6 +11,9 @@
 
 #include <Renderer/Shader.h>
 #include <Terrain/TerrainGenerator.h>
+#include <Types/ETerrain.h>
+#include <Cache/WorldCache.h>
+#include <Types/Instance.h>
 
 class Terrain
 {
@@ -22,44 +25,93 @@ public:
         glm::vec3 color;
     };
 
+    struct IndexedVertex
+    {
+        glm::vec3 position;
+        glm::vec3 color;
+    };
+
     std::vector<Terrain::Vertex> vertices_;
+    std::vector<Terrain::IndexedVertex> indexed_vertices_;
+    std::vector<uint32_t> indices_;
+
+    Terrain(const uint32_t _grid_size = 256, 
+        const float _height_scale = 10.0f,
+        const TERRMESHenum _mesh_type = TERRMESHenum::INDEXED,
+        const uint32_t _seed = 0,
+        const glm::ivec2 _chunk = glm::ivec2(0),
+        const uint32_t _chunk_size = 0,
+        const std::string _cache_directory = "");
+    ~Terrain();
 
-    Terrain(const uint32_t _grid_size = 256, const float _height_scale = 10.0f);
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
 
+    void Upload();
     void Draw(Shader& shader);
+    void PrintMeshStats();
 
+    bool IsUploaded();
+    bool IsFromCache();
     std::shared_ptr<std::vector<glm::vec3>> GetGrid();
+    uint32_t GetSamplesPerSide();
+    glm::ivec2 GetChunk();
     float GetHalfDimension();
+    std::size_t GetMemoryFootprint();
 
-    std::shared_ptr<std::vector<glm::mat4>> GetTree1ModelMats();
-    std::shared_ptr<std::vector<glm::mat4>> GetTree2ModelMats();
-    std::shared_ptr<std::vector<glm::mat4>> GetTree3ModelMats();
-    std::shared_ptr<std::vector<glm::mat4>> GetBushModelMats();
-    std::shared_ptr<std::vector<glm::mat4>> GetRockModelMats();
-    std::shared_ptr<std::vector<glm::mat4>> GetGrassModelMats();
-    std::shared_ptr<std::vector<glm::mat4>> GetHazelnutMats();
+    std::shared_ptr<std::vector<Instance>> GetTree1Instances();
+    std::shared_ptr<std::vector<Instance>> GetTree2Instances();
+    std::shared_ptr<std::vector<Instance>> GetTree3Instances();
+    std::shared_ptr<std::vector<Instance>> GetBushInstances();
+    std::shared_ptr<std::vector<Instance>> GetRockInstances();
+    std::shared_ptr<std::vector<Instance>> GetGrassInstances();
+    std::shared_ptr<std::vector<Instance>> GetHazelnutInstances();
 
 private:
     const uint32_t _grid_size_;
     const float _height_scale_;
+    const TERRMESHenum _mesh_type_;
+    const glm::ivec2 _chunk_;
     std::shared_ptr<std::vector<glm::vec3>> grid_;
+    uint32_t samples_;
+
+    uint32_t vao_, vbo_, ebo_;
+    bool uploaded_;
+
+    // What Upload sends to the GPU. Points into vertices_/indexed_vertices_ 
+    // and indices_ for generated terrain, or straight into the mapped cache
+    // file, which is released once uploaded.
+    //
+    std::shared_ptr<MappedFile> cache_file_;
+    bool from_cache_;
+    const void* vertex_data_;
+    const uint32_t* index_data_;
+    std::size_t vertex_count_;
+    std::size_t index_count_;
 
-    uint32_t vao_, vbo_;
+    std::shared_ptr<std::vector<Instance>> tree_1_instances_;
+    std::shared_ptr<std::vector<Instance>> tree_2_instances_;
+    std::shared_ptr<std::vector<Instance>> tree_3_instances_;
+    std::shared_ptr<std::vector<Instance>> bush_instances_;
+    std::shared_ptr<std::vector<Instance>> rock_instances_;
+    std::shared_ptr<std::vector<Instance>> grass_instances_;
+    std::shared_ptr<std::vector<Instance>> hazelnut_instances_;
 
-    std::shared_ptr<std::vector<glm::mat4>> tree_1_model_mats_;
-    std::shared_ptr<std::vector<glm::mat4>> tree_2_model_mats_;
-    std::shared_ptr<std::vector<glm::mat4>> tree_3_model_mats_;
-    std::shared_ptr<std::vector<glm::mat4>> bush_model_mats_;
-    std::shared_ptr<std::vector<glm::mat4>> rock_model_mats_;
-    std::shared_ptr<std::vector<glm::mat4>> grass_model_mats_;
-    std::shared_ptr<std::vector<glm::mat4>> hazelnut_model_mats_;
+    static const float _VEGETATION_SCALE_VARIATION_;
 
     void setupVertices(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals,
         std::vector<glm::vec3>& colors);
+    void setupIndexedVertices(std::vector<glm::vec3>& positions, std::vector<glm::vec3>& colors,
+        std::vector<uint32_t>& indices);
     void setupVegetation(std::vector<glm::vec3>& trees, std::vector<glm::vec3>& bushes,
         std::vector<glm::vec3>& rocks, std::vector<glm::vec3>& grass);
     void setupCollectibles(std::vector<glm::vec3>& hazelnuts);
+    Instance randomInstance(glm::vec3 position, const uint32_t _type, const float _scale_variation);
+    void setupMeshData();
+    bool loadCache(const std::string _path, const WorldCache::ChunkKey& key);
+    void writeCache(const std::string _path, const WorldCache::ChunkKey& key);
     void setupTerrain();
+    void setupTerrainIndexed();
     glm::mat4 getPositionTransform();
     void scaleGridHeight();
 };
@@ -1,20 +1,67 @@
 #include "Terrain/TerrainGenerator.h"
 
-TerrainGenerator::TerrainGenerator(const uint32_t _grid_size) :
-    _grid_size_(_grid_size)
+const int TerrainGenerator::_NOISE_OCTAVES_ = 6;
+const int TerrainGenerator::_NOISE_PITCH_ = 128;
+const float TerrainGenerator::_NOISE_BIAS_ = 0.2f;
+const NOISETYPEenum TerrainGenerator::_NOISE_TYPE_ = NOISETYPEenum::VALUE;
+const float TerrainGenerator::_VEGETATION_DENSITY_ = 38.0f / 128.0f;
+
+TerrainGenerator::TerrainGenerator(const uint32_t _grid_size, 
+    const TERRMESHenum _mesh_type,
+    const uint32_t _seed,
+    const glm::ivec2 _chunk,
+    const uint32_t _chunk_size) :
+    _grid_size_(_grid_size),
+    _mesh_type_(_mesh_type),
+    _seed_(_seed),
+    _chunk_(_chunk),
+    _chunk_size_(_chunk_size),
+    _samples_((_chunk_size == 0) ? _grid_size : _chunk_size + 1),
+    _origin_(_chunk * (int)_chunk_size)
 {
+    // With a chunk size of 0 the generator builds the whole grid_size x grid_size
+    // map at once. Otherwise it builds the chunk_size x chunk_size quads of a single
+    // chunk. The chunk stores one extra row and column of samples, which are the
+    // first row and column of its neighbour, so adjacent chunks connect seamlessly.
+    // Positions are always normalized by the full grid size, so Terrain's position 
+    // transform places every chunk in the same world space.
+    //
+    PROFILE_SCOPE("TerrainGenerator::TerrainGenerator");
     generateHeightMap();
     generateGrid();
-    generateVertexPositions();
+    if (_mesh_type_ == TERRMESHenum::INDEXED)
+    {
+        generateIndexedVertexPositions();
+    }
+    else
+    {
+        generateVertexPositions();
+    }
     generateVertexColors();
     generateVegetationPositions();
 }
 
+uint32_t TerrainGenerator::GetParameterHash()
+{
+    // Everything besides the seed, grid and chunk that changes the generated
+    // terrain, used to tell stale world cache files apart.
+    //
+    uint32_t hash = NoiseGenerator::Hash(0, _NOISE_OCTAVES_, _NOISE_PITCH_);
+    hash = NoiseGenerator::Hash(hash, (int)_NOISE_TYPE_, (int)(_NOISE_BIAS_ * 1000000.0f));
+    hash = NoiseGenerator::Hash(hash, (int)(_VEGETATION_DENSITY_ * 1000000.0f), 0);
+    return hash;
+}
+
 std::shared_ptr<std::vector<glm::vec3>> TerrainGenerator::GetGrid()
 {
     return grid_;
 }
 
+uint32_t TerrainGenerator::GetSamplesPerSide()
+{
+    return _samples_;
+}
+
 std::vector<glm::vec3>& TerrainGenerator::GetPositions()
 {
     return positions_;
@@ -30,6 +77,11 @@ std::vector<glm::vec3>& TerrainGenerator::GetColors()
     return colors_;
 }
 
+std::vector<uint32_t>& TerrainGenerator::GetIndices()
+{
+    return indices_;
+}
+
 std::vector<glm::vec3>& TerrainGenerator::GetTrees()
 {
     return tree_positions_;
@@ -57,19 +109,30 @@ std::vector<glm::vec3>& TerrainGenerator::GetHazelnuts()
 
 void TerrainGenerator::generateHeightMap()
 {
-    height_map_ = NoiseGenerator::PerlinNoise2D(_grid_size_, _grid_size_, 6);
+    PROFILE_SCOPE("TerrainGenerator::generateHeightMap");
+    // The height map is indexed [i * samples + j] with i along world x and j along
+    // world z, i.e. noise x runs along world z and noise y along world x.
+    //
+    int pitch = (_chunk_size_ == 0) ? (int)_grid_size_ : _NOISE_PITCH_;
+    // _NOISE_TYPE_ picks the noise source, VALUE is the original hashed value
+    // noise, PERLIN and SIMPLEX are the gradient noises.
+    //
+    height_map_ = NoiseGenerator::FractalNoise2D(_NOISE_TYPE_, _samples_, _samples_, _NOISE_OCTAVES_, 
+        _NOISE_BIAS_, _seed_, pitch, _origin_.y, _origin_.x);
 }
 
 void TerrainGenerator::generateGrid()
 {
+    PROFILE_SCOPE("TerrainGenerator::generateGrid");
     std::vector<glm::vec3> grid;
-    for (std::size_t i = 0; i < _grid_size_; i++)
+    grid.reserve((std::size_t)_samples_ * _samples_);
+    for (std::size_t i = 0; i < _samples_; i++)
     {
-        for (std::size_t j = 0; j < _grid_size_; j++)
+        for (std::size_t j = 0; j < _samples_; j++)
         {
-            float x = (float)i / (float)_grid_size_;
-            float y = height_map_[i * _grid_size_ + j];
-            float z = (float)j / (float)_grid_size_;
+            float x = (float)(_origin_.x + i) / (float)_grid_size_;
+            float y = height_map_[i * _samples_ + j];
+            float z = (float)(_origin_.y + j) / (float)_grid_size_;
             grid.push_back(glm::vec3(x, y, z));
         }
     }
@@ -85,15 +148,16 @@ void TerrainGenerator::generateVertexPositions()
     // b.) each vertex can have its own normal.
     // This does introduce a performance penalty, but I choose to ignore it for now.
     //
+    PROFILE_SCOPE("TerrainGenerator::generateVertexPositions");
     int q0, q1, q2, q3;
-    for (std::size_t x = 0; x < _grid_size_ - 1; x++)
+    for (std::size_t x = 0; x < _samples_ - 1; x++)
     {
-        for (std::size_t y = 0; y < _grid_size_ - 1; y++)
+        for (std::size_t y = 0; y < _samples_ - 1; y++)
         {
-            q0 = x * _grid_size_ + y;
-            q1 = x * _grid_size_ + (y + 1);
-            q2 = (x + 1) * _grid_size_ + y;
-            q3 = (x + 1) * _grid_size_ + (y + 1);
+            q0 = x * _samples_ + y;
+            q1 = x * _samples_ + (y + 1);
+            q2 = (x + 1) * _samples_ + y;
+            q3 = (x + 1) * _samples_ + (y + 1);
 
             // The indices of each triangle need to be in CCW order, since we've 
             // set GL_CCW as front face, and OpenGL will cull back faces.
@@ -124,18 +188,47 @@ void TerrainGenerator::generateVertexPositions()
     }
 }
 
-void TerrainGenerator::generateVertexColors()
+void TerrainGenerator::generateIndexedVertexPositions()
 {
-    glm::vec3 woodland_color(0.364f, 0.729f, 0.254f);
+    // Every grid point is stored exactly once and the quads reference it through
+    // the index buffer. There are no per-vertex normals here, the low-poly look
+    // comes from the fragment shader, which derives the face normal from the
+    // screen-space derivatives of the fragment position.
+    //
+    PROFILE_SCOPE("TerrainGenerator::generateIndexedVertexPositions");
+    positions_ = *grid_;
+    indices_.reserve((std::size_t)(_samples_ - 1) * (_samples_ - 1) * 6);
 
-    for (std::size_t i = 0; i < positions_.size(); i+=3)
+    uint32_t q0, q1, q2, q3;
+    for (uint32_t x = 0; x < _samples_ - 1; x++)
     {
-        colors_.push_back(woodland_color);
-        colors_.push_back(woodland_color);
-        colors_.push_back(woodland_color);
+        for (uint32_t y = 0; y < _samples_ - 1; y++)
+        {
+            q0 = x * _samples_ + y;
+            q1 = x * _samples_ + (y + 1);
+            q2 = (x + 1) * _samples_ + y;
+            q3 = (x + 1) * _samples_ + (y + 1);
+
+            // Same CCW winding as TerrainGenerator::generateVertexPositions.
+            //
+            indices_.push_back(q0);
+            indices_.push_back(q1);
+            indices_.push_back(q2);
+            indices_.push_back(q2);
+            indices_.push_back(q1);
+            indices_.push_back(q3);
+        }
     }
 }
 
+void TerrainGenerator::generateVertexColors()
+{
+    PROFILE_SCOPE("TerrainGenerator::generateVertexColors");
+    glm::vec3 woodland_color(0.364f, 0.729f, 0.254f);
+
+    colors_.assign(positions_.size(), woodland_color);
+}
+
 glm::vec3 TerrainGenerator::calculateTriangleNormal(glm::vec3 v0, glm::vec3 v1, 
     glm::vec3 v2)
 {
@@ -151,14 +244,30 @@ glm::vec3 TerrainGenerator::calculateTriangleNormal(glm::vec3 v0, glm::vec3 v1,
 
 void TerrainGenerator::generateVegetationPositions()
 {
-    std::mt19937 rnd_eng(std::random_device{}());
-    std::vector<glm::vec3> sample;
+    // Vegetation is placed on the chunk's own samples only, not on the shared
+    // row and column that belong to the neighbouring chunks. The random engine
+    // is seeded from the world seed and the chunk coordinates, so a chunk that 
+    // is evicted and generated again looks exactly the same.
+    //
+    PROFILE_SCOPE("TerrainGenerator::generateVegetationPositions");
+    std::mt19937 rnd_eng(NoiseGenerator::Hash(_seed_, _chunk_.x, _chunk_.y));
+    std::vector<glm::vec3> own_samples, sample;
+
+    uint32_t own = (_chunk_size_ == 0) ? _samples_ : _chunk_size_;
+    own_samples.reserve((std::size_t)own * own);
+    for (std::size_t i = 0; i < own; i++)
+    {
+        for (std::size_t j = 0; j < own; j++)
+        {
+            own_samples.push_back(grid_->at(i * _samples_ + j));
+        }
+    }
 
     std::sample(
-        grid_->begin(), 
-        grid_->end(), 
+        own_samples.begin(), 
+        own_samples.end(), 
         std::back_inserter(sample),
-        _grid_size_ * 38,
+        (std::size_t)(own_samples.size() * _VEGETATION_DENSITY_),
         rnd_eng
     );
     std::shuffle(
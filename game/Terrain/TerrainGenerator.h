@@ -14,17 +14,28 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Terrain/NoiseGenerator.h"
+#include "Profiler/Profiler.h"
+#include "Types/ETerrain.h"
+#include "Types/ENoise.h"
 
 class TerrainGenerator
 {
 public:
-    TerrainGenerator(const uint32_t _grid_size = 256);
+    TerrainGenerator(const uint32_t _grid_size = 256, 
+        const TERRMESHenum _mesh_type = TERRMESHenum::INDEXED,
+        const uint32_t _seed = 0,
+        const glm::ivec2 _chunk = glm::ivec2(0),
+        const uint32_t _chunk_size = 0);
+
+    static uint32_t GetParameterHash();
 
     std::shared_ptr<std::vector<glm::vec3>> GetGrid();
+    uint32_t GetSamplesPerSide();
 
     std::vector<glm::vec3>& GetPositions();
     std::vector<glm::vec3>& GetNormals();
     std::vector<glm::vec3>& GetColors();
+    std::vector<uint32_t>& GetIndices();
 
     std::vector<glm::vec3>& GetTrees();
     std::vector<glm::vec3>& GetBushes();
@@ -34,12 +45,19 @@ public:
 
 private:
     const uint32_t _grid_size_;
+    const TERRMESHenum _mesh_type_;
+    const uint32_t _seed_;
+    const glm::ivec2 _chunk_;
+    const uint32_t _chunk_size_;
+    const uint32_t _samples_;
+    const glm::ivec2 _origin_;
     std::shared_ptr<float[]> height_map_;
     std::shared_ptr<std::vector<glm::vec3>> grid_;
 
     std::vector<glm::vec3> positions_;
     std::vector<glm::vec3> normals_;
     std::vector<glm::vec3> colors_;
+    std::vector<uint32_t> indices_;
 
     std::vector<glm::vec3> tree_positions_;
     std::vector<glm::vec3> bush_positions_;
@@ -47,9 +65,16 @@ private:
     std::vector<glm::vec3> grass_positions_;
     std::vector<glm::vec3> hazelnut_positions_;
 
+    static const int _NOISE_OCTAVES_;
+    static const int _NOISE_PITCH_;
+    static const float _NOISE_BIAS_;
+    static const NOISETYPEenum _NOISE_TYPE_;
+    static const float _VEGETATION_DENSITY_;
+
     void generateHeightMap();
     void generateGrid();
     void generateVertexPositions();
+    void generateIndexedVertexPositions();
     void generateVertexColors();
     void generateVegetationPositions();
     glm::vec3 calculateTriangleNormal(glm::vec3 v0, glm::vec3 v1, 
@@ -59,8 +59,8 @@ inline bool AABB::Contains(glm::vec3 oth_pos)
 
 inline bool AABB::Collides(AABB oth_bbx)
 {
-	return ((XMax() >= oth_bbx.XMin() || XMin() <= oth_bbx.XMax()) &&
-		(ZMax() >= oth_bbx.ZMin() || ZMin() <= oth_bbx.ZMax()));
+	return ((XMax() >= oth_bbx.XMin() && XMin() <= oth_bbx.XMax()) &&
+		(ZMax() >= oth_bbx.ZMin() && ZMin() <= oth_bbx.ZMax()));
 		//&& (oth_bbx.YMin() >= YMin() && oth_bbx.YMax() <= YMax()));
 }
 
@@ -0,0 +1,18 @@
+#pragma once
+
+enum class WCSECTIONenum
+{
+    GRID,
+    VERTICES,
+    INDICES,
+
+    TREE_1,
+    TREE_2,
+    TREE_3,
+    BUSH,
+    ROCK,
+    GRASS,
+    HAZELNUT,
+
+    COUNT
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+enum class CULLRESULTenum
+{
+    OUTSIDE,
+    INTERSECTS,
+    INSIDE
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+enum class NOISETYPEenum
+{
+    VALUE,
+    PERLIN,
+    SIMPLEX
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+enum class TERRMESHenum
+{
+    FLAT_ARRAYS,
+    INDEXED
+};
@@ -16,4 +16,16 @@ enum class TEXFORMATenum
 {
     FILE,
     EMBEDDED
+};
+
+// Block compression of texture files. BC1 is for color only, an image with
+// alpha asked for as BC1 is stored as BC3. BC7 keeps gradients (sky) intact
+// at twice the size of BC1.
+//
+enum class TEXCOMPRESSenum
+{
+    NONE,
+    BC1,
+    BC3,
+    BC7
 };
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Types/ECulling.h"
+
+// View frustum as 6 planes (left, right, bottom, top, near, far) pointing 
+// inwards, extracted from a projection * view matrix (Gribb & Hartmann).
+//
+class Frustum
+{
+public:
+	glm::vec4 planes[6];
+
+	Frustum();
+	Frustum(const glm::mat4& projection_view);
+
+	CULLRESULTenum Classify(glm::vec3 box_min, glm::vec3 box_max);
+};
+
+inline Frustum::Frustum()
+{
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] = glm::vec4(0.0f);
+	}
+}
+
+inline Frustum::Frustum(const glm::mat4& projection_view)
+{
+	// glm is column major, row r of the matrix is (m[0][r], m[1][r], m[2][r], m[3][r]).
+	//
+	glm::vec4 row_x(projection_view[0][0], projection_view[1][0], projection_view[2][0], projection_view[3][0]);
+	glm::vec4 row_y(projection_view[0][1], projection_view[1][1], projection_view[2][1], projection_view[3][1]);
+	glm::vec4 row_z(projection_view[0][2], projection_view[1][2], projection_view[2][2], projection_view[3][2]);
+	glm::vec4 row_w(projection_view[0][3], projection_view[1][3], projection_view[2][3], projection_view[3][3]);
+
+	planes[0] = row_w + row_x;
+	planes[1] = row_w - row_x;
+	planes[2] = row_w + row_y;
+	planes[3] = row_w - row_y;
+	planes[4] = row_w + row_z;
+	planes[5] = row_w - row_z;
+
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] /= glm::length(glm::vec3(planes[i]));
+	}
+}
+
+inline CULLRESULTenum Frustum::Classify(glm::vec3 box_min, glm::vec3 box_max)
+{
+	// For every plane test the box corner furthest along the plane normal 
+	// (outside if even that one is behind) and the nearest one (the box 
+	// straddles the plane if that one is behind).
+	//
+	CULLRESULTenum result = CULLRESULTenum::INSIDE;
+	for (int i = 0; i < 6; i++)
+	{
+		glm::vec3 normal(planes[i]);
+		glm::vec3 far_corner(normal.x >= 0.0f ? box_max.x : box_min.x,
+			normal.y >= 0.0f ? box_max.y : box_min.y,
+			normal.z >= 0.0f ? box_max.z : box_min.z);
+		if (glm::dot(normal, far_corner) + planes[i].w < 0.0f)
+		{
+			return CULLRESULTenum::OUTSIDE;
+		}
+
+		glm::vec3 near_corner(normal.x >= 0.0f ? box_min.x : box_max.x,
+			normal.y >= 0.0f ? box_min.y : box_max.y,
+			normal.z >= 0.0f ? box_min.z : box_max.z);
+		if (glm::dot(normal, near_corner) + planes[i].w < 0.0f)
+		{
+			result = CULLRESULTenum::INTERSECTS;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/constants.hpp>
+
+// Per instance data of the instanced models: a position plus a rotation 
+// around the up axis and a uniform scale, packed as two normalized 16 bit 
+// values. 16 bytes instead of a 64 byte model matrix, lowPolyModel.vert 
+// expands it (locations 3 and 4). Anything that needs an arbitrary transform
+// keeps using a model matrix.
+//
+struct Instance
+{
+	glm::vec3 position;
+	uint16_t yaw;
+	uint16_t scale;
+
+	// Keep in sync with MAX_INSTANCE_SCALE in lowPolyModel.vert.
+	//
+	static constexpr float _MAX_SCALE_ = 4.0f;
+
+	static Instance Pack(glm::vec3 position, float yaw_radians = 0.0f, 
+		float uniform_scale = 1.0f);
+
+	float GetYaw() const;
+	float GetScale() const;
+	glm::mat4 GetMatrix() const;
+};
+
+inline Instance Instance::Pack(glm::vec3 position, float yaw_radians,
+	float uniform_scale)
+{
+	const float _TWO_PI_ = glm::two_pi<float>();
+	float turns = std::fmod(yaw_radians, _TWO_PI_) / _TWO_PI_;
+	turns = (turns < 0.0f) ? turns + 1.0f : turns;
+
+	Instance instance;
+	instance.position = position;
+	instance.yaw = (uint16_t)std::lround(turns * 65535.0f);
+	instance.scale = (uint16_t)std::lround(std::min(std::max(uniform_scale / _MAX_SCALE_, 0.0f), 1.0f) * 65535.0f);
+	return instance;
+}
+
+inline float Instance::GetYaw() const
+{
+	return (float)yaw / 65535.0f * glm::two_pi<float>();
+}
+
+inline float Instance::GetScale() const
+{
+	return (float)scale / 65535.0f * _MAX_SCALE_;
+}
+
+inline glm::mat4 Instance::GetMatrix() const
+{
+	// The same transform the vertex shader builds: scale, rotate, translate.
+	//
+	glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+	model = glm::rotate(model, GetYaw(), glm::vec3(0.0f, 1.0f, 0.0f));
+	return glm::scale(model, glm::vec3(GetScale()));
+}
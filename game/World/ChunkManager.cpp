@@ -0,0 +1,354 @@
+#include "ChunkManager.h"
+
+const std::size_t ChunkManager::_DEFAULT_MEMORY_BUDGET_ = (std::size_t)512 * 1024 * 1024;
+const std::size_t ChunkManager::_MAX_UPLOADS_PER_UPDATE_ = 2;
+
+ChunkManager::ChunkManager(const uint32_t _grid_size,
+    const uint32_t _chunk_size,
+    const float _height_scale,
+    const TERRMESHenum _mesh_type,
+    const uint32_t _seed,
+    const std::string _cache_directory,
+    ChunkPopulateFunction populate,
+    JobSystem& job_system,
+    const int _load_radius,
+    const std::size_t _memory_budget) :
+    _grid_size_(_grid_size),
+    _chunk_size_(_chunk_size),
+    _height_scale_(_height_scale),
+    _mesh_type_(_mesh_type),
+    _seed_(_seed),
+    _cache_directory_(_cache_directory),
+    _load_radius_(_load_radius),
+    _memory_budget_(_memory_budget),
+    _chunks_per_side_((int)((_grid_size + _chunk_size - 1) / _chunk_size)),
+    populate_(populate),
+    job_system_(job_system),
+    memory_usage_(0)
+{
+}
+
+ChunkManager::~ChunkManager()
+{
+    // Jobs that didn't start yet find no request and return, the ones 
+    // building a chunk are waited for since they use this manager.
+    //
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_.clear();
+    }
+    job_system_.Wait(chunk_jobs_);
+}
+
+void ChunkManager::BeginLoad(glm::vec3 position)
+{
+    // Startup: every chunk in the load radius is requested, LoadStep is
+    // called (between loading screen frames) until all of them are in, so
+    // the player never stands on a missing chunk.
+    //
+    load_start_ = std::chrono::steady_clock::now();
+    scheduleChunks(chunkCoords(position));
+}
+
+bool ChunkManager::LoadStep()
+{
+    // Uploads whatever was built since the last step, without the per
+    // update limit, nothing else is drawn yet.
+    //
+    integrateChunks(std::numeric_limits<std::size_t>::max());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pending_.empty())
+        {
+            return false;
+        }
+    }
+
+    rebuildResidentChunks();
+
+    // Startup cost, cold (generated) vs warm (world cache hits) can be read
+    // straight from the log.
+    //
+    std::size_t cache_hits = 0;
+    for (std::size_t i = 0; i < resident_chunks_.size(); i++)
+    {
+        cache_hits += resident_chunks_.at(i)->terrain_.IsFromCache() ? 1 : 0;
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start_).count();
+    std::cout << "INFO::CHUNK_MANAGER::LOAD_STEP::" << chunks_.size() << "_CHUNKS_" << 
+        cache_hits << "_FROM_CACHE_" << memory_usage_ / (1024 * 1024) << "_MIB_" << 
+        (int)elapsed_ms << "_MS" << std::endl;
+    return true;
+}
+
+bool ChunkManager::Update(glm::vec3 position)
+{
+    glm::ivec2 center = chunkCoords(position);
+    bool changed = integrateChunks(_MAX_UPLOADS_PER_UPDATE_);
+
+    for (int i = -_load_radius_; i <= _load_radius_; i++)
+    {
+        for (int j = -_load_radius_; j <= _load_radius_; j++)
+        {
+            touchChunk(Key(center + glm::ivec2(i, j)));
+        }
+    }
+    scheduleChunks(center);
+    changed = evictChunks(center) || changed;
+
+    if (changed)
+    {
+        rebuildResidentChunks();
+    }
+    return changed;
+}
+
+WorldChunk* ChunkManager::GetChunk(glm::ivec2 coords)
+{
+    std::unordered_map<int64_t, ResidentChunk>::iterator it = chunks_.find(Key(coords));
+    if (it == chunks_.end())
+    {
+        return nullptr;
+    }
+    return it->second.chunk.get();
+}
+
+WorldChunk* ChunkManager::GetChunkAt(glm::vec3 position)
+{
+    return GetChunk(chunkCoords(position));
+}
+
+bool ChunkManager::GetSampleHeight(int64_t i, int64_t j, float& height)
+{
+    int64_t li, lj;
+    glm::ivec2 coords = HeightSampler::Locate(i, j, (int64_t)_chunk_size_, (int64_t)_chunks_per_side_, li, lj);
+
+    // Safe from any thread, the chunk can't be evicted while it's read.
+    //
+    std::lock_guard<std::mutex> residency_lock(residency_mutex_);
+    WorldChunk* chunk = GetChunk(coords);
+    if (chunk == nullptr)
+    {
+        return false;
+    }
+
+    int64_t samples = (int64_t)chunk->terrain_.GetSamplesPerSide();
+    if (li < 0 || lj < 0 || li >= samples || lj >= samples)
+    {
+        return false;
+    }
+
+    height = chunk->terrain_.GetGrid()->at(li * samples + lj).y;
+    return true;
+}
+
+const std::vector<WorldChunk*>& ChunkManager::GetResidentChunks()
+{
+    return resident_chunks_;
+}
+
+std::size_t ChunkManager::GetMemoryUsage()
+{
+    return memory_usage_;
+}
+
+int ChunkManager::GetChunksPerSide()
+{
+    return _chunks_per_side_;
+}
+
+int64_t ChunkManager::Key(glm::ivec2 coords)
+{
+    return ((int64_t)coords.x << 32) | (int64_t)(uint32_t)coords.y;
+}
+
+void ChunkManager::buildNextChunk()
+{
+    glm::ivec2 coords;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (requests_.empty())
+        {
+            return;
+        }
+        coords = requests_.front();
+        requests_.pop_front();
+    }
+
+    std::unique_ptr<WorldChunk> chunk(new WorldChunk(_grid_size_, _chunk_size_, _height_scale_, 
+        _mesh_type_, _seed_, coords, _cache_directory_));
+    populate_(*chunk);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        completed_.push_back(std::move(chunk));
+    }
+}
+
+void ChunkManager::scheduleChunks(glm::ivec2 center)
+{
+    std::vector<glm::ivec2> missing;
+    for (int i = -_load_radius_; i <= _load_radius_; i++)
+    {
+        for (int j = -_load_radius_; j <= _load_radius_; j++)
+        {
+            glm::ivec2 coords = center + glm::ivec2(i, j);
+            if (coords.x < 0 || coords.y < 0 || coords.x >= _chunks_per_side_ || coords.y >= _chunks_per_side_)
+            {
+                continue;
+            }
+            if (chunks_.find(Key(coords)) == chunks_.end())
+            {
+                missing.push_back(coords);
+            }
+        }
+    }
+
+    // Closest chunks first.
+    //
+    std::sort(missing.begin(), missing.end(), [center](const glm::ivec2& a, const glm::ivec2& b) {
+        glm::ivec2 da = a - center, db = b - center;
+        return da.x * da.x + da.y * da.y < db.x * db.x + db.y * db.y;
+    });
+
+    std::size_t scheduled = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Requests that weren't picked up yet and left the load radius are
+        // dropped, there's no point in building them anymore.
+        //
+        for (std::deque<glm::ivec2>::iterator it = requests_.begin(); it != requests_.end();)
+        {
+            if (!inLoadRadius(*it, center))
+            {
+                pending_.erase(Key(*it));
+                it = requests_.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+
+        for (std::size_t i = 0; i < missing.size(); i++)
+        {
+            if (pending_.insert(Key(missing.at(i))).second)
+            {
+                requests_.push_back(missing.at(i));
+                scheduled++;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < scheduled; i++)
+    {
+        job_system_.Run([this]() { buildNextChunk(); }, &chunk_jobs_);
+    }
+}
+
+bool ChunkManager::integrateChunks(std::size_t max_chunks)
+{
+    std::vector<std::unique_ptr<WorldChunk>> completed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t count = std::min(max_chunks, completed_.size());
+        for (std::size_t i = 0; i < count; i++)
+        {
+            completed.push_back(std::move(completed_.at(i)));
+        }
+        completed_.erase(completed_.begin(), completed_.begin() + count);
+    }
+
+    for (std::size_t i = 0; i < completed.size(); i++)
+    {
+        integrateChunk(std::move(completed.at(i)));
+    }
+    return !completed.empty();
+}
+
+void ChunkManager::integrateChunk(std::unique_ptr<WorldChunk> chunk)
+{
+    int64_t key = Key(chunk->_coords_);
+    chunk->terrain_.Upload();
+
+    ResidentChunk resident;
+    resident.footprint = chunk->GetMemoryFootprint();
+    resident.chunk = std::move(chunk);
+    resident.lru_position = lru_.insert(lru_.begin(), key);
+    memory_usage_ += resident.footprint;
+    {
+        std::lock_guard<std::mutex> residency_lock(residency_mutex_);
+        chunks_[key] = std::move(resident);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.erase(key);
+}
+
+bool ChunkManager::evictChunks(glm::ivec2 center)
+{
+    bool evicted = false;
+    std::list<int64_t>::iterator it = lru_.end();
+    while (memory_usage_ > _memory_budget_ && it != lru_.begin())
+    {
+        it--;
+        ResidentChunk& resident = chunks_.at(*it);
+        if (inLoadRadius(resident.chunk->_coords_, center))
+        {
+            continue;
+        }
+
+        memory_usage_ -= resident.footprint;
+        {
+            std::lock_guard<std::mutex> residency_lock(residency_mutex_);
+            chunks_.erase(*it);
+        }
+        it = lru_.erase(it);
+        evicted = true;
+    }
+    return evicted;
+}
+
+void ChunkManager::touchChunk(int64_t key)
+{
+    std::unordered_map<int64_t, ResidentChunk>::iterator it = chunks_.find(key);
+    if (it != chunks_.end())
+    {
+        lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+    }
+}
+
+void ChunkManager::rebuildResidentChunks()
+{
+    resident_chunks_.clear();
+    for (std::list<int64_t>::iterator it = lru_.begin(); it != lru_.end(); it++)
+    {
+        resident_chunks_.push_back(chunks_.at(*it).chunk.get());
+    }
+
+    // Keep a stable order, so the concatenated instance lists don't get 
+    // reshuffled every time a chunk is touched.
+    //
+    std::sort(resident_chunks_.begin(), resident_chunks_.end(), [](WorldChunk* a, WorldChunk* b) {
+        return Key(a->_coords_) < Key(b->_coords_);
+    });
+}
+
+bool ChunkManager::inLoadRadius(glm::ivec2 coords, glm::ivec2 center)
+{
+    glm::ivec2 distance = glm::abs(coords - center);
+    return distance.x <= _load_radius_ && distance.y <= _load_radius_;
+}
+
+glm::ivec2 ChunkManager::chunkCoords(glm::vec3 position)
+{
+    // World position to grid sample, see GameWorld::GetGridHeight.
+    //
+    int64_t i = (int64_t)std::floor(((double)position.x + (double)_grid_size_) / 2.0);
+    int64_t j = (int64_t)std::floor(((double)position.z + (double)_grid_size_) / 2.0);
+    int64_t cx = std::max((int64_t)0, std::min(i / (int64_t)_chunk_size_, (int64_t)_chunks_per_side_ - 1));
+    int64_t cz = std::max((int64_t)0, std::min(j / (int64_t)_chunk_size_, (int64_t)_chunks_per_side_ - 1));
+
+    return glm::ivec2((int)cx, (int)cz);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "World/WorldChunk.h"
+#include "World/HeightSampler.h"
+#include "Jobs/JobSystem.h"
+#include "Types/ETerrain.h"
+
+typedef std::function<void(WorldChunk&)> ChunkPopulateFunction;
+
+// Streams WorldChunks in and out around a position. Chunks are generated by 
+// jobs on the JobSystem (terrain, vegetation and the populate callback all 
+// run there), the main thread only uploads the finished chunks to the GPU,
+// a few per update so a burst of new chunks doesn't stall a frame.
+// Chunks outside the load radius stay cached until the memory budget is hit,
+// then the least recently used ones are evicted.
+// With a cache directory every chunk's terrain goes through the world cache,
+// see WorldCache.
+//
+class ChunkManager
+{
+public:
+    ChunkManager(const uint32_t _grid_size,
+        const uint32_t _chunk_size,
+        const float _height_scale,
+        const TERRMESHenum _mesh_type,
+        const uint32_t _seed,
+        const std::string _cache_directory,
+        ChunkPopulateFunction populate,
+        JobSystem& job_system,
+        const int _load_radius = 1,
+        const std::size_t _memory_budget = _DEFAULT_MEMORY_BUDGET_);
+    ~ChunkManager();
+
+    ChunkManager(const ChunkManager&) = delete;
+    ChunkManager& operator=(const ChunkManager&) = delete;
+
+    void BeginLoad(glm::vec3 position);
+    bool LoadStep();
+    bool Update(glm::vec3 position);
+
+    WorldChunk* GetChunk(glm::ivec2 coords);
+    WorldChunk* GetChunkAt(glm::vec3 position);
+    bool GetSampleHeight(int64_t i, int64_t j, float& height);
+    const std::vector<WorldChunk*>& GetResidentChunks();
+    std::size_t GetMemoryUsage();
+    int GetChunksPerSide();
+
+    static int64_t Key(glm::ivec2 coords);
+
+private:
+    struct ResidentChunk
+    {
+        std::unique_ptr<WorldChunk> chunk;
+        std::size_t footprint;
+        std::list<int64_t>::iterator lru_position;
+    };
+
+    const uint32_t _grid_size_;
+    const uint32_t _chunk_size_;
+    const float _height_scale_;
+    const TERRMESHenum _mesh_type_;
+    const uint32_t _seed_;
+    const std::string _cache_directory_;
+    const int _load_radius_;
+    const std::size_t _memory_budget_;
+    const int _chunks_per_side_;
+    ChunkPopulateFunction populate_;
+    JobSystem& job_system_;
+
+    // Only the main thread changes chunks_, under residency_mutex_ so 
+    // GetSampleHeight can be called from other threads.
+    //
+    std::mutex residency_mutex_;
+    std::unordered_map<int64_t, ResidentChunk> chunks_;
+    std::list<int64_t> lru_;
+    std::vector<WorldChunk*> resident_chunks_;
+    std::size_t memory_usage_;
+    std::chrono::steady_clock::time_point load_start_;
+
+    // Shared with the chunk jobs, guarded by mutex_. Every request queues 
+    // one job which builds whatever request is first at that time, so 
+    // requests dropped or reordered in the meantime are never built.
+    //
+    std::mutex mutex_;
+    std::deque<glm::ivec2> requests_;
+    std::unordered_set<int64_t> pending_;
+    std::vector<std::unique_ptr<WorldChunk>> completed_;
+    JobCounter chunk_jobs_;
+
+    static const std::size_t _DEFAULT_MEMORY_BUDGET_;
+    static const std::size_t _MAX_UPLOADS_PER_UPDATE_;
+
+    void buildNextChunk();
+    void scheduleChunks(glm::ivec2 center);
+    bool integrateChunks(std::size_t max_chunks);
+    void integrateChunk(std::unique_ptr<WorldChunk> chunk);
+    bool evictChunks(glm::ivec2 center);
+    void touchChunk(int64_t key);
+    void rebuildResidentChunks();
+    bool inLoadRadius(glm::ivec2 coords, glm::ivec2 center);
+    glm::ivec2 chunkCoords(glm::vec3 position);
+};
@@ -0,0 +1,103 @@
+#include "CollectibleRegistry.h"
+
+const uint32_t CollectibleRegistry::_INVALID_ = 0xffffffffu;
+
+CollectibleRegistry::CollectibleRegistry() :
+    free_head_(_INVALID_)
+{
+}
+
+CollectibleHandle CollectibleRegistry::Add(const Instance& instance)
+{
+    uint32_t slot = free_head_;
+    if (slot != _INVALID_)
+    {
+        free_head_ = slots_.at(slot).next_free;
+    }
+    else
+    {
+        slot = (uint32_t)slots_.size();
+        CollectibleRegistry::Slot new_slot;
+        new_slot.generation = 0;
+        slots_.push_back(new_slot);
+    }
+
+    slots_.at(slot).dense = (uint32_t)instances_.size();
+    slots_.at(slot).next_free = _INVALID_;
+    instances_.push_back(instance);
+    dense_to_slot_.push_back(slot);
+
+    CollectibleHandle handle;
+    handle.slot = slot;
+    handle.generation = slots_.at(slot).generation;
+    return handle;
+}
+
+bool CollectibleRegistry::Remove(CollectibleHandle handle, uint32_t& moved_index)
+{
+    // moved_index is the dense index that now holds the former last 
+    // instance. If the removed instance was the last one nothing moved and
+    // moved_index equals the new count.
+    //
+    if (!IsAlive(handle))
+    {
+        return false;
+    }
+
+    uint32_t dense = slots_.at(handle.slot).dense;
+    uint32_t last = (uint32_t)instances_.size() - 1;
+    if (dense != last)
+    {
+        instances_.at(dense) = instances_.at(last);
+        dense_to_slot_.at(dense) = dense_to_slot_.at(last);
+        slots_.at(dense_to_slot_.at(dense)).dense = dense;
+    }
+    instances_.pop_back();
+    dense_to_slot_.pop_back();
+
+    slots_.at(handle.slot).generation++;
+    slots_.at(handle.slot).dense = _INVALID_;
+    slots_.at(handle.slot).next_free = free_head_;
+    free_head_ = handle.slot;
+
+    moved_index = dense;
+    return true;
+}
+
+bool CollectibleRegistry::IsAlive(CollectibleHandle handle)
+{
+    return (handle.slot < slots_.size() && 
+        slots_.at(handle.slot).generation == handle.generation &&
+        slots_.at(handle.slot).dense != _INVALID_);
+}
+
+void CollectibleRegistry::Clear()
+{
+    // Slots are kept with a bumped generation so handles from before the 
+    // Clear stay dead.
+    //
+    instances_.clear();
+    dense_to_slot_.clear();
+    free_head_ = _INVALID_;
+    for (uint32_t i = (uint32_t)slots_.size(); i > 0; i--)
+    {
+        uint32_t slot = i - 1;
+        if (slots_.at(slot).dense != _INVALID_)
+        {
+            slots_.at(slot).generation++;
+            slots_.at(slot).dense = _INVALID_;
+        }
+        slots_.at(slot).next_free = free_head_;
+        free_head_ = slot;
+    }
+}
+
+const std::vector<Instance>& CollectibleRegistry::GetInstances()
+{
+    return instances_;
+}
+
+uint32_t CollectibleRegistry::GetCount()
+{
+    return (uint32_t)instances_.size();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Types/Instance.h"
+
+// Handle to a registered collectible. The generation changes every time a
+// slot is freed, so a handle kept past the removal of its collectible (or
+// past a Clear) is simply reported as dead instead of hitting whatever took 
+// its slot.
+//
+struct CollectibleHandle
+{
+    uint32_t slot = 0xffffffffu;
+    uint32_t generation = 0;
+};
+
+// Slot map of the collectible instances. The instances are kept densely
+// packed in the order they are uploaded to the instance buffer, handles point
+// at a slot which knows the current dense index. Removing swaps the last 
+// instance into the hole and pops, so exactly one instance changes position
+// and both operations are O(1).
+//
+class CollectibleRegistry
+{
+public:
+    CollectibleRegistry();
+
+    CollectibleHandle Add(const Instance& instance);
+    bool Remove(CollectibleHandle handle, uint32_t& moved_index);
+    bool IsAlive(CollectibleHandle handle);
+    void Clear();
+
+    const std::vector<Instance>& GetInstances();
+    uint32_t GetCount();
+
+private:
+    struct Slot
+    {
+        uint32_t dense;
+        uint32_t generation;
+        uint32_t next_free;
+    };
+
+    std::vector<Instance> instances_;
+    std::vector<uint32_t> dense_to_slot_;
+    std::vector<CollectibleRegistry::Slot> slots_;
+    uint32_t free_head_;
+
+    static const uint32_t _INVALID_;
+};
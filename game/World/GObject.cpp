@@ -1,6 +1,6 @@
 #include "GObject.h"
 
-GObject::GObject(Model obj_model) :
+GObject::GObject(ModelHandle obj_model) :
     model_(obj_model)
 {
     calculateModelBoundingBox();
@@ -8,7 +8,7 @@ GObject::GObject(Model obj_model) :
 
 void GObject::Draw(Shader& shader)
 {
-    model_.Draw(shader);
+    model_->Draw(shader);
 }
 
 void GObject::Draw(Shader& shader, glm::vec3 position)
@@ -16,7 +16,7 @@ void GObject::Draw(Shader& shader, glm::vec3 position)
     glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
     shader.Use();
     shader.SetMat4("model", model);
-    model_.Draw(shader);
+    model_->Draw(shader);
 }
 
 void GObject::Draw(Shader& shader, glm::vec3 position, float yaw)
@@ -26,17 +26,54 @@ void GObject::Draw(Shader& shader, glm::vec3 position, float yaw)
     model = glm::rotate(model, glm::radians(yaw), glm::vec3(0.0f, 1.0f, 0.0f));
     shader.Use();
     shader.SetMat4("model", model);
-    model_.Draw(shader);
+    model_->Draw(shader);
 }
 
-void GObject::DrawInstanced(Shader& shader, std::vector<glm::mat4>& instance_mod_mats)
+void GObject::DrawInstanced(Shader& shader)
 {
-    model_.DrawInstanced(shader, instance_mod_mats);
+    model_->DrawInstanced(shader);
 }
 
-void GObject::DrawInstanced(Shader& shader, std::shared_ptr<std::vector<glm::mat4>> instance_mod_mats)
+void GObject::SetInstances(const std::vector<Instance>& instances)
 {
-    model_.DrawInstanced(shader, instance_mod_mats);
+    model_->SetInstances(instances);
+}
+
+void GObject::SetInstances(const std::vector<Instance>& instances, 
+    const std::vector<uint32_t>& lod_counts)
+{
+    model_->SetInstances(instances, lod_counts);
+}
+
+void GObject::UpdateInstances(const std::vector<Instance>& instances, 
+    uint32_t dirty_start)
+{
+    model_->UpdateInstances(instances, dirty_start);
+}
+
+void GObject::SetInstance(const Instance& instance, uint32_t index)
+{
+    model_->SetInstance(instance, index);
+}
+
+void GObject::SetInstanceCount(uint32_t count)
+{
+    model_->SetInstanceCount(count);
+}
+
+void GObject::GenerateImpostor(Shader& bake_shader)
+{
+    model_->GenerateImpostor(bake_shader);
+}
+
+void GObject::SetImpostorInstances(const std::vector<Instance>& instances)
+{
+    model_->SetImpostorInstances(instances);
+}
+
+void GObject::DrawImpostors(Shader& shader)
+{
+    model_->DrawImpostors(shader);
 }
 
 AABB GObject::GetModelBoundingBox()
@@ -44,6 +81,31 @@ AABB GObject::GetModelBoundingBox()
     return model_bounding_box_;
 }
 
+std::size_t GObject::GetModelMemoryFootprint()
+{
+    return model_->GetMemoryFootprint();
+}
+
+uint32_t GObject::GetLodCount()
+{
+    return model_->GetLodCount();
+}
+
+float GObject::GetLodError(uint32_t lod)
+{
+    return model_->GetLodError(lod);
+}
+
+std::size_t GObject::GetDrawnTriangleCount()
+{
+    return model_->GetDrawnTriangleCount();
+}
+
+bool GObject::HasImpostor()
+{
+    return model_->HasImpostor();
+}
+
 float GObject::GetXMaxModelAABB()
 {
     return model_bounding_box_.XMax();
@@ -81,9 +143,9 @@ void GObject::calculateModelBoundingBox()
     max_x = max_y = max_z = std::numeric_limits<float>::min();
 
     glm::vec3 curr_vert;
-    for (std::size_t i = 0; i < model_.meshes_.size(); i++)
+    for (std::size_t i = 0; i < model_->meshes_.size(); i++)
     {
-        Mesh& curr_mesh = model_.meshes_.at(i);
+        Mesh& curr_mesh = model_->meshes_.at(i);
         for (std::size_t j = 0; j < curr_mesh.vertices_.size(); j++)
         {
             curr_vert = curr_mesh.vertices_.at(j).position;
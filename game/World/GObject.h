@@ -11,21 +11,39 @@
 
 #include "Types/AABB.h"
 #include "Renderer/Model.h"
+#include "Assets/AssetManager.h"
 
+// The model is a shared handle, copying a GObject (every entity holds a
+// copy of its terrain element) doesn't copy the mesh data.
+//
 class GObject
 {
 public:
 	AABB model_bounding_box_;
 
-	GObject(Model obj_model);
+	GObject(ModelHandle obj_model);
 
 	void Draw(Shader& shader);
 	void Draw(Shader& shader, glm::vec3 position);
 	void Draw(Shader& shader, glm::vec3 position, float yaw);
-	void DrawInstanced(Shader& shader, std::vector<glm::mat4>& instance_mod_mats);
-	void DrawInstanced(Shader& shader, std::shared_ptr<std::vector<glm::mat4>> instance_mod_mats);
+	void DrawInstanced(Shader& shader);
+	void SetInstances(const std::vector<Instance>& instances);
+	void SetInstances(const std::vector<Instance>& instances, 
+		const std::vector<uint32_t>& lod_counts);
+	void UpdateInstances(const std::vector<Instance>& instances, 
+		uint32_t dirty_start);
+	void SetInstance(const Instance& instance, uint32_t index);
+	void SetInstanceCount(uint32_t count);
+	void GenerateImpostor(Shader& bake_shader);
+	void SetImpostorInstances(const std::vector<Instance>& instances);
+	void DrawImpostors(Shader& shader);
 
 	AABB GetModelBoundingBox();
+	std::size_t GetModelMemoryFootprint();
+	uint32_t GetLodCount();
+	float GetLodError(uint32_t lod);
+	std::size_t GetDrawnTriangleCount();
+	bool HasImpostor();
 
 	float GetXMaxModelAABB();
 	float GetXMinModelAABB();
@@ -35,7 +53,7 @@ public:
 	float GetZMinModelAABB();
 	
 protected:
-	Model model_;
+	ModelHandle model_;
 	glm::vec3 world_position_;
 
 	void calculateModelBoundingBox();
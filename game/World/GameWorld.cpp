@@ -1,46 +1,346 @@
 #include "GameWorld.h"
 
-GameWorld::GameWorld(glm::vec3 sun_position, uint32_t grid_size_) :
+const uint32_t GameWorld::_CHUNK_SIZE_ = 64;
+const int GameWorld::_CHUNK_LOAD_RADIUS_ = 1;
+const std::string GameWorld::_CACHE_DIRECTORY_ = "Cache/World/";
+const bool GameWorld::_FRUSTUM_CULLING_ = true;
+const uint32_t GameWorld::_HAZELNUT_ELEMENT_TYPE_ = 6;
+const float GameWorld::_LOD_PIXEL_ERROR_ = 2.0f;
+const float GameWorld::_IMPOSTOR_DISTANCE_ = 60.0f;
+const float GameWorld::_IMPOSTOR_FADE_WIDTH_ = 8.0f;
+const std::vector<std::string> GameWorld::_ELEMENT_PASS_NAMES_ = {
+    "woodland/tree_1", "woodland/tree_2", "woodland/tree_3", "woodland/bush", "woodland/rock", 
+    "woodland/grass", "woodland/hazelnut"
+};
+const std::string GameWorld::_SKYBOX_DIRECTORY_ = "Resources/Skyboxes/Fantasy_01/";
+
+// In terrain element order.
+//
+const std::vector<std::string> GameWorld::_MODEL_PATHS_ = {
+    "Resources/Models/tree_1/tree_1.obj", "Resources/Models/tree_2/tree_2.obj", 
+    "Resources/Models/tree_3/tree_3.obj", "Resources/Models/lil_bush/lil_bush.obj", 
+    "Resources/Models/rock/rock.obj", "Resources/Models/grass_bud/grass_bud.obj", 
+    "Resources/Models/hazelnut/hazelnut.obj"
+};
+
+// Terrain, skybox, entity, impostor and impostor bake.
+//
+const std::vector<std::pair<std::string, std::string>> GameWorld::_SHADER_PATHS_ = {
+    { "Resources/Shaders/Terrain/lowPolyTerrain.vert", "Resources/Shaders/Terrain/lowPolyTerrain.frag" },
+    { "Resources/Shaders/Skybox/fantasySkybox.vert", "Resources/Shaders/Skybox/fantasySkybox.frag" },
+    { "Resources/Shaders/Model/lowPolyModel.vert", "Resources/Shaders/Model/lowPolyModel.frag" },
+    { "Resources/Shaders/Impostor/impostor.vert", "Resources/Shaders/Impostor/impostor.frag" },
+    { "Resources/Shaders/Impostor/impostorBake.vert", "Resources/Shaders/Impostor/impostorBake.frag" }
+};
+
+std::vector<StartupGraph::TaskId> GameWorld::Preload(StartupGraph& graph, 
+    AssetManager& asset_manager, GameWorld::Assets& assets)
+{
+    // Models are parsed and their LOD chains built on workers, each one is
+    // uploaded as soon as its chain is done. Shaders only compile on the
+    // main thread, they fill the time until the first model is in. The
+    // skybox faces are decoded on workers and streamed in by the texture
+    // loader, the world only waits for the cube map to be complete.
+    //
+    std::vector<StartupGraph::TaskId> tasks;
+    assets.models.resize(_MODEL_PATHS_.size());
+    for (std::size_t m = 0; m < _MODEL_PATHS_.size(); m++)
+    {
+        std::string name = _MODEL_PATHS_.at(m).substr(_MODEL_PATHS_.at(m).find_last_of('/') + 1);
+        StartupGraph::TaskId import = graph.AddWorkerTask("import " + name, [&asset_manager, &assets, m]() {
+            assets.models.at(m) = asset_manager.ImportModel(_MODEL_PATHS_.at(m), true);
+        });
+        StartupGraph::TaskId lods = graph.AddWorkerTask("lods " + name, [&assets, m]() {
+            assets.models.at(m)->GenerateLods();
+        }, { import });
+        tasks.push_back(graph.AddMainTask("upload " + name, [&assets, m]() {
+            assets.models.at(m)->Upload();
+        }, { lods }));
+    }
+
+    assets.shaders.resize(_SHADER_PATHS_.size());
+    for (std::size_t s = 0; s < _SHADER_PATHS_.size(); s++)
+    {
+        std::string name = _SHADER_PATHS_.at(s).first.substr(_SHADER_PATHS_.at(s).first.find_last_of('/') + 1);
+        tasks.push_back(graph.AddMainTask("compile " + name, [&asset_manager, &assets, s]() {
+            assets.shaders.at(s) = asset_manager.LoadShader(_SHADER_PATHS_.at(s).first, _SHADER_PATHS_.at(s).second);
+        }));
+    }
+
+    // A cube map that fails to load doesn't hold up the game, the skybox
+    // just isn't drawn.
+    //
+    assets.skybox = asset_manager.LoadCubemap(Skybox::GetFacePaths(_SKYBOX_DIRECTORY_, SKYBFORMATenum::PNG));
+    tasks.push_back(graph.AddPolledTask("skybox", [&assets]() {
+        return assets.skybox->IsReady() || assets.skybox->IsFailed();
+    }));
+    return tasks;
+}
+
+GameWorld::GameWorld(JobSystem& job_system, AssetManager& asset_manager, 
+    const GameWorld::Assets& _assets, glm::vec3 sun_position, uint32_t grid_size_, uint32_t seed) :
     _grid_size_(grid_size_),
-    terrain_(Terrain(grid_size_)),
-    skybox_(Skybox("Resources/Skyboxes/Fantasy_01/", SKYBFORMATenum::PNG)),
-    quad_tree_(AABB(glm::vec3(0.0f), (float)grid_size_)),
-    shader_terrain_(Shader("Resources/Shaders/Terrain/lowPolyTerrain.vert", "Resources/Shaders/Terrain/lowPolyTerrain.frag")),
-    shader_skybox_(Shader("Resources/Shaders/Skybox/fantasySkybox.vert", "Resources/Shaders/Skybox/fantasySkybox.frag")),
-    shader_entity_(Shader("Resources/Shaders/Model/lowPolyModel.vert", "Resources/Shaders/Model/lowPolyModel.frag")),
-    trrel_tree_1_(Model("Resources/Models/tree_1/tree_1.obj", true), shader_entity_),
-    trrel_tree_2_(Model("Resources/Models/tree_2/tree_2.obj", true), shader_entity_),
-    trrel_tree_3_(Model("Resources/Models/tree_3/tree_3.obj", true), shader_entity_),
-    trrel_bush_(Model("Resources/Models/lil_bush/lil_bush.obj", true), shader_entity_),
-    trrel_rock_(Model("Resources/Models/rock/rock.obj", true), shader_entity_),
-    trrel_grass_(Model("Resources/Models/grass_bud/grass_bud.obj", true), shader_entity_),
-    trrel_hazelnut_(Model("Resources/Models/hazelnut/hazelnut.obj", true), shader_entity_),
-    sun_position_(sun_position)
-{
-    grid_ = terrain_.GetGrid();
-    setupModelMatsAll();
-    createGameEntities();
-    createQuadTree();
-    createModelMatPairs();
-    createIndexMap();
-}
-
-void GameWorld::Draw()
+    _chunk_size_(std::min(grid_size_, _CHUNK_SIZE_)),
+    _seed_((seed != 0) ? seed : std::random_device{}()),
+    job_system_(job_system),
+    asset_manager_(asset_manager),
+    shader_terrain_(_assets.shaders.at(0)),
+    shader_skybox_(_assets.shaders.at(1)),
+    shader_entity_(_assets.shaders.at(2)),
+    shader_impostor_(_assets.shaders.at(3)),
+    shader_impostor_bake_(_assets.shaders.at(4)),
+    skybox_(_assets.skybox),
+    trrel_tree_1_(_assets.models.at(0), shader_entity_),
+    trrel_tree_2_(_assets.models.at(1), shader_entity_),
+    trrel_tree_3_(_assets.models.at(2), shader_entity_),
+    trrel_bush_(_assets.models.at(3), shader_entity_),
+    trrel_rock_(_assets.models.at(4), shader_entity_),
+    trrel_grass_(_assets.models.at(5), shader_entity_),
+    trrel_hazelnut_(_assets.models.at(_HAZELNUT_ELEMENT_TYPE_), shader_entity_),
+    sun_position_(sun_position),
+    draw_lists_building_(false),
+    draw_lists_ready_(false),
+    build_visible_instances_(0),
+    build_time_(0.0),
+    lod_mode_(-1),
+    impostor_distance_(_IMPOSTOR_DISTANCE_),
+    visible_instances_(0),
+    cull_time_(0.0),
+    loaded_(false),
+    chunk_manager_(grid_size_, std::min(grid_size_, _CHUNK_SIZE_), 10.0f, TERRMESHenum::INDEXED, _seed_,
+        (seed != 0) ? _CACHE_DIRECTORY_ : "", [this](WorldChunk& chunk) { populateChunk(chunk); }, 
+        job_system_, _CHUNK_LOAD_RADIUS_)
 {
+    terrain_elements_ = {
+        &trrel_tree_1_, &trrel_tree_2_, &trrel_tree_3_, &trrel_bush_, &trrel_rock_, 
+        &trrel_grass_, &trrel_hazelnut_
+    };
+
+    // Preload built the LOD levels before the instance buffers exist, so
+    // the buffer setup covers the meshes of every level.
+    //
+    draw_packets_.resize(terrain_elements_.size());
+    lod_distances_.resize(terrain_elements_.size());
+    for (std::size_t m = 0; m < terrain_elements_.size(); m++)
+    {
+        draw_packets_.at(m).lod_counts.resize(terrain_elements_.at(m)->GetLodCount());
+        lod_distances_.at(m).resize(terrain_elements_.at(m)->GetLodCount());
+    }
+
+    // Grass and hazelnuts are too small to be seen that far, they don't get
+    // impostors.
+    //
+    {
+        PROFILE_SCOPE("GameWorld::GenerateImpostors");
+        trrel_tree_1_.GenerateImpostor(*shader_impostor_bake_);
+        trrel_tree_2_.GenerateImpostor(*shader_impostor_bake_);
+        trrel_tree_3_.GenerateImpostor(*shader_impostor_bake_);
+        trrel_bush_.GenerateImpostor(*shader_impostor_bake_);
+        trrel_rock_.GenerateImpostor(*shader_impostor_bake_);
+    }
+
+    // Instance buffers are created lazily by the first SetInstances call, do
+    // it here on the main thread before any chunk worker copies the models.
+    //
+    {
+        PROFILE_SCOPE("GameWorld::SetupInstances");
+        setupInstancesAll();
+        setupInstances();
+    }
+    chunk_manager_.BeginLoad(glm::vec3(0.0f));
+}
+
+GameWorld::~GameWorld()
+{
+    waitForDrawLists();
+}
+
+bool GameWorld::LoadStep()
+{
+    if (loaded_)
+    {
+        return true;
+    }
+
+    PROFILE_SCOPE("GameWorld::LoadStep");
+    if (!chunk_manager_.LoadStep())
+    {
+        return false;
+    }
+
+    WorldChunk* spawn_chunk = chunk_manager_.GetChunkAt(glm::vec3(0.0f));
+    if (spawn_chunk != nullptr)
+    {
+        spawn_chunk->terrain_.PrintMeshStats();
+    }
+    rebuildInstances();
+    loaded_ = true;
+    return true;
+}
+
+void GameWorld::Draw(GpuTimer& gpu_timer)
+{
+    gpu_timer.Begin("terrain");
     drawTerrain();
+    gpu_timer.End();
+
+    gpu_timer.Begin("skybox");
     drawSkybox();
-    drawWoodland();
+    gpu_timer.End();
+
+    {
+        PROFILE_SCOPE("GameWorld::SubmitDrawLists");
+        submitDrawLists();
+    }
+
+    drawWoodland(gpu_timer);
+}
+
+void GameWorld::Update(glm::vec3 player_pos)
+{
+    waitForDrawLists();
+    asset_manager_.Update();
+    if (chunk_manager_.Update(player_pos))
+    {
+        rebuildInstances();
+    }
 }
 
-void GameWorld::setupModelMatsAll()
+void GameWorld::BuildDrawLists(const glm::mat4& projection_view, glm::vec3 camera_position, 
+    float projection_scale)
 {
-    model_mats_all_.push_back(terrain_.GetTree1ModelMats());
-    model_mats_all_.push_back(terrain_.GetTree2ModelMats());
-    model_mats_all_.push_back(terrain_.GetTree3ModelMats());
-    model_mats_all_.push_back(terrain_.GetBushModelMats());
-    model_mats_all_.push_back(terrain_.GetRockModelMats());
-    model_mats_all_.push_back(terrain_.GetGrassModelMats());
-    model_mats_all_.push_back(terrain_.GetHazelnutMats());
+    // Culling, LOD selection and packing of this frame's instances run on
+    // the job system while the main thread goes on with the frame, Draw
+    // waits for them after the terrain and the skybox. Without culling the
+    // instance buffers keep the full sets uploaded by setupInstances, drawn
+    // at full resolution.
+    //
+    if (!_FRUSTUM_CULLING_)
+    {
+        visible_instances_ = GetTotalInstanceCount();
+        return;
+    }
+    waitForDrawLists();
+
+    // projection_scale is the size of one unit at distance one in pixels, a
+    // level is used from the distance its error shrinks to the pixel limit.
+    //
+    for (std::size_t m = 0; m < lod_distances_.size(); m++)
+    {
+        for (uint32_t lod = 0; lod < (uint32_t)lod_distances_.at(m).size(); lod++)
+        {
+            float distance = terrain_elements_.at(m)->GetLodError(lod) * projection_scale / _LOD_PIXEL_ERROR_;
+            lod_distances_.at(m).at(lod) = distance * distance;
+        }
+    }
+    build_projection_view_ = projection_view;
+    build_camera_position_ = camera_position;
+
+    draw_lists_building_ = true;
+    draw_lists_ready_ = true;
+    job_system_.Run([this]() { buildDrawLists(); }, &draw_lists_job_);
+}
+
+const std::vector<CollectibleHit>& GameWorld::QueryCollectibles(AABB range)
+{
+    query_results_.clear();
+    if (query_indices_.empty())
+    {
+        query_indices_.resize(64);
+    }
+
+    const std::vector<WorldChunk*>& chunks = chunk_manager_.GetResidentChunks();
+    for (std::size_t i = 0; i < chunks.size(); i++)
+    {
+        WorldChunk* chunk = chunks.at(i);
+        if (!chunk->Overlaps(range))
+        {
+            continue;
+        }
+
+        // The tree tells how many items matched, grow the buffer and ask 
+        // again if they didn't fit.
+        //
+        std::size_t found = chunk->quad_tree_.Query(range, query_indices_.data(), query_indices_.size());
+        if (found > query_indices_.size())
+        {
+            query_indices_.resize(found);
+            found = chunk->quad_tree_.Query(range, query_indices_.data(), query_indices_.size());
+        }
+
+        for (std::size_t j = 0; j < found; j++)
+        {
+            if (chunk->entities_.at(query_indices_.at(j)).IsCollectible())
+            {
+                CollectibleHit hit;
+                hit.chunk = chunk;
+                hit.index = query_indices_.at(j);
+                query_results_.push_back(hit);
+            }
+        }
+    }
+    return query_results_;
+}
+
+void GameWorld::rebuildInstances()
+{
+    // Rebuild the per model instance lists from the chunks that are loaded
+    // right now, this only happens when the resident set changes. Hazelnuts
+    // come from the chunk entities, collected ones are no longer collectible
+    // and every live one gets a fresh handle.
+    //
+    PROFILE_SCOPE("GameWorld::RebuildInstances");
+    setupInstancesAll();
+    hazelnuts_.Clear();
+    const std::vector<WorldChunk*>& chunks = chunk_manager_.GetResidentChunks();
+    for (std::size_t i = 0; i < chunks.size(); i++)
+    {
+        Terrain& terrain = chunks.at(i)->terrain_;
+        InstanceVector chunk_instances = {
+            terrain.GetTree1Instances(), terrain.GetTree2Instances(), terrain.GetTree3Instances(),
+            terrain.GetBushInstances(), terrain.GetRockInstances(), terrain.GetGrassInstances()
+        };
+        for (std::size_t m = 0; m < chunk_instances.size(); m++)
+        {
+            instances_all_.at(m)->insert(instances_all_.at(m)->end(), 
+                chunk_instances.at(m)->begin(), chunk_instances.at(m)->end());
+        }
+
+        std::vector<Entity>& entities = chunks.at(i)->entities_;
+        for (std::size_t e = 0; e < entities.size(); e++)
+        {
+            if (entities.at(e).IsCollectible())
+            {
+                entities.at(e).collectible_handle_ = hazelnuts_.Add(entities.at(e).GetInstance());
+            }
+        }
+    }
+
+    setupInstances();
+}
+
+void GameWorld::setupInstancesAll()
+{
+    instances_all_.clear();
+    for (std::size_t i = 0; i < 6; i++)
+    {
+        instances_all_.push_back(std::make_shared<std::vector<Instance>>());
+    }
+}
+
+void GameWorld::setupInstances()
+{
+    // Upload every instance set. From here on the instance buffers are only
+    // touched when a set changes (see GameWorld::Update and 
+    // GameWorld::RemoveCollectibles).
+    //
+    trrel_tree_1_.SetInstances(*instances_all_.at(0));
+    trrel_tree_2_.SetInstances(*instances_all_.at(1));
+    trrel_tree_3_.SetInstances(*instances_all_.at(2));
+    trrel_bush_.SetInstances(*instances_all_.at(3));
+    trrel_rock_.SetInstances(*instances_all_.at(4));
+    trrel_grass_.SetInstances(*instances_all_.at(5));
+    trrel_hazelnut_.SetInstances(hazelnuts_.GetInstances());
 }
 
 glm::vec3& GameWorld::GetSunPosition()
@@ -53,128 +353,377 @@ void GameWorld::SetSunPosition(glm::vec3 new_sun_pos)
     sun_position_ = new_sun_pos;
 }
 
-void GameWorld::RemoveCollectibles(std::vector<Entity> collectibles, Player& player)
+void GameWorld::SetLodMode(int lod_mode)
 {
-    if (collectibles.empty())
+    waitForDrawLists();
+    lod_mode_ = lod_mode;
+}
+
+void GameWorld::SetImpostorDistance(float distance)
+{
+    waitForDrawLists();
+    impostor_distance_ = distance;
+}
+
+uint32_t GameWorld::GetVisibleInstanceCount()
+{
+    return visible_instances_;
+}
+
+uint32_t GameWorld::GetTotalInstanceCount()
+{
+    uint32_t total = hazelnuts_.GetCount();
+    for (std::size_t m = 0; m < instances_all_.size(); m++)
     {
-        return;
+        total += (uint32_t)instances_all_.at(m)->size();
     }
+    return total;
+}
+
+double GameWorld::GetCullTime()
+{
+    return cull_time_;
+}
+
+std::size_t GameWorld::GetDrawnTriangleCount()
+{
+    std::size_t triangles = 0;
+    for (std::size_t m = 0; m < terrain_elements_.size(); m++)
+    {
+        triangles += terrain_elements_.at(m)->GetDrawnTriangleCount();
+    }
+    return triangles;
+}
+
+void GameWorld::RemoveCollectibles(const std::vector<CollectibleHit>& collectibles, Player& player)
+{
+    waitForDrawLists();
     for (std::size_t i = 0; i < collectibles.size(); i++)
     {
-        if (hazelnut_index_map_.find(collectibles.at(i).GetModelMatrix()) != hazelnut_index_map_.end())
+        if (collectibles.at(i).chunk->entities_.at(collectibles.at(i).index).IsCollectible())
         {
-            std::vector<glm::mat4>::iterator index = model_mats_all_.at(6)->begin() + hazelnut_index_map_.at(collectibles.at(i).GetModelMatrix());
-            model_mats_all_.at(6)->erase(index);
+            removeCollectible(collectibles.at(i));
             player.UpdateScore();
-            createModelMatPairs();
-            createIndexMap();
         }
     }
 }
 
 float GameWorld::GetGridHeight(glm::vec3 player_pos)
 {
-    int64_t grid_size, grid_center, mod_i, i, mod_j, j;
-    // Starting grid width height is (128, 128)
-    // Generate map of (128, 128) and scale positions by 2, map still (128, 128), but corrdinates from [0, 256]
-    // Translate map by grid width in -x and -z directions, so coordiantes are now [-128, 128]
-    // Center of height map is at index (64, 64) since it's scaled * 2 and translated
+    // The chunks cover samples [0, chunks_per_side * chunk_size] in both
+    // directions.
     //
-    grid_size = (int64_t)_grid_size_;
-    grid_center = grid_size / 2; 
-    j = grid_center + (int64_t)((double)player_pos.z / 2.0);
-    i = grid_center + (int64_t)((double)player_pos.x / 2.0);
+    int64_t max_index = (int64_t)chunk_manager_.GetChunksPerSide() * (int64_t)_chunk_size_;
+    return HeightSampler::GridHeight(player_pos, (int64_t)_grid_size_, max_index, 
+        [this](int64_t i, int64_t j, float& height) { return chunk_manager_.GetSampleHeight(i, j, height); });
+}
 
-    // Interpolate between the four nearest positions
+void GameWorld::populateChunk(WorldChunk& chunk)
+{
+    // Runs on a chunk worker thread, only touches the chunk and copies of
+    // the terrain elements.
     //
-    float p0, p1, p2, p3;
+    PROFILE_SCOPE("GameWorld::PopulateChunk");
+    removeCollectedHazelnuts(chunk);
+
+    Terrain& terrain = chunk.terrain_;
+    InstanceVector chunk_instances = {
+        terrain.GetTree1Instances(), terrain.GetTree2Instances(), terrain.GetTree3Instances(),
+        terrain.GetBushInstances(), terrain.GetRockInstances(), terrain.GetGrassInstances(),
+        terrain.GetHazelnutInstances()
+    };
+    for (std::size_t m = 0; m < chunk_instances.size(); m++)
+    {
+        for (std::size_t i = 0; i < chunk_instances.at(m)->size(); i++)
+        {
+            chunk.entities_.push_back(Entity(*terrain_elements_.at(m), chunk_instances.at(m)->at(i), 
+                m == _HAZELNUT_ELEMENT_TYPE_, (uint32_t)m));
+        }
+    }
 
-    // Make sure we don't get a std::out_of_range exception.
+    // Bulk build, the tree stores indices into chunk.entities_. The culling
+    // volume of the chunk encloses every entity sphere.
     //
-    mod_i = (i - 1 < 0) ? 0 : i - 1;
-    mod_j = (j - 1 < 0) ? 0 : j - 1;
-    p0 = grid_->at(mod_i * grid_size + j).y;
-    p2 = grid_->at(i * grid_size + mod_j).y;
-    mod_i = (i + 1 > grid_size) ? grid_size : i + 1;
-    mod_j = (j + 1 > grid_size) ? grid_size : j + 1;
-    p1 = grid_->at(i * grid_size + mod_j).y;
-    p3 = grid_->at(mod_i * grid_size + j).y;
+    std::vector<glm::vec3> positions;
+    positions.reserve(chunk.entities_.size());
+    chunk.entity_y_range_ = glm::vec2(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+    chunk.entity_margin_ = 0.0f;
+    for (std::size_t i = 0; i < chunk.entities_.size(); i++)
+    {
+        glm::vec3 center = chunk.entities_.at(i).GetCenter();
+        float radius = chunk.entities_.at(i).GetCullRadius();
+        positions.push_back(center);
+        chunk.entity_y_range_.x = std::min(chunk.entity_y_range_.x, center.y - radius);
+        chunk.entity_y_range_.y = std::max(chunk.entity_y_range_.y, center.y + radius);
+        chunk.entity_margin_ = std::max(chunk.entity_margin_, radius);
+    }
+    chunk.quad_tree_.Build(positions);
+}
+
+void GameWorld::removeCollectedHazelnuts(WorldChunk& chunk)
+{
+    std::lock_guard<std::mutex> lock(collected_mutex_);
+    std::unordered_map<int64_t, std::vector<glm::vec3>>::iterator collected = 
+        collected_hazelnuts_.find(ChunkManager::Key(chunk._coords_));
+    if (collected == collected_hazelnuts_.end())
+    {
+        return;
+    }
 
-    return (p0 + p1 + p2 + p3) / 4.0f;
+    std::shared_ptr<std::vector<Instance>> hazelnut_instances = chunk.terrain_.GetHazelnutInstances();
+    for (std::size_t i = 0; i < collected->second.size(); i++)
+    {
+        for (std::vector<Instance>::iterator it = hazelnut_instances->begin(); it != hazelnut_instances->end(); it++)
+        {
+            if (it->position == collected->second.at(i))
+            {
+                hazelnut_instances->erase(it);
+                break;
+            }
+        }
+    }
 }
 
-void GameWorld::createGameEntities()
+void GameWorld::removeCollectible(const CollectibleHit& hit)
 {
-    for (std::size_t i = 0; i < model_mats_all_.at(0)->size(); i++)
+    // Constant time no matter how many hazelnuts there are: the registry
+    // swaps the last instance into the freed slot. With culling the instance
+    // buffer holds this frame's visible hazelnuts and the next draw list
+    // skips the collected one, so only the full set without culling has its
+    // moved slot patched before the count shrinks.
+    //
+    Entity& entity = hit.chunk->entities_.at(hit.index);
+    uint32_t moved_index;
+    if (hazelnuts_.Remove(entity.collectible_handle_, moved_index) && !_FRUSTUM_CULLING_)
     {
-        game_entities_.push_back(Entity(trrel_tree_1_, model_mats_all_.at(0)->at(i)));
+        if (moved_index < hazelnuts_.GetCount())
+        {
+            trrel_hazelnut_.SetInstance(hazelnuts_.GetInstances().at(moved_index), moved_index);
+        }
+        trrel_hazelnut_.SetInstanceCount(hazelnuts_.GetCount());
     }
-    for (std::size_t i = 0; i < model_mats_all_.at(1)->size(); i++)
+
+    hit.chunk->quad_tree_.Remove(hit.index, entity.GetCenter());
+    entity.is_collectible_ = false;
+    entity.collectible_handle_ = CollectibleHandle();
+
+    // Remember the pickup so the hazelnut stays gone when the chunk is 
+    // evicted and generated again.
+    //
+    std::lock_guard<std::mutex> lock(collected_mutex_);
+    collected_hazelnuts_[ChunkManager::Key(hit.chunk->_coords_)].push_back(entity.GetInstance().position);
+}
+
+void GameWorld::buildDrawLists()
+{
+    // Runs as a job. Every chunk is culled into its own buckets in
+    // parallel, then every element type concatenates the buckets of all
+    // chunks in chunk order, level by level, so the result doesn't depend
+    // on which worker culled what.
+    //
+    PROFILE_SCOPE("GameWorld::buildDrawLists");
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Frustum frustum(build_projection_view_);
+
+    const std::vector<WorldChunk*>& chunks = chunk_manager_.GetResidentChunks();
+    if (chunk_buckets_.size() < chunks.size())
+    {
+        chunk_buckets_.resize(chunks.size());
+    }
+    job_system_.ParallelFor((uint32_t)chunks.size(), 1, [this, &chunks, &frustum](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            cullChunk(*chunks.at(i), frustum, chunk_buckets_.at(i));
+        }
+    });
+
+    job_system_.ParallelFor((uint32_t)draw_packets_.size(), 1, [this, &chunks](uint32_t begin, uint32_t end) {
+        for (uint32_t m = begin; m < end; m++)
+        {
+            GameWorld::DrawPacket& packet = draw_packets_.at(m);
+            packet.instances.clear();
+            packet.impostors.clear();
+            for (std::size_t lod = 0; lod < packet.lod_counts.size(); lod++)
+            {
+                std::size_t level_start = packet.instances.size();
+                for (std::size_t i = 0; i < chunks.size(); i++)
+                {
+                    const std::vector<Instance>& level = chunk_buckets_.at(i).lods.at(m).at(lod);
+                    packet.instances.insert(packet.instances.end(), level.begin(), level.end());
+                }
+                packet.lod_counts.at(lod) = (uint32_t)(packet.instances.size() - level_start);
+            }
+            for (std::size_t i = 0; i < chunks.size(); i++)
+            {
+                const std::vector<Instance>& impostors = chunk_buckets_.at(i).impostors.at(m);
+                packet.impostors.insert(packet.impostors.end(), impostors.begin(), impostors.end());
+            }
+        }
+    });
+
+    build_visible_instances_ = 0;
+    for (std::size_t m = 0; m < draw_packets_.size(); m++)
     {
-        game_entities_.push_back(Entity(trrel_tree_2_, model_mats_all_.at(1)->at(i)));
+        build_visible_instances_ += (uint32_t)draw_packets_.at(m).instances.size();
     }
-    for (std::size_t i = 0; i < model_mats_all_.at(2)->size(); i++)
+    build_time_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void GameWorld::cullChunk(WorldChunk& chunk, Frustum& frustum, GameWorld::ChunkBuckets& buckets)
+{
+    // Instances inside the crossfade band around the impostor distance go
+    // to both lists, past it only to the impostors.
+    //
+    if (buckets.lods.size() != draw_packets_.size())
     {
-        game_entities_.push_back(Entity(trrel_tree_3_, model_mats_all_.at(2)->at(i)));
+        buckets.lods.resize(draw_packets_.size());
+        buckets.impostors.resize(draw_packets_.size());
+        for (std::size_t m = 0; m < draw_packets_.size(); m++)
+        {
+            buckets.lods.at(m).resize(draw_packets_.at(m).lod_counts.size());
+        }
     }
-    for (std::size_t i = 0; i < model_mats_all_.at(3)->size(); i++)
+    for (std::size_t m = 0; m < buckets.lods.size(); m++)
     {
-        game_entities_.push_back(Entity(trrel_bush_, model_mats_all_.at(3)->at(i)));
+        for (std::size_t lod = 0; lod < buckets.lods.at(m).size(); lod++)
+        {
+            buckets.lods.at(m).at(lod).clear();
+        }
+        buckets.impostors.at(m).clear();
     }
-    for (std::size_t i = 0; i < model_mats_all_.at(4)->size(); i++)
+
+    float fade_start = impostor_distance_ - _IMPOSTOR_FADE_WIDTH_ * 0.5f;
+    float fade_end = impostor_distance_ + _IMPOSTOR_FADE_WIDTH_ * 0.5f;
+    buckets.cull_indices.clear();
+    chunk.quad_tree_.QueryFrustum(frustum, chunk.entity_y_range_, chunk.entity_margin_, buckets.cull_indices);
+
+    for (std::size_t j = 0; j < buckets.cull_indices.size(); j++)
     {
-        game_entities_.push_back(Entity(trrel_rock_, model_mats_all_.at(4)->at(i)));
+        Entity& entity = chunk.entities_.at(buckets.cull_indices.at(j));
+        if (entity.element_type_ == _HAZELNUT_ELEMENT_TYPE_ && !entity.IsCollectible())
+        {
+            continue;
+        }
+        const Instance& instance = entity.GetInstance();
+        if (impostorsEnabled(entity.element_type_))
+        {
+            glm::vec3 offset = instance.position - build_camera_position_;
+            float distance = glm::dot(offset, offset);
+            if (distance >= fade_start * fade_start)
+            {
+                buckets.impostors.at(entity.element_type_).push_back(instance);
+            }
+            if (distance >= fade_end * fade_end)
+            {
+                continue;
+            }
+        }
+
+        uint32_t lod = selectLod(entity.element_type_, instance, build_camera_position_);
+        buckets.lods.at(entity.element_type_).at(lod).push_back(instance);
     }
-    for (std::size_t i = 0; i < model_mats_all_.at(5)->size(); i++)
+}
+
+void GameWorld::submitDrawLists()
+{
+    // The GL half of the draw lists, uploads what the build packed.
+    //
+    waitForDrawLists();
+    if (!draw_lists_ready_)
     {
-        game_entities_.push_back(Entity(trrel_grass_, model_mats_all_.at(5)->at(i)));
+        return;
     }
-    for (std::size_t i = 0; i < model_mats_all_.at(6)->size(); i++)
+
+    for (std::size_t m = 0; m < draw_packets_.size(); m++)
     {
-        game_entities_.push_back(Entity(trrel_hazelnut_, model_mats_all_.at(6)->at(i), true));
+        terrain_elements_.at(m)->SetInstances(draw_packets_.at(m).instances, draw_packets_.at(m).lod_counts);
+        terrain_elements_.at(m)->SetImpostorInstances(draw_packets_.at(m).impostors);
     }
+    visible_instances_ = build_visible_instances_;
+    cull_time_ = build_time_;
+    draw_lists_ready_ = false;
 }
 
-void GameWorld::createQuadTree()
+void GameWorld::waitForDrawLists()
 {
-    for (std::size_t i = 0; i < game_entities_.size(); i++)
+    // Everything that changes the chunks or their entities waits for a
+    // running build first, the build reads them without a lock. Only the
+    // build itself is run here if no worker took it yet, chunk builds and
+    // texture bakes stay with the workers and can't stall the frame.
+    //
+    if (draw_lists_building_)
     {
-        quad_tree_.Insert(game_entities_.at(i));
+        PROFILE_SCOPE("GameWorld::waitForDrawLists");
+        job_system_.WaitOwn(draw_lists_job_);
+        draw_lists_building_ = false;
     }
 }
 
-void GameWorld::createModelMatPairs()
+uint32_t GameWorld::selectLod(uint32_t element_type, const Instance& instance, 
+    glm::vec3 camera_position)
 {
-    hazelnut_model_mats_pairs_.clear();
-    for (std::size_t i = 0; i < model_mats_all_.at(6)->size(); i++)
+    const std::vector<float>& distances = lod_distances_.at(element_type);
+    if (lod_mode_ >= 0)
+    {
+        return std::min((uint32_t)lod_mode_, (uint32_t)distances.size() - 1);
+    }
+
+    // The error grows with the instance scale, so the distance is compared
+    // in model units.
+    //
+    glm::vec3 offset = instance.position - camera_position;
+    float scale = std::max(instance.GetScale(), 0.001f);
+    float distance = glm::dot(offset, offset) / (scale * scale);
+
+    uint32_t lod = 0;
+    while (lod + 1 < (uint32_t)distances.size() && distance >= distances.at(lod + 1))
     {
-        hazelnut_model_mats_pairs_.push_back(std::make_pair(model_mats_all_.at(6)->at(i), i));
+        lod++;
     }
+    return lod;
 }
 
-void GameWorld::createIndexMap()
+bool GameWorld::impostorsEnabled(uint32_t element_type)
 {
-    hazelnut_index_map_.clear();
-    hazelnut_index_map_ = std::unordered_map<glm::mat4, int>(hazelnut_model_mats_pairs_.begin(), hazelnut_model_mats_pairs_.end());
+    return _FRUSTUM_CULLING_ && impostor_distance_ > 0.0f && terrain_elements_.at(element_type)->HasImpostor();
 }
 
 void GameWorld::drawTerrain()
 {
-    terrain_.Draw(shader_terrain_);
+    const std::vector<WorldChunk*>& chunks = chunk_manager_.GetResidentChunks();
+    for (std::size_t i = 0; i < chunks.size(); i++)
+    {
+        chunks.at(i)->terrain_.Draw(*shader_terrain_);
+    }
 }
 
 void GameWorld::drawSkybox()
 {
-    skybox_.Draw(shader_skybox_);
+    skybox_.Draw(*shader_skybox_);
 }
 
-void GameWorld::drawWoodland()
+void GameWorld::drawWoodland(GpuTimer& gpu_timer)
 {
-    trrel_tree_1_.DrawInstanced(model_mats_all_.at(0));
-    trrel_tree_2_.DrawInstanced(model_mats_all_.at(1));
-    trrel_tree_3_.DrawInstanced(model_mats_all_.at(2));
-    trrel_bush_.DrawInstanced(model_mats_all_.at(3));
-    trrel_rock_.DrawInstanced(model_mats_all_.at(4));
-    trrel_grass_.DrawInstanced(model_mats_all_.at(5));
-    trrel_hazelnut_.DrawInstanced(model_mats_all_.at(6));
-}
+    // The mesh and impostor shaders fade with the same dither over the same
+    // band, elements without an impostor never fade out. Each element type
+    // is one timed pass, its meshes and its impostors.
+    //
+    float fade_start = impostor_distance_ - _IMPOSTOR_FADE_WIDTH_ * 0.5f;
+    shader_entity_->Use();
+    shader_entity_->SetFloat("fade_width", _IMPOSTOR_FADE_WIDTH_);
+    shader_impostor_->Use();
+    shader_impostor_->SetFloat("fade_start", fade_start);
+    shader_impostor_->SetFloat("fade_width", _IMPOSTOR_FADE_WIDTH_);
+    for (std::size_t m = 0; m < terrain_elements_.size(); m++)
+    {
+        gpu_timer.Begin(_ELEMENT_PASS_NAMES_.at(m));
+        shader_entity_->Use();
+        shader_entity_->SetFloat("fade_start", impostorsEnabled((uint32_t)m) ? fade_start : std::numeric_limits<float>::max());
+        terrain_elements_.at(m)->DrawInstanced();
+        if (impostorsEnabled((uint32_t)m))
+        {
+            terrain_elements_.at(m)->DrawImpostors(*shader_impostor_);
+        }
+        gpu_timer.End();
+    }
+}
\ No newline at end of file
@@ -5,9 +5,11 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtx/hash.hpp>
 #include <unordered_map>
 #include <utility>
+#include <random>
+#include <mutex>
+#include <chrono>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -16,51 +18,204 @@
 #include "Renderer/Shader.h"
 #include "Renderer/Skybox.h"
 #include "Renderer/Camera.h"
+#include "Renderer/GpuTimer.h"
 #include "World/GObject.h"
 #include "World/QuadTree.h"
 #include "World/TerrainElement.h"
+#include "World/WorldChunk.h"
+#include "World/ChunkManager.h"
+#include "World/HeightSampler.h"
+#include "World/CollectibleRegistry.h"
+#include "Jobs/JobSystem.h"
+#include "Jobs/StartupGraph.h"
+#include "Profiler/Profiler.h"
+#include "Assets/AssetManager.h"
 #include "Game/Player.h"
 #include "Game/Entity.h"
+#include "Types/Instance.h"
 
-typedef std::vector<std::shared_ptr<std::vector<glm::mat4>>> ModelMatrixVector;
+typedef std::vector<std::shared_ptr<std::vector<Instance>>> InstanceVector;
+
+// A collectible found by GameWorld::QueryCollectibles, the entity is 
+// chunk->entities_[index]. The index is also its key in the chunk quadtree.
+//
+struct CollectibleHit
+{
+    WorldChunk* chunk;
+    uint32_t index;
+};
 
 class GameWorld
 {
 public:
-    QuadTree quad_tree_;
-    std::vector<Entity> game_entities_;
+    // The instances of one element type that passed the frustum test this
+    // frame, packed level by level, and those drawn as impostors.
+    //
+    struct DrawPacket
+    {
+        std::vector<Instance> instances;
+        std::vector<uint32_t> lod_counts;
+        std::vector<Instance> impostors;
+    };
+
+    // What one chunk contributes to the draw packets, per element type and
+    // level, and the entity indices its quadtree returned.
+    //
+    struct ChunkBuckets
+    {
+        std::vector<std::vector<std::vector<Instance>>> lods;
+        std::vector<std::vector<Instance>> impostors;
+        std::vector<uint32_t> cull_indices;
+    };
+
+    // What Preload loads ahead of the constructor. The handles keep the
+    // models and shaders alive in the asset manager until the constructor
+    // asks for them, the skybox cube map is cached the same way.
+    //
+    struct Assets
+    {
+        std::vector<ModelHandle> models;
+        std::vector<ShaderHandle> shaders;
+        TextureHandle skybox;
+    };
+
+    // Adds the loading of everything the constructor needs to the graph and
+    // returns the tasks the constructor has to wait for.
+    //
+    static std::vector<StartupGraph::TaskId> Preload(StartupGraph& graph, 
+        AssetManager& asset_manager, GameWorld::Assets& assets);
+
+    // A seed of 0 generates a new world every launch. Only fixed seeds go 
+    // through the world cache, random ones would just fill the cache 
+    // directory with worlds nobody loads again.
+    //
+    // Assets that weren't preloaded are loaded here. The spawn chunks are
+    // built by jobs started here, LoadStep uploads them as they finish and
+    // returns true once the world is ready to play.
+    //
+    GameWorld(JobSystem& job_system, AssetManager& asset_manager, 
+        const GameWorld::Assets& _assets,
+        glm::vec3 sun_position = glm::vec3(0.0f, -1.0f, 0.0f), 
+        uint32_t grid_size_ = 128, uint32_t seed = 0);
+    ~GameWorld();
 
-    GameWorld(glm::vec3 sun_position = glm::vec3(0.0f, -1.0f, 0.0f), uint32_t grid_size_ = 128);
+    bool LoadStep();
 
-    void Draw();
+    void Draw(GpuTimer& gpu_timer);
+    void Update(glm::vec3 player_pos);
+    void BuildDrawLists(const glm::mat4& projection_view, glm::vec3 camera_position, 
+        float projection_scale);
+    const std::vector<CollectibleHit>& QueryCollectibles(AABB range);
 
+    // Also called from the simulation thread, only reads chunk samples
+    // under the chunk manager's residency lock.
+    //
     float GetGridHeight(glm::vec3 player_pos);
     glm::vec3& GetSunPosition();
+    uint32_t GetVisibleInstanceCount();
+    uint32_t GetTotalInstanceCount();
+    double GetCullTime();
+    std::size_t GetDrawnTriangleCount();
     void SetSunPosition(glm::vec3 new_sun_pos);
-    void RemoveCollectibles(std::vector<Entity> collectible, Player& player);
+    void SetLodMode(int lod_mode);
+    void SetImpostorDistance(float distance);
+    void RemoveCollectibles(const std::vector<CollectibleHit>& collectibles, Player& player);
 
 private:
     const uint32_t _grid_size_;
-    std::shared_ptr<std::vector<glm::vec3>> grid_;
+    const uint32_t _chunk_size_;
+    const uint32_t _seed_;
+    JobSystem& job_system_;
+    AssetManager& asset_manager_;
 
-    Shader shader_terrain_, shader_skybox_, shader_entity_;
+    ShaderHandle shader_terrain_, shader_skybox_, shader_entity_, 
+        shader_impostor_, shader_impostor_bake_;
     Skybox skybox_;
-    Terrain terrain_;
     TerrainElement trrel_tree_1_, trrel_tree_2_, trrel_tree_3_, 
         trrel_bush_, trrel_rock_, trrel_grass_, trrel_hazelnut_;
 
-    ModelMatrixVector model_mats_all_;
+    std::vector<TerrainElement*> terrain_elements_;
+    InstanceVector instances_all_;
     glm::vec3 sun_position_;
 
-    std::vector<std::pair<glm::mat4, int>> hazelnut_model_mats_pairs_;
-    std::unordered_map<glm::mat4, int, std::hash<glm::mat4>> hazelnut_index_map_;
+    // The hazelnut instances of all resident chunks, in instance buffer 
+    // order. Every hazelnut entity holds a handle into it.
+    //
+    CollectibleRegistry hazelnuts_;
+
+    // Scratch buffers for QueryCollectibles, reused every frame.
+    //
+    std::vector<uint32_t> query_indices_;
+    std::vector<CollectibleHit> query_results_;
+
+    // Built by a job between BuildDrawLists and Draw, per element type and
+    // per resident chunk. The job only reads the chunks, everything that
+    // changes them waits for it first. build_* is the input and the result
+    // of the job, the main thread doesn't touch them while it runs.
+    //
+    std::vector<GameWorld::DrawPacket> draw_packets_;
+    std::vector<GameWorld::ChunkBuckets> chunk_buckets_;
+    JobCounter draw_lists_job_;
+    bool draw_lists_building_;
+    bool draw_lists_ready_;
+    glm::mat4 build_projection_view_;
+    glm::vec3 build_camera_position_;
+    uint32_t build_visible_instances_;
+    double build_time_;
+
+    // Squared camera distance from which each level of each element type is
+    // used (for an instance of scale 1). A LOD mode of -1 picks the level by
+    // screen space error, 0 and up draws everything at that level.
+    //
+    std::vector<std::vector<float>> lod_distances_;
+    int lod_mode_;
+
+    // Instances past the impostor distance are drawn as impostors, inside
+    // the crossfade band around it as both. A distance of 0 turns them off.
+    //
+    float impostor_distance_;
+    uint32_t visible_instances_;
+    double cull_time_;
+    bool loaded_;
+
+    // Hazelnuts already picked up, per chunk key. Read by the chunk workers
+    // so an evicted chunk doesn't bring its collected hazelnuts back.
+    //
+    std::mutex collected_mutex_;
+    std::unordered_map<int64_t, std::vector<glm::vec3>> collected_hazelnuts_;
+
+    // Declared last so it's destroyed first, its workers call populateChunk
+    // and need everything above to be alive.
+    //
+    ChunkManager chunk_manager_;
+
+    static const uint32_t _CHUNK_SIZE_;
+    static const int _CHUNK_LOAD_RADIUS_;
+    static const std::string _CACHE_DIRECTORY_;
+    static const bool _FRUSTUM_CULLING_;
+    static const uint32_t _HAZELNUT_ELEMENT_TYPE_;
+    static const float _LOD_PIXEL_ERROR_;
+    static const float _IMPOSTOR_DISTANCE_;
+    static const float _IMPOSTOR_FADE_WIDTH_;
+    static const std::vector<std::string> _ELEMENT_PASS_NAMES_;
+    static const std::string _SKYBOX_DIRECTORY_;
+    static const std::vector<std::string> _MODEL_PATHS_;
+    static const std::vector<std::pair<std::string, std::string>> _SHADER_PATHS_;
 
-    void setupModelMatsAll();
-    void createGameEntities();
-    void createQuadTree();
-    void createModelMatPairs();
-    void createIndexMap();
+    void setupInstancesAll();
+    void setupInstances();
+    void rebuildInstances();
+    void populateChunk(WorldChunk& chunk);
+    void removeCollectedHazelnuts(WorldChunk& chunk);
+    void removeCollectible(const CollectibleHit& hit);
+    void buildDrawLists();
+    void cullChunk(WorldChunk& chunk, Frustum& frustum, GameWorld::ChunkBuckets& buckets);
+    void submitDrawLists();
+    void waitForDrawLists();
+    uint32_t selectLod(uint32_t element_type, const Instance& instance, 
+        glm::vec3 camera_position);
+    bool impostorsEnabled(uint32_t element_type);
     void drawTerrain();
     void drawSkybox();
-    void drawWoodland();
+    void drawWoodland(GpuTimer& gpu_timer);
 };
@@ -0,0 +1,56 @@
+#include "HeightSampler.h"
+
+glm::ivec2 HeightSampler::Locate(const int64_t _i, const int64_t _j, const int64_t _chunk_size, 
+    const int64_t _chunks_per_side, int64_t& local_i, int64_t& local_j)
+{
+    // Samples on a chunk border exist in both chunks, the last chunk of a
+    // row/column owns the outer border of the world.
+    //
+    int64_t cx = std::min(_i / _chunk_size, _chunks_per_side - 1);
+    int64_t cz = std::min(_j / _chunk_size, _chunks_per_side - 1);
+    local_i = _i - cx * _chunk_size;
+    local_j = _j - cz * _chunk_size;
+    return glm::ivec2((int)cx, (int)cz);
+}
+
+float HeightSampler::GridHeight(glm::vec3 position, const int64_t _grid_size, const int64_t _max_index, 
+    const HeightSampleFunction& sample)
+{
+    int64_t grid_center, mod_i, i, mod_j, j;
+    // Starting grid width height is (128, 128)
+    // Generate map of (128, 128) and scale positions by 2, map still (128, 128), but corrdinates from [0, 256]
+    // Translate map by grid width in -x and -z directions, so coordiantes are now [-128, 128]
+    // Center of height map is at index (64, 64) since it's scaled * 2 and translated
+    //
+    grid_center = _grid_size / 2; 
+    j = grid_center + (int64_t)((double)position.z / 2.0);
+    i = grid_center + (int64_t)((double)position.x / 2.0);
+
+    // Interpolate between the four nearest positions
+    //
+    float p0, p1, p2, p3;
+
+    // Make sure we don't get a std::out_of_range exception, the samples go
+    // from 0 to _max_index in both directions.
+    //
+    i = std::max((int64_t)0, std::min(i, _max_index));
+    j = std::max((int64_t)0, std::min(j, _max_index));
+    mod_i = (i - 1 < 0) ? 0 : i - 1;
+    mod_j = (j - 1 < 0) ? 0 : j - 1;
+    bool loaded = sample(mod_i, j, p0);
+    loaded = sample(i, mod_j, p2) && loaded;
+    mod_i = (i + 1 > _max_index) ? _max_index : i + 1;
+    mod_j = (j + 1 > _max_index) ? _max_index : j + 1;
+    loaded = sample(i, mod_j, p1) && loaded;
+    loaded = sample(mod_i, j, p3) && loaded;
+
+    // A sample that isn't there (its chunk is still being generated) keeps
+    // the height.
+    //
+    if (!loaded)
+    {
+        return position.y;
+    }
+
+    return (p0 + p1 + p2 + p3) / 4.0f;
+}
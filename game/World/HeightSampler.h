@@ -0,0 +1,27 @@
+#pragma once
+
+#include <iostream>
+#include <functional>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+typedef std::function<bool(int64_t, int64_t, float&)> HeightSampleFunction;
+
+// Index math of the height queries on the chunked world grid, kept apart
+// from the chunks so it has no GL or chunk streaming dependencies. Locate
+// maps a world sample index to its chunk and the index inside that chunk,
+// GridHeight averages the four samples around a world position through
+// whatever reads a sample (ChunkManager::GetSampleHeight in the game).
+//
+class HeightSampler
+{
+public:
+    static glm::ivec2 Locate(const int64_t _i, const int64_t _j, const int64_t _chunk_size, 
+        const int64_t _chunks_per_side, int64_t& local_i, int64_t& local_j);
+    static float GridHeight(glm::vec3 position, const int64_t _grid_size, const int64_t _max_index, 
+        const HeightSampleFunction& sample);
+
+private:
+    HeightSampler();
+};
@@ -1,95 +1,363 @@
 #include "QuadTree.h"
 
+const uint32_t QuadTree::_NODE_CAPACITY_ = 8;
+const uint32_t QuadTree::_MAX_DEPTH_ = 16;
+const uint32_t QuadTree::_INVALID_ = 0xffffffffu;
+
 QuadTree::QuadTree(AABB bounding_box) :
-    _node_capacity_(4),
     bounding_box_(bounding_box),
-    quadrant_1_(nullptr),
-    quadrant_2_(nullptr),
-    quadrant_3_(nullptr),
-    quadrant_4_(nullptr)
+    item_count_(0)
 {
+    Clear();
 }
 
-QuadTree::~QuadTree()
+void QuadTree::Build(const std::vector<glm::vec3>& positions)
 {
-    delete quadrant_1_;
-    delete quadrant_2_;
-    delete quadrant_3_;
-    delete quadrant_4_;
+    // Bulk build, the index of an item is its position in the array. The 
+    // indices are partitioned top down in place, every node is split at most
+    // once, instead of being pushed down the tree one at a time.
+    //
+    Clear();
+
+    std::vector<uint32_t> indices;
+    indices.reserve(positions.size());
+    for (uint32_t i = 0; i < (uint32_t)positions.size(); i++)
+    {
+        if (containsPoint(nodes_.at(0), glm::vec2(positions.at(i).x, positions.at(i).z)))
+        {
+            indices.push_back(i);
+        }
+    }
+
+    nodes_.reserve(indices.size() / _NODE_CAPACITY_ * 2 + 1);
+    items_.reserve(indices.size());
+    buildNode(0, positions, indices.data(), (uint32_t)indices.size());
+    item_count_ = (uint32_t)indices.size();
 }
 
-bool QuadTree::Insert(Entity ent)
+bool QuadTree::Insert(uint32_t index, glm::vec3 position)
 {
-    if (!bounding_box_.Contains(ent.GetCenter()))
+    glm::vec2 point(position.x, position.z);
+    if (!containsPoint(nodes_.at(0), point))
     {
         return false;
     }
 
-    if (entities_.size() < _node_capacity_)
+    uint32_t node = 0;
+    while (nodes_.at(node).first_child != _INVALID_)
     {
-        entities_.push_back(ent);
-        return true;
+        node = nodes_.at(node).first_child + childFor(nodes_.at(node), point);
     }
 
-    if (quadrant_1_ == nullptr)
+    QuadTree::Item item;
+    item.position = point;
+    item.index = index;
+    item.next = _INVALID_;
+    items_.push_back(item);
+
+    linkItem(node, (uint32_t)items_.size() - 1);
+    item_count_++;
+    if (nodes_.at(node).item_count > _NODE_CAPACITY_ && nodes_.at(node).depth < _MAX_DEPTH_)
     {
-        subdivide();
+        subdivide(node);
     }
+    return true;
+}
 
-    if (quadrant_1_->Insert(ent)) return true;
-    if (quadrant_2_->Insert(ent)) return true;
-    if (quadrant_3_->Insert(ent)) return true;
-    if (quadrant_4_->Insert(ent)) return true;
- 
-    // This should never happen.
+bool QuadTree::Remove(uint32_t index, glm::vec3 position)
+{
+    // The position has to be the one the index was inserted with, it picks
+    // the leaf, so removing costs a descent plus a walk over one leaf. The 
+    // item is only unlinked, its storage is reclaimed by the next Build and
+    // nodes are never merged back, a chunk only ever loses a few items.
     //
+    glm::vec2 point(position.x, position.z);
+    if (!containsPoint(nodes_.at(0), point))
+    {
+        return false;
+    }
+
+    uint32_t node = 0;
+    while (nodes_.at(node).first_child != _INVALID_)
+    {
+        node = nodes_.at(node).first_child + childFor(nodes_.at(node), point);
+    }
+
+    uint32_t* link = &nodes_.at(node).first_item;
+    while (*link != _INVALID_)
+    {
+        QuadTree::Item& item = items_.at(*link);
+        if (item.index == index)
+        {
+            *link = item.next;
+            item.next = _INVALID_;
+            nodes_.at(node).item_count--;
+            item_count_--;
+            return true;
+        }
+        link = &item.next;
+    }
     return false;
 }
 
-std::vector<Entity> QuadTree::Query(AABB range)
+std::size_t QuadTree::Query(AABB range, uint32_t* result,
+    std::size_t capacity)
 {
-    std::vector<Entity> matching_ents;
+    // Writes at most capacity indices and returns how many items are in 
+    // range, so the caller can tell if its buffer was too small.
+    //
+    glm::vec2 range_min(range.XMin(), range.ZMin());
+    glm::vec2 range_max(range.XMax(), range.ZMax());
+
+    uint32_t stack[4 * _MAX_DEPTH_ + 4];
+    uint32_t stack_size = 0;
+    std::size_t found = 0;
 
-    if (!bounding_box_.Collides(range))
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
     {
-        return matching_ents;
+        const QuadTree::Node& node = nodes_[stack[--stack_size]];
+        if (node.center.x + node.half_dim < range_min.x || node.center.x - node.half_dim > range_max.x ||
+            node.center.y + node.half_dim < range_min.y || node.center.y - node.half_dim > range_max.y)
+        {
+            continue;
+        }
+
+        if (node.first_child != _INVALID_)
+        {
+            // Only descend into the quadrants the range reaches, the order
+            // matches childFor.
+            //
+            bool low_x = range_min.x < node.center.x;
+            bool high_x = range_max.x >= node.center.x;
+            bool low_z = range_min.y < node.center.y;
+            bool high_z = range_max.y >= node.center.y;
+            if (low_x && low_z) stack[stack_size++] = node.first_child + 0;
+            if (high_x && low_z) stack[stack_size++] = node.first_child + 1;
+            if (low_x && high_z) stack[stack_size++] = node.first_child + 2;
+            if (high_x && high_z) stack[stack_size++] = node.first_child + 3;
+            continue;
+        }
+
+        for (uint32_t item = node.first_item; item != _INVALID_; item = items_[item].next)
+        {
+            glm::vec2 p = items_[item].position;
+            if (p.x >= range_min.x && p.x <= range_max.x && p.y >= range_min.y && p.y <= range_max.y)
+            {
+                if (found < capacity)
+                {
+                    result[found] = items_[item].index;
+                }
+                found++;
+            }
+        }
+    }
+
+    return found;
+}
+
+void QuadTree::QueryFrustum(Frustum& frustum, glm::vec2 y_range, 
+    float margin, std::vector<uint32_t>& result)
+{
+    // Appends every item that may be visible. The tree is 2D, so node and
+    // item boxes take their height from y_range and are grown by margin, the
+    // largest extent of an item around its position. A node fully inside 
+    // the frustum accepts its whole subtree without testing anything below.
+    //
+    uint32_t stack[4 * _MAX_DEPTH_ + 4];
+    uint32_t stack_size = 0;
+
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        uint32_t node_index = stack[--stack_size];
+        const QuadTree::Node& node = nodes_[node_index];
+        float extent = node.half_dim + margin;
+        CULLRESULTenum test = frustum.Classify(
+            glm::vec3(node.center.x - extent, y_range.x, node.center.y - extent),
+            glm::vec3(node.center.x + extent, y_range.y, node.center.y + extent));
+
+        if (test == CULLRESULTenum::OUTSIDE)
+        {
+            continue;
+        }
+        if (test == CULLRESULTenum::INSIDE)
+        {
+            appendSubtree(node_index, result);
+            continue;
+        }
+
+        if (node.first_child != _INVALID_)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                stack[stack_size++] = node.first_child + c;
+            }
+            continue;
+        }
+
+        for (uint32_t item = node.first_item; item != _INVALID_; item = items_[item].next)
+        {
+            glm::vec2 p = items_[item].position;
+            if (frustum.Classify(glm::vec3(p.x - margin, y_range.x, p.y - margin),
+                glm::vec3(p.x + margin, y_range.y, p.y + margin)) != CULLRESULTenum::OUTSIDE)
+            {
+                result.push_back(items_[item].index);
+            }
+        }
     }
+}
+
+void QuadTree::Clear()
+{
+    nodes_.clear();
+    items_.clear();
+    item_count_ = 0;
+
+    QuadTree::Node root;
+    root.center = glm::vec2(bounding_box_.center_position.x, bounding_box_.center_position.z);
+    root.half_dim = bounding_box_.x_half_dim;
+    root.first_child = _INVALID_;
+    root.first_item = _INVALID_;
+    root.item_count = 0;
+    root.depth = 0;
+    nodes_.push_back(root);
+}
+
+uint32_t QuadTree::GetNodeCount()
+{
+    return (uint32_t)nodes_.size();
+}
+
+uint32_t QuadTree::GetItemCount()
+{
+    return item_count_;
+}
 
-    for (std::size_t i = 0; i < entities_.size(); i++)
+std::size_t QuadTree::GetMemoryFootprint()
+{
+    return sizeof(QuadTree) + 
+        nodes_.capacity() * sizeof(QuadTree::Node) + 
+        items_.capacity() * sizeof(QuadTree::Item);
+}
+
+void QuadTree::buildNode(uint32_t node, const std::vector<glm::vec3>& positions,
+    uint32_t* indices, uint32_t count)
+{
+    if (count <= _NODE_CAPACITY_ || nodes_.at(node).depth >= _MAX_DEPTH_)
     {
-        if (range.Contains(entities_.at(i).bounding_box_.GetCenter()) &&
-            entities_.at(i).IsCollectible())
+        for (uint32_t i = 0; i < count; i++)
         {
-            matching_ents.push_back(entities_.at(i));
+            QuadTree::Item item;
+            item.position = glm::vec2(positions[indices[i]].x, positions[indices[i]].z);
+            item.index = indices[i];
+            item.next = _INVALID_;
+            items_.push_back(item);
+            linkItem(node, (uint32_t)items_.size() - 1);
         }
+        return;
     }
 
-    if (quadrant_1_ == nullptr)
+    subdivide(node);
+
+    // Partition the indices into the 4 quadrants (z then x), then recurse 
+    // into each range. nodes_ may grow while recursing, so nodes are referred
+    // to by index only.
+    //
+    QuadTree::Node parent = nodes_.at(node);
+    uint32_t* end = indices + count;
+    uint32_t* z_split = std::partition(indices, end, [&](uint32_t i) { return positions[i].z < parent.center.y; });
+    uint32_t* x_split_low = std::partition(indices, z_split, [&](uint32_t i) { return positions[i].x < parent.center.x; });
+    uint32_t* x_split_high = std::partition(z_split, end, [&](uint32_t i) { return positions[i].x < parent.center.x; });
+
+    buildNode(parent.first_child + 0, positions, indices, (uint32_t)(x_split_low - indices));
+    buildNode(parent.first_child + 1, positions, x_split_low, (uint32_t)(z_split - x_split_low));
+    buildNode(parent.first_child + 2, positions, z_split, (uint32_t)(x_split_high - z_split));
+    buildNode(parent.first_child + 3, positions, x_split_high, (uint32_t)(end - x_split_high));
+}
+
+void QuadTree::subdivide(uint32_t node)
+{
+    // Children are 0: -x -z, 1: +x -z, 2: -x +z, 3: +x +z, see childFor.
+    //
+    QuadTree::Node parent = nodes_.at(node);
+    float h_dim = parent.half_dim / 2.0f;
+    uint32_t first_child = (uint32_t)nodes_.size();
+
+    for (uint32_t c = 0; c < 4; c++)
     {
-        return matching_ents;
+        QuadTree::Node child;
+        child.center = parent.center + glm::vec2((c & 1) ? h_dim : -h_dim, (c & 2) ? h_dim : -h_dim);
+        child.half_dim = h_dim;
+        child.first_child = _INVALID_;
+        child.first_item = _INVALID_;
+        child.item_count = 0;
+        child.depth = parent.depth + 1;
+        nodes_.push_back(child);
     }
 
-    std::vector<Entity> match;
-    match = quadrant_1_->Query(range);
-    matching_ents.insert(matching_ents.end(), match.begin(), match.end());
-    match = quadrant_2_->Query(range);
-    matching_ents.insert(matching_ents.end(), match.begin(), match.end());
-    match = quadrant_3_->Query(range);
-    matching_ents.insert(matching_ents.end(), match.begin(), match.end());
-    match = quadrant_4_->Query(range);
-    matching_ents.insert(matching_ents.end(), match.begin(), match.end());
+    // Push the items of a former leaf down one level, internal nodes don't
+    // hold items.
+    //
+    uint32_t item = parent.first_item;
+    nodes_.at(node).first_child = first_child;
+    nodes_.at(node).first_item = _INVALID_;
+    nodes_.at(node).item_count = 0;
+    while (item != _INVALID_)
+    {
+        uint32_t next = items_.at(item).next;
+        linkItem(first_child + childFor(nodes_.at(node), items_.at(item).position), item);
+        item = next;
+    }
+
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        if (nodes_.at(first_child + c).item_count > _NODE_CAPACITY_ && parent.depth + 1 < _MAX_DEPTH_)
+        {
+            subdivide(first_child + c);
+        }
+    }
+}
+
+void QuadTree::linkItem(uint32_t node, uint32_t item)
+{
+    items_.at(item).next = nodes_.at(node).first_item;
+    nodes_.at(node).first_item = item;
+    nodes_.at(node).item_count++;
+}
 
-    return matching_ents;
+void QuadTree::appendSubtree(uint32_t node, std::vector<uint32_t>& result)
+{
+    uint32_t stack[4 * _MAX_DEPTH_ + 4];
+    uint32_t stack_size = 0;
+
+    stack[stack_size++] = node;
+    while (stack_size > 0)
+    {
+        const QuadTree::Node& current = nodes_[stack[--stack_size]];
+        if (current.first_child != _INVALID_)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                stack[stack_size++] = current.first_child + c;
+            }
+            continue;
+        }
+
+        for (uint32_t item = current.first_item; item != _INVALID_; item = items_[item].next)
+        {
+            result.push_back(items_[item].index);
+        }
+    }
 }
 
-void QuadTree::subdivide()
+uint32_t QuadTree::childFor(const QuadTree::Node& node, glm::vec2 position)
 {
-    float _x = bounding_box_.center_position.x;
-    float _z = bounding_box_.center_position.z;
-    float _h_dim = bounding_box_.x_half_dim / 2;
+    return (position.x < node.center.x ? 0 : 1) | (position.y < node.center.y ? 0 : 2);
+}
 
-    quadrant_1_ = new QuadTree(AABB(glm::vec3(_x + _h_dim, 0.0f, _z - _h_dim), _h_dim));
-    quadrant_2_ = new QuadTree(AABB(glm::vec3(_x - _h_dim, 0.0f, _z - _h_dim), _h_dim));
-    quadrant_3_ = new QuadTree(AABB(glm::vec3(_x - _h_dim, 0.0f, _z + _h_dim), _h_dim));
-    quadrant_4_ = new QuadTree(AABB(glm::vec3(_x + _h_dim, 0.0f, _z + _h_dim), _h_dim));
-}
\ No newline at end of file
+bool QuadTree::containsPoint(const QuadTree::Node& node, glm::vec2 position)
+{
+    return (position.x >= node.center.x - node.half_dim && position.x <= node.center.x + node.half_dim &&
+        position.y >= node.center.y - node.half_dim && position.y <= node.center.y + node.half_dim);
+}
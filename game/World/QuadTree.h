@@ -2,9 +2,12 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
+
+#include <glm/glm.hpp>
 
 #include "Types/AABB.h"
-#include "Game/Entity.h"
+#include "Types/Frustum.h"
 
 // This is a point region quadtree implementation.
 // Also the Y dimension is being ignored, since the game objects
@@ -12,26 +15,63 @@
 // Since the player can only move on the terrain level, we only need
 // to check X and Z dimensions to determine if a collision has occured.
 //
+// The tree doesn't own the entities, it stores 32 bit indices into the 
+// caller's entity array together with their X/Z position. All nodes live in
+// one contiguous array (children of a node are 4 consecutive nodes) and the
+// items of a leaf are a linked list threaded through one item array, so
+// there are no per node allocations and queries allocate nothing. Build
+// places the items of every leaf next to each other in that array.
+//
 class QuadTree
 {
 public:
     QuadTree(AABB bounding_box);
-    ~QuadTree();
 
-    bool Insert(Entity ent);
-    std::vector<Entity> Query(AABB range);
+    void Build(const std::vector<glm::vec3>& positions);
+    bool Insert(uint32_t index, glm::vec3 position);
+    bool Remove(uint32_t index, glm::vec3 position);
+    std::size_t Query(AABB range, uint32_t* result, 
+        std::size_t capacity);
+    void QueryFrustum(Frustum& frustum, glm::vec2 y_range, 
+        float margin, std::vector<uint32_t>& result);
+    void Clear();
+
+    uint32_t GetNodeCount();
+    uint32_t GetItemCount();
+    std::size_t GetMemoryFootprint();
 
 private:
-    const uint32_t _node_capacity_;
+    struct Node
+    {
+        glm::vec2 center;
+        float half_dim;
+        uint32_t first_child;
+        uint32_t first_item;
+        uint32_t item_count;
+        uint32_t depth;
+    };
+
+    struct Item
+    {
+        glm::vec2 position;
+        uint32_t index;
+        uint32_t next;
+    };
 
     AABB bounding_box_;
-    std::vector<Entity> entities_;
-
-    QuadTree* quadrant_1_;
-    QuadTree* quadrant_2_;
-    QuadTree* quadrant_3_;
-    QuadTree* quadrant_4_;
-    
-    void subdivide();
-};
+    std::vector<QuadTree::Node> nodes_;
+    std::vector<QuadTree::Item> items_;
+    uint32_t item_count_;
+
+    static const uint32_t _NODE_CAPACITY_;
+    static const uint32_t _MAX_DEPTH_;
+    static const uint32_t _INVALID_;
 
+    void buildNode(uint32_t node, const std::vector<glm::vec3>& positions,
+        uint32_t* indices, uint32_t count);
+    void subdivide(uint32_t node);
+    void linkItem(uint32_t node, uint32_t item);
+    void appendSubtree(uint32_t node, std::vector<uint32_t>& result);
+    uint32_t childFor(const QuadTree::Node& node, glm::vec2 position);
+    bool containsPoint(const QuadTree::Node& node, glm::vec2 position);
+};
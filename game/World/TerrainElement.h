@@ -13,14 +13,13 @@
 class TerrainElement : public virtual GObject
 {
 public:
-    TerrainElement(Model model, Shader shader);
+    TerrainElement(ModelHandle model, ShaderHandle shader);
 
     void Draw();
     void Draw(glm::vec3 position);
     void Draw(glm::vec3 position, float yaw);
-    void DrawInstanced(std::vector<glm::mat4>& instance_mod_mats);
-    void DrawInstanced(std::shared_ptr<std::vector<glm::mat4>> instance_mod_mats);
+    void DrawInstanced();
 
 private:
-    Shader shader_;
+    ShaderHandle shader_;
 };
@@ -0,0 +1,51 @@
+#include "WorldChunk.h"
+
+WorldChunk::WorldChunk(const uint32_t _grid_size,
+    const uint32_t _chunk_size,
+    const float _height_scale,
+    const TERRMESHenum _mesh_type,
+    const uint32_t _seed,
+    const glm::ivec2 _coords,
+    const std::string _cache_directory) :
+    _coords_(_coords),
+    terrain_(_grid_size, _height_scale, _mesh_type, _seed, _coords, _chunk_size, _cache_directory),
+    quad_tree_(chunkBoundingBox(_grid_size, _chunk_size, _coords)),
+    entity_y_range_(glm::vec2(0.0f)),
+    entity_margin_(0.0f),
+    bounding_box_(chunkBoundingBox(_grid_size, _chunk_size, _coords))
+{
+}
+
+AABB WorldChunk::GetBoundingBox()
+{
+    return bounding_box_;
+}
+
+bool WorldChunk::Overlaps(AABB range)
+{
+    return bounding_box_.Collides(range);
+}
+
+std::size_t WorldChunk::GetMemoryFootprint()
+{
+    std::size_t bytes = terrain_.GetMemoryFootprint() + quad_tree_.GetMemoryFootprint();
+    for (std::size_t i = 0; i < entities_.size(); i++)
+    {
+        bytes += entities_.at(i).GetMemoryFootprint();
+    }
+
+    return bytes;
+}
+
+AABB WorldChunk::chunkBoundingBox(const uint32_t _grid_size, const uint32_t _chunk_size,
+    const glm::ivec2 _coords)
+{
+    // Grid samples are 2 units apart and the grid is centered at the origin,
+    // see Terrain::getPositionTransform.
+    //
+    float half_dim = (float)_chunk_size;
+    float center_x = (float)(_coords.x * (int)_chunk_size) * 2.0f - (float)_grid_size + half_dim;
+    float center_z = (float)(_coords.y * (int)_chunk_size) * 2.0f - (float)_grid_size + half_dim;
+
+    return AABB(glm::vec3(center_x, 0.0f, center_z), half_dim);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Terrain/Terrain.h"
+#include "World/QuadTree.h"
+#include "Game/Entity.h"
+#include "Types/AABB.h"
+#include "Types/ETerrain.h"
+
+// A fixed-size tile of the world. It owns the terrain mesh of the tile, the
+// vegetation and hazelnut instance lists (through its Terrain), the entities
+// placed on it and a quadtree over those entities. Chunks are built off the 
+// main thread by the ChunkManager and only touch GL in Terrain::Upload.
+//
+class WorldChunk
+{
+public:
+    const glm::ivec2 _coords_;
+    Terrain terrain_;
+    QuadTree quad_tree_;
+    std::vector<Entity> entities_;
+
+    // Height range and largest cull radius of the entities, set when the
+    // chunk is populated. Used to give the 2D quadtree nodes a volume for
+    // frustum culling.
+    //
+    glm::vec2 entity_y_range_;
+    float entity_margin_;
+
+    WorldChunk(const uint32_t _grid_size,
+        const uint32_t _chunk_size,
+        const float _height_scale,
+        const TERRMESHenum _mesh_type,
+        const uint32_t _seed,
+        const glm::ivec2 _coords,
+        const std::string _cache_directory = "");
+
+    WorldChunk(const WorldChunk&) = delete;
+    WorldChunk& operator=(const WorldChunk&) = delete;
+
+    AABB GetBoundingBox();
+    bool Overlaps(AABB range);
+    std::size_t GetMemoryFootprint();
+
+private:
+    AABB bounding_box_;
+
+    static AABB chunkBoundingBox(const uint32_t _grid_size, const uint32_t _chunk_size,
+        const glm::ivec2 _coords);
+};